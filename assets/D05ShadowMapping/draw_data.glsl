@@ -0,0 +1,15 @@
+// Multi-draw indirect: one Draw per scene object in a storage buffer
+
+struct Draw
+{
+    mat4 ModelMatrix;
+    mat4 NormalMatrix;      // world space, only the upper 3x3 is used
+    vec4 Diffuse;
+    vec4 Ambient;
+    vec4 SpecularShininess; // specular color, shininess in w
+};
+
+layout(std430, binding = 0) readonly buffer DrawData
+{
+    Draw uDraws[];
+};
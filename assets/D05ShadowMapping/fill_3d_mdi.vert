@@ -0,0 +1,13 @@
+#version 430 core
+
+layout(location = 0) in vec3 aVertexPosition;
+
+#include "indirect_draw.glsl"
+
+uniform mat4 uViewMatrix;
+uniform mat4 uProjection;
+
+void main()
+{
+    gl_Position = uProjection * uViewMatrix * current_draw().ModelMatrix * vec4(aVertexPosition, 1.0);
+}
@@ -0,0 +1,10 @@
+// aDrawIndex steps once per instance, so every draw reads the base instance of its indirect command and finds its own Draw
+
+#include "draw_data.glsl"
+
+layout(location = 3) in float aDrawIndex;
+
+Draw current_draw()
+{
+    return uDraws[int(aDrawIndex)];
+}
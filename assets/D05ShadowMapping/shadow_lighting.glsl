@@ -0,0 +1,85 @@
+// Shared by shadows.frag and shadows_mdi.frag, which only differ in where the material comes from
+
+in vec3 vNormalInViewSpace;
+in vec3 vPositionInViewSpace;
+in vec4 vPositionInShadowSpace;
+in vec3 vPositionInWorldSpace;
+
+uniform sampler2DShadow uShadowMap;
+uniform vec3  uFogColor;
+uniform float uFogDensity;
+uniform vec3  uLightPosition;
+uniform bool  uDoShadowBehindLight;
+
+// Cascaded mode: every cascade has its own square of the shadow map atlas.
+// uCascadeMatrices take world space to that square, uCascadeFarDistances are the view space depths where each cascade ends.
+// 0 cascades means the single shadow map and uShadowMatrix.
+uniform int   uCascadeCount;
+uniform mat4  uCascadeMatrices[4];
+uniform vec4  uCascadeFarDistances;
+uniform bool  uShowCascades;
+
+const vec3 CascadeTints[4] = vec3[4](vec3(1.0, 0.6, 0.6), vec3(0.6, 1.0, 0.6), vec3(0.6, 0.6, 1.0), vec3(1.0, 1.0, 0.6));
+
+int find_cascade()
+{
+    float depth   = -vPositionInViewSpace.z;
+    int   cascade = uCascadeCount;
+    for (int i = uCascadeCount - 1; i >= 0; --i)
+    {
+        if (depth <= uCascadeFarDistances[i])
+            cascade = i;
+    }
+    return cascade;
+}
+
+// Blinn-Phong lit by the spot light, shadowed by the single map or the cascades, then fogged
+vec3 shade(vec3 diffuse_color, vec3 ambient_color, vec3 specular_color, float shininess)
+{
+    vec3 n = normalize(vNormalInViewSpace);
+    vec3 l = normalize(uLightPosition - vPositionInViewSpace);
+    float nl = max(dot(n, l), 0.0);
+    const vec3 eye = vec3(0, 0, 1);
+    vec3 h = normalize(l + eye);
+    float spec = max(0.0, dot(n, h));
+    spec = pow(spec, shininess);
+    vec3 diffuse = nl * diffuse_color;
+
+
+    int  cascade              = find_cascade();
+    vec4 shadow_coordinates   = vPositionInShadowSpace;
+    bool is_past_last_cascade = uCascadeCount > 0 && cascade == uCascadeCount;
+    if (uCascadeCount > 0)
+    {
+        shadow_coordinates = uCascadeMatrices[min(cascade, uCascadeCount - 1)] * vec4(vPositionInWorldSpace, 1.0);
+    }
+
+    // sampled outside of the branches so it stays in uniform control flow
+    float shadow = textureProj(uShadowMap, shadow_coordinates);
+
+    // Adjust shadow value if not casting shadows behind light
+    if(!(uDoShadowBehindLight) && (shadow_coordinates.z < 0.0))
+    {
+        shadow = 1.0;
+    }
+    // nothing was rendered for that far away
+    if (is_past_last_cascade)
+    {
+        shadow = 1.0;
+    }
+
+    
+    vec3 color = ambient_color + shadow * (diffuse + spec * specular_color);
+    if (uShowCascades && uCascadeCount > 0 && !is_past_last_cascade)
+    {
+        color *= CascadeTints[cascade];
+    }
+
+    // Apply fog effect based on distance and fog density
+    float distance = length(vPositionInViewSpace);
+    float fogFactor = 1.0 - exp(-uFogDensity * distance);
+    fogFactor = clamp(fogFactor, 0.0, 1.0); // Ensure the factor stays within bounds
+
+    // Mix the object color with the fog color based on the calculated fog factor
+    return mix(color, uFogColor, fogFactor);
+}
@@ -7,6 +7,7 @@ layout(location = 1) in vec3 aVertexNormal;
 out vec3 vNormalInViewSpace;
 out vec3 vPositionInViewSpace;
 out vec4 vPositionInShadowSpace;
+out vec3 vPositionInWorldSpace;
 
 uniform mat4 uModelMatrix;
 uniform mat4 uViewMatrix;
@@ -23,4 +24,6 @@ void main()
     vPositionInViewSpace = ((uViewMatrix * uModelMatrix * vec4(aVertexPosition, 1.0)).xyz);
 
     vPositionInShadowSpace = uShadowMatrix * uModelMatrix * vec4(aVertexPosition, 1.0);
+
+    vPositionInWorldSpace = (uModelMatrix * vec4(aVertexPosition, 1.0)).xyz;
 }
@@ -0,0 +1,15 @@
+#version 430 core
+
+layout(location = 0) out vec4 fFragmentColor;
+
+#include "shadow_lighting.glsl"
+
+flat in vec3  vDiffuse;
+flat in vec3  vAmbient;
+flat in vec3  vSpecularColor;
+flat in float vShininess;
+
+void main()
+{
+    fFragmentColor = vec4(shade(vDiffuse, vAmbient, vSpecularColor, vShininess), 1.0);
+}
@@ -0,0 +1,41 @@
+#version 430 core
+
+layout(location = 0) in vec3 aVertexPosition;
+layout(location = 1) in vec3 aVertexNormal;
+
+#include "indirect_draw.glsl"
+
+out vec3 vNormalInViewSpace;
+out vec3 vPositionInViewSpace;
+out vec4 vPositionInShadowSpace;
+out vec3 vPositionInWorldSpace;
+
+flat out vec3  vDiffuse;
+flat out vec3  vAmbient;
+flat out vec3  vSpecularColor;
+flat out float vShininess;
+
+uniform mat4 uViewMatrix;
+uniform mat4 uProjection;
+uniform mat4 uShadowMatrix;
+
+void main()
+{
+    Draw draw = current_draw();
+    vec4 world_position = draw.ModelMatrix * vec4(aVertexPosition, 1.0);
+
+    gl_Position = uProjection * uViewMatrix * world_position;
+
+    vNormalInViewSpace = normalize(mat3(uViewMatrix) * mat3(draw.NormalMatrix) * aVertexNormal);
+
+    vPositionInViewSpace = (uViewMatrix * world_position).xyz;
+
+    vPositionInShadowSpace = uShadowMatrix * world_position;
+
+    vPositionInWorldSpace = world_position.xyz;
+
+    vDiffuse       = draw.Diffuse.rgb;
+    vAmbient       = draw.Ambient.rgb;
+    vSpecularColor = draw.SpecularShininess.rgb;
+    vShininess     = draw.SpecularShininess.w;
+}
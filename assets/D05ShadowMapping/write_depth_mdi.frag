@@ -0,0 +1,3 @@
+#version 430 core
+
+#include "write_depth.glsl"
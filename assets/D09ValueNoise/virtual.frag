@@ -0,0 +1,30 @@
+#version 330 core
+
+in vec2 vTexCoord;
+
+uniform sampler2D uPhysicalPages; // cache of generated pages, each with a one texel border
+uniform sampler2D uPageTable;     // one texel per page of the current level, rg = slot in the cache, a = 1 when it is there
+uniform float     uPagesPerSide;
+uniform float     uSlotsPerSide;
+
+out vec4 FragColor;
+
+const float PAGE_TEXELS = 128.0;
+const float SLOT_TEXELS = PAGE_TEXELS + 2.0;
+
+void main()
+{
+    vec2 in_pages = fract(vTexCoord) * uPagesPerSide;
+    vec2 page     = min(floor(in_pages), vec2(uPagesPerSide - 1.0));
+    vec4 entry    = texelFetch(uPageTable, ivec2(page), 0);
+    if (entry.a < 0.5)
+    {
+        // still being generated
+        FragColor = vec4(0.5, 0.5, 0.5, 1.0);
+        return;
+    }
+    vec2 slot     = floor(entry.rg * 255.0 + 0.5);
+    vec2 in_slot  = 1.0 + (in_pages - page) * PAGE_TEXELS;
+    vec2 texel    = slot * SLOT_TEXELS + in_slot;
+    FragColor     = vec4(texture(uPhysicalPages, texel / (uSlotsPerSide * SLOT_TEXELS)).rgb, 1.0);
+}
@@ -7,6 +7,9 @@ include(cmake/dependencies/DearImGUI.cmake) # defines target imgui   ;  note Dea
 include(cmake/dependencies/STB.cmake)       # defines target stb
 include(cmake/dependencies/GSL.cmake)       # defines target gsl
 include(cmake/dependencies/GLM.cmake)       # defines target cs250_glm
+if(NOT EMSCRIPTEN)
+    include(cmake/dependencies/GoogleBenchmark.cmake) # defines target cs250_benchmark ; only graphics_fun_microbench links it
+endif()
 
 add_library(dependencies INTERFACE)
 
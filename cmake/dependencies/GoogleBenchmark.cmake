@@ -0,0 +1,15 @@
+# Google Benchmark for graphics_fun_microbench
+# Only its library is built, the project's own tests and gtest dependency are turned off
+set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_INSTALL_DOCS OFF CACHE BOOL "" FORCE)
+FetchContent_Declare(
+    the_benchmark
+    DOWNLOAD_EXTRACT_TIMESTAMP TRUE
+    URL https://github.com/google/benchmark/archive/refs/tags/v1.8.3.tar.gz
+)
+FetchContent_MakeAvailable(the_benchmark)
+
+add_library(cs250_benchmark INTERFACE)
+target_link_libraries(cs250_benchmark INTERFACE benchmark::benchmark)
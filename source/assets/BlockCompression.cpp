@@ -0,0 +1,222 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "BlockCompression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+
+namespace
+{
+    struct Pixel
+    {
+        int r = 0, g = 0, b = 0, a = 0;
+    };
+
+    using Block = std::array<Pixel, 16>;
+
+    Block read_block(const assets::Image& image, int block_x, int block_y) noexcept
+    {
+        Block block;
+        for (int y = 0; y < 4; ++y)
+        {
+            for (int x = 0; x < 4; ++x)
+            {
+                const int      px    = std::min(block_x * 4 + x, image.Width - 1);
+                const int      py    = std::min(block_y * 4 + y, image.Height - 1);
+                const unsigned pixel = image.Pixels[static_cast<std::size_t>(py) * static_cast<std::size_t>(image.Width) + static_cast<std::size_t>(px)];
+                block[static_cast<std::size_t>(y * 4 + x)] = Pixel{ static_cast<int>(pixel & 0xFFu), static_cast<int>((pixel >> 8) & 0xFFu), static_cast<int>((pixel >> 16) & 0xFFu), static_cast<int>(pixel >> 24) };
+            }
+        }
+        return block;
+    }
+
+    std::uint16_t to_565(const Pixel& color) noexcept
+    {
+        return static_cast<std::uint16_t>(((color.r >> 3) << 11) | ((color.g >> 2) << 5) | (color.b >> 3));
+    }
+
+    Pixel from_565(std::uint16_t color) noexcept
+    {
+        const int r = (color >> 11) & 0x1F;
+        const int g = (color >> 5) & 0x3F;
+        const int b = color & 0x1F;
+        return Pixel{ (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255 };
+    }
+
+    void write_u16(std::byte* destination, std::uint16_t value) noexcept
+    {
+        destination[0] = static_cast<std::byte>(value & 0xFFu);
+        destination[1] = static_cast<std::byte>(value >> 8);
+    }
+
+    void encode_color_block(const Block& block, std::byte* destination) noexcept
+    {
+        Pixel min_color{ 255, 255, 255, 255 };
+        Pixel max_color{ 0, 0, 0, 255 };
+        Pixel mean{};
+        for (const auto& p : block)
+        {
+            min_color = Pixel{ std::min(min_color.r, p.r), std::min(min_color.g, p.g), std::min(min_color.b, p.b), 255 };
+            max_color = Pixel{ std::max(max_color.r, p.r), std::max(max_color.g, p.g), std::max(max_color.b, p.b), 255 };
+            mean.r += p.r;
+            mean.g += p.g;
+            mean.b += p.b;
+        }
+        mean = Pixel{ mean.r / 16, mean.g / 16, mean.b / 16, 255 };
+
+        // pick the diagonal of the bounding box that follows how red and blue change with green
+        int red_green = 0, blue_green = 0;
+        for (const auto& p : block)
+        {
+            red_green += (p.r - mean.r) * (p.g - mean.g);
+            blue_green += (p.b - mean.b) * (p.g - mean.g);
+        }
+        if (red_green < 0)
+            std::swap(min_color.r, max_color.r);
+        if (blue_green < 0)
+            std::swap(min_color.b, max_color.b);
+
+        // pull the endpoints in a little, the extremes are usually outliers
+        const auto inset = [](int& low, int& high)
+        {
+            const int amount = (high - low) / 16;
+            low += amount;
+            high -= amount;
+        };
+        inset(min_color.r, max_color.r);
+        inset(min_color.g, max_color.g);
+        inset(min_color.b, max_color.b);
+
+        std::uint16_t color0 = to_565(max_color);
+        std::uint16_t color1 = to_565(min_color);
+        // color0 > color1 selects the 4 color mode
+        if (color0 < color1)
+            std::swap(color0, color1);
+
+        const Pixel                c0      = from_565(color0);
+        const Pixel                c1      = from_565(color1);
+        const std::array<Pixel, 4> palette = {
+            c0,
+            c1,
+            Pixel{ (2 * c0.r + c1.r) / 3, (2 * c0.g + c1.g) / 3, (2 * c0.b + c1.b) / 3, 255 },
+            Pixel{ (c0.r + 2 * c1.r) / 3, (c0.g + 2 * c1.g) / 3, (c0.b + 2 * c1.b) / 3, 255 },
+        };
+
+        std::uint32_t indices = 0;
+        if (color0 != color1)
+        {
+            for (std::size_t i = 0; i < block.size(); ++i)
+            {
+                int      best_distance = 0x7FFFFFFF;
+                unsigned best_index    = 0;
+                for (unsigned j = 0; j < palette.size(); ++j)
+                {
+                    const int dr       = block[i].r - palette[j].r;
+                    const int dg       = block[i].g - palette[j].g;
+                    const int db       = block[i].b - palette[j].b;
+                    const int distance = dr * dr + dg * dg + db * db;
+                    if (distance < best_distance)
+                    {
+                        best_distance = distance;
+                        best_index    = j;
+                    }
+                }
+                indices |= best_index << (2 * i);
+            }
+        }
+
+        write_u16(destination, color0);
+        write_u16(destination + 2, color1);
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            destination[4 + i] = static_cast<std::byte>((indices >> (8 * i)) & 0xFFu);
+        }
+    }
+
+    void encode_alpha_block(const Block& block, std::byte* destination) noexcept
+    {
+        int alpha0 = 0;
+        int alpha1 = 255;
+        for (const auto& p : block)
+        {
+            alpha0 = std::max(alpha0, p.a);
+            alpha1 = std::min(alpha1, p.a);
+        }
+
+        std::uint64_t indices = 0;
+        if (alpha0 != alpha1)
+        {
+            // alpha0 > alpha1 selects 6 interpolated values between them
+            std::array<int, 8> palette{ alpha0, alpha1 };
+            for (int i = 1; i < 7; ++i)
+            {
+                palette[static_cast<std::size_t>(i + 1)] = ((7 - i) * alpha0 + i * alpha1) / 7;
+            }
+            for (std::size_t i = 0; i < block.size(); ++i)
+            {
+                int           best_distance = 256;
+                std::uint64_t best_index    = 0;
+                for (std::size_t j = 0; j < palette.size(); ++j)
+                {
+                    const int distance = std::abs(block[i].a - palette[j]);
+                    if (distance < best_distance)
+                    {
+                        best_distance = distance;
+                        best_index    = j;
+                    }
+                }
+                indices |= best_index << (3 * i);
+            }
+        }
+
+        destination[0] = static_cast<std::byte>(alpha0);
+        destination[1] = static_cast<std::byte>(alpha1);
+        for (unsigned i = 0; i < 6; ++i)
+        {
+            destination[2 + i] = static_cast<std::byte>((indices >> (8 * i)) & 0xFFu);
+        }
+    }
+
+    template <typename EncodeBlock>
+    std::vector<std::byte> encode_blocks(const assets::Image& image, std::size_t bytes_per_block, EncodeBlock&& encode_block)
+    {
+        const int              blocks_wide = std::max(1, (image.Width + 3) / 4);
+        const int              blocks_high = std::max(1, (image.Height + 3) / 4);
+        std::vector<std::byte> encoded(static_cast<std::size_t>(blocks_wide) * static_cast<std::size_t>(blocks_high) * bytes_per_block);
+        std::byte*             destination = encoded.data();
+        for (int block_y = 0; block_y < blocks_high; ++block_y)
+        {
+            for (int block_x = 0; block_x < blocks_wide; ++block_x)
+            {
+                encode_block(read_block(image, block_x, block_y), destination);
+                destination += bytes_per_block;
+            }
+        }
+        return encoded;
+    }
+}
+
+namespace assets
+{
+    std::vector<std::byte> encode_bc1(const Image& image)
+    {
+        return encode_blocks(image, 8, encode_color_block);
+    }
+
+    std::vector<std::byte> encode_bc3(const Image& image)
+    {
+        return encode_blocks(image, 16,
+                             [](const Block& block, std::byte* destination)
+                             {
+                                 encode_alpha_block(block, destination);
+                                 encode_color_block(block, destination + 8);
+                             });
+    }
+}
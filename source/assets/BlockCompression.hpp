@@ -0,0 +1,24 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include "ImageFile.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace assets
+{
+    // S3TC / DXT encoders, quick bounding box fits in the style of "Real-Time DXT Compression" by J.M.P. van Waveren.
+    // Images that aren't a multiple of 4 are padded by repeating their edge pixels
+
+    // 8 bytes per 4x4 block, ignores alpha (GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+    [[nodiscard]] std::vector<std::byte> encode_bc1(const Image& image);
+
+    // 16 bytes per 4x4 block, 8 alpha values interpolated between two endpoints plus a BC1 color block (GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+    [[nodiscard]] std::vector<std::byte> encode_bc3(const Image& image);
+}
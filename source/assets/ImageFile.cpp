@@ -0,0 +1,261 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "ImageFile.hpp"
+
+#include "util/JobSystem.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <gsl/gsl>
+#include <stb_image.h>
+
+namespace
+{
+    // stbi_set_flip_vertically_on_load is global state, so flip here to stay thread safe
+    void flip_rows(assets::Image& image)
+    {
+        const auto row_length = static_cast<std::ptrdiff_t>(image.Width);
+        auto       top        = image.Pixels.begin();
+        auto       bottom     = image.Pixels.end() - row_length;
+        while (top < bottom)
+        {
+            std::swap_ranges(top, top + row_length, bottom);
+            top += row_length;
+            bottom -= row_length;
+        }
+    }
+
+    struct FilterTaps
+    {
+        int                  FirstOffset = 0; // of the first tap from the first of the two source texels
+        std::array<float, 6> Weights{};
+        int                  Count = 0;
+    };
+
+    // modified Bessel function of the first kind, enough terms for the alpha used below
+    double bessel_i0(double x) noexcept
+    {
+        double sum  = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 20; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    FilterTaps make_taps(assets::MipFilter filter) noexcept
+    {
+        FilterTaps taps;
+        if (filter == assets::MipFilter::Box)
+        {
+            taps.FirstOffset = 0;
+            taps.Weights     = { 0.5f, 0.5f };
+            taps.Count       = 2;
+            return taps;
+        }
+        // sinc windowed by a Kaiser window 1.5 destination texels wide on each side, so 6 source texels
+        constexpr double ALPHA  = 4.0;
+        constexpr double WINDOW = 1.5;
+        constexpr double PI     = 3.14159265358979323846;
+        taps.FirstOffset        = -2;
+        taps.Count              = 6;
+        double total            = 0;
+        for (int i = 0; i < taps.Count; ++i)
+        {
+            // distance from the center of the destination texel, in destination texels
+            const double x      = (static_cast<double>(taps.FirstOffset + i) - 0.5) / 2.0;
+            const double sinc   = (x == 0.0) ? 1.0 : std::sin(PI * x) / (PI * x);
+            const double ratio  = x / WINDOW;
+            const double window = bessel_i0(ALPHA * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / bessel_i0(ALPHA);
+            taps.Weights[static_cast<std::size_t>(i)] = static_cast<float>(sinc * window);
+            total += sinc * window;
+        }
+        for (int i = 0; i < taps.Count; ++i)
+        {
+            taps.Weights[static_cast<std::size_t>(i)] /= static_cast<float>(total);
+        }
+        return taps;
+    }
+
+    // small levels aren't worth waking the workers for
+    template <typename RowFunction>
+    void for_each_row(int rows, int row_length, RowFunction&& row_function)
+    {
+        constexpr int PIXELS_WORTH_SPLITTING = 64 * 64;
+        if (rows * row_length < PIXELS_WORTH_SPLITTING)
+        {
+            for (int row = 0; row < rows; ++row)
+            {
+                row_function(row);
+            }
+            return;
+        }
+        assets::get_loading_jobs().DoJobsAndWait(rows, row_function);
+    }
+
+    using Color = std::array<float, 4>;
+
+    // halves one row or one column, the colors of the line are `stride` apart
+    void filter_line(const Color* source, int source_count, int stride, Color* destination, int destination_count, const FilterTaps& taps) noexcept
+    {
+        for (int d = 0; d < destination_count; ++d)
+        {
+            Color sum{};
+            for (int t = 0; t < taps.Count; ++t)
+            {
+                const int    s      = std::clamp(2 * d + taps.FirstOffset + t, 0, source_count - 1);
+                const Color& color  = source[s * stride];
+                const float  weight = taps.Weights[static_cast<std::size_t>(t)];
+                for (std::size_t c = 0; c < 4; ++c)
+                {
+                    sum[c] += color[c] * weight;
+                }
+            }
+            destination[d * stride] = sum;
+        }
+    }
+
+    // https://en.wikipedia.org/wiki/SRGB#Transformation - reference
+    // both keep the 0 to 255 range of the bytes
+    const std::array<float, 256>& srgb_to_linear_table() noexcept
+    {
+        static const std::array<float, 256> table = []
+        {
+            std::array<float, 256> values{};
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                const double srgb   = static_cast<double>(i) / 255.0;
+                const double linear = (srgb <= 0.04045) ? srgb / 12.92 : std::pow((srgb + 0.055) / 1.055, 2.4);
+                values[i]           = static_cast<float>(linear * 255.0);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    float linear_to_srgb(float linear) noexcept
+    {
+        const double value = std::clamp(static_cast<double>(linear) / 255.0, 0.0, 1.0);
+        const double srgb  = (value <= 0.0031308) ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+        return static_cast<float>(srgb * 255.0);
+    }
+
+    // alpha is never gamma encoded, only the first three channels are converted
+    constexpr unsigned COLOR_CHANNELS = 3;
+
+    std::vector<Color> to_colors(const assets::Image& image, assets::ColorEncoding encoding)
+    {
+        const auto&        to_linear = srgb_to_linear_table();
+        std::vector<Color> colors(image.Pixels.size());
+        for (std::size_t i = 0; i < colors.size(); ++i)
+        {
+            const unsigned pixel = image.Pixels[i];
+            for (unsigned c = 0; c < 4; ++c)
+            {
+                const unsigned channel = (pixel >> (8 * c)) & 0xFFu;
+                colors[i][c]           = (encoding == assets::ColorEncoding::SRGB && c < COLOR_CHANNELS) ? to_linear[channel] : static_cast<float>(channel);
+            }
+        }
+        return colors;
+    }
+
+    assets::Image to_image(int width, int height, const std::vector<Color>& colors, assets::ColorEncoding encoding)
+    {
+        assets::Image image{ width, height, std::vector<unsigned>(colors.size()) };
+        for (std::size_t i = 0; i < colors.size(); ++i)
+        {
+            unsigned pixel = 0;
+            for (unsigned c = 0; c < 4; ++c)
+            {
+                const float value   = (encoding == assets::ColorEncoding::SRGB && c < COLOR_CHANNELS) ? linear_to_srgb(colors[i][c]) : colors[i][c];
+                const auto  channel = static_cast<unsigned>(std::clamp(value + 0.5f, 0.0f, 255.0f));
+                pixel |= channel << (8 * c);
+            }
+            image.Pixels[i] = pixel;
+        }
+        return image;
+    }
+
+    assets::Image next_mip_level(const assets::Image& level, const FilterTaps& taps, assets::ColorEncoding encoding)
+    {
+        const int  width        = level.Width;
+        const int  height       = level.Height;
+        const int  half_width   = std::max(1, width / 2);
+        const int  half_height  = std::max(1, height / 2);
+        const auto source       = to_colors(level, encoding);
+        const bool halve_width  = width > 1;
+        const bool halve_height = height > 1;
+
+        // horizontal pass, width x height -> half_width x height
+        std::vector<Color> horizontal(static_cast<std::size_t>(half_width) * static_cast<std::size_t>(height));
+        for_each_row(height, width,
+                     [&](int row)
+                     {
+                         const Color* source_row      = source.data() + static_cast<std::ptrdiff_t>(row) * width;
+                         Color*       destination_row = horizontal.data() + static_cast<std::ptrdiff_t>(row) * half_width;
+                         if (halve_width)
+                             filter_line(source_row, width, 1, destination_row, half_width, taps);
+                         else
+                             destination_row[0] = source_row[0];
+                     });
+
+        // vertical pass, half_width x height -> half_width x half_height
+        if (!halve_height)
+            return to_image(half_width, half_height, horizontal, encoding);
+        std::vector<Color> vertical(static_cast<std::size_t>(half_width) * static_cast<std::size_t>(half_height));
+        for_each_row(half_width, height, [&](int column) { filter_line(horizontal.data() + column, height, half_width, vertical.data() + column, half_height, taps); });
+        return to_image(half_width, half_height, vertical, encoding);
+    }
+}
+
+namespace assets
+{
+    bool decode_image_file(const std::filesystem::path& file_path, bool flip_vertical, Image& image)
+    {
+        std::ifstream ifs(file_path, std::ios::in | std::ios::binary);
+        if (!ifs)
+            return false;
+        const std::vector<unsigned char> file_contents{ std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() };
+
+        int           files_channels_count  = 0;
+        constexpr int desired_channel_count = 4;
+        stbi_uc* const rgba_pixels = stbi_load_from_memory(file_contents.data(), gsl::narrow<int>(file_contents.size()), &image.Width, &image.Height, &files_channels_count, desired_channel_count);
+        if (rgba_pixels == nullptr)
+            return false;
+        image.Pixels.resize(static_cast<std::size_t>(image.Width) * static_cast<std::size_t>(image.Height));
+        std::memcpy(image.Pixels.data(), rgba_pixels, image.Pixels.size() * sizeof(unsigned int));
+        stbi_image_free(rgba_pixels);
+
+        if (flip_vertical)
+            flip_rows(image);
+        return true;
+    }
+
+    std::vector<Image> generate_mip_chain(Image base_level, MipFilter filter, ColorEncoding encoding)
+    {
+        const FilterTaps   taps = make_taps(filter);
+        std::vector<Image> levels;
+        levels.push_back(std::move(base_level));
+        while (levels.back().Width > 1 || levels.back().Height > 1)
+        {
+            levels.push_back(next_mip_level(levels.back(), taps, encoding));
+        }
+        return levels;
+    }
+
+    util::JobSystem& get_loading_jobs()
+    {
+        // shared by every Reloader so switching demos doesn't spin up new threads
+        static util::JobSystem loading_jobs;
+        return loading_jobs;
+    }
+}
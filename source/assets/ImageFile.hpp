@@ -0,0 +1,49 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+namespace util
+{
+    class JobSystem;
+}
+
+namespace assets
+{
+    // RGBA8 pixels, one unsigned int per pixel like GLTexture::RGBA
+    struct Image
+    {
+        int                       Width  = 0;
+        int                       Height = 0;
+        std::vector<unsigned int> Pixels{};
+    };
+
+    // Reads and decodes a png/jpg/etc file. Safe to call from any thread
+    [[nodiscard]] bool decode_image_file(const std::filesystem::path& file_path, bool flip_vertical, Image& image);
+
+    enum class MipFilter
+    {
+        Box,   // averages each 2x2 block
+        Kaiser // Kaiser windowed sinc, keeps minified textures sharper than Box
+    };
+
+    enum class ColorEncoding
+    {
+        Linear, // the channels are filtered as they are, like for normal maps or data
+        SRGB    // red, green and blue are filtered in linear light and encoded back, alpha stays linear
+    };
+
+    // The image followed by every smaller level down to 1x1. Each level is filtered from the one before it,
+    // with the rows split across the loading jobs
+    [[nodiscard]] std::vector<Image> generate_mip_chain(Image base_level, MipFilter filter, ColorEncoding encoding);
+
+    // Background workers shared by everything that loads or processes asset files
+    util::JobSystem& get_loading_jobs();
+}
@@ -7,32 +7,33 @@
  */
 #include "Reloader.hpp"
 
+#include "ImageFile.hpp"
 #include "Path.hpp"
+#include "ShaderSource.hpp"
+#include "environment/OpenGL.hpp"
 #include "opengl/GLShader.hpp"
 #include "opengl/GLTexture.hpp"
+#include "util/JobSystem.hpp"
+#include "util/Profiler.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 namespace
 {
     std::filesystem::path              to_absolute_path(const std::filesystem::path& path_to_check);
     std::vector<std::filesystem::path> to_absolute_paths(std::span<const std::filesystem::path> paths_to_check);
+    std::vector<std::filesystem::path> get_dependencies(std::span<const std::filesystem::path> stage_paths);
+    bool                               has_settled(std::atomic_bool& has_changed, bool& is_settling, util::Timer& since_last_change) noexcept;
 }
 
 namespace assets
 {
     void Reloader::SetAndAutoReloadShader(GLShader& shader_to_reload, std::string_view shader_name, std::span<const std::filesystem::path> shader_file_paths)
     {
-        shader_to_reload                  = GLShader(shader_name, shader_file_paths);
-        auto&      info                   = shadersWatchingList.emplace_front(to_absolute_paths(shader_file_paths), &shader_to_reload);
-        const auto reload_shader_callback = [&](util::FileStatus status)
-        {
-            info.ShouldTryReloadAsset = (status == util::FileStatus::Created || status == util::FileStatus::Modified);
-        };
-        for (const auto& path : info.AbsolutePaths)
-        {
-            fileWatcher.Watch(path, reload_shader_callback);
-        }
+        shader_to_reload                  = GLShader(shader_name, shader_file_paths, GLShader::BuildMode::Async);
+        auto& info = shadersWatchingList.emplace_front(to_absolute_paths(shader_file_paths), &shader_to_reload);
+        watchShaderFiles(info, get_dependencies(info.AbsolutePaths));
     }
 
     void Reloader::SetAndAutoReloadShader(GLShader& shader_to_reload, std::string_view shader_name, const std::initializer_list<std::filesystem::path>& shader_file_paths)
@@ -40,61 +41,193 @@ namespace assets
         SetAndAutoReloadShader(shader_to_reload, shader_name, std::span{ std::begin(shader_file_paths), std::end(shader_file_paths) });
     }
 
-    void Reloader::SetAndAutoReloadTexture(GLTexture& texture_to_reload, const std::filesystem::path& image_filepath, bool flip_vertical)
+    void Reloader::SetAndAutoReloadTexture(GLTexture& texture_to_reload, const std::filesystem::path& image_filepath, bool flip_vertical, TextureCompression compression)
     {
-        std::filesystem::path absolute_path = to_absolute_path(image_filepath);
-        if (const bool loaded = texture_to_reload.LoadFromFileImage(absolute_path, flip_vertical); !loaded)
+        if (!environment::opengl::HasS3TCCompression)
         {
-            std::cerr << "Failed to reload texture\nCould not open " << absolute_path.string() << '\n';
-            return;
+            compression = TextureCompression::None;
         }
-        auto&      info                    = texturesWatchingList.emplace_front(std::move(absolute_path), &texture_to_reload);
-        const auto reload_texture_callback = [&](util::FileStatus status)
-        {
-            info.ShouldTryReloadAsset = (status == util::FileStatus::Created || status == util::FileStatus::Modified);
-        };
-        fileWatcher.Watch(info.AbsolutePath, reload_texture_callback);
+        std::filesystem::path       absolute_path = to_absolute_path(image_filepath);
+        constexpr GLTexture::RGBA   placeholder   = 0xFFFFFFFFu;
+        [[maybe_unused]] const bool created       = texture_to_reload.LoadFromMemory(1, 1, &placeholder);
+        auto&                       info          = texturesWatchingList.emplace_front(std::move(absolute_path), &texture_to_reload, flip_vertical, compression);
+        prepareTexture(info);
+        info.FileSubscription = util::get_file_watch_service().Subscribe(info.AbsolutePath, fileChanges, &info.ShouldTryReloadAsset);
     }
 
     void Reloader::Update()
     {
-        fileWatcher.Update();
+        const util::ProfileScope profile_scope("Reloader::Update");
+        util::get_file_watch_service().Update();
+        applyFileChanges();
+        // only the programs that use a changed file get rebuilt, and only that file is read again
+        for (auto& file_info : shaderFilesWatchingList)
+        {
+            if (!has_settled(file_info.HasChanged, file_info.IsSettling, file_info.SinceLastChange))
+                continue;
+
+            assets::forget_shader_file(file_info.AbsolutePath);
+            for (auto* shader_info : file_info.Dependents)
+            {
+                shader_info->ShouldTryReloadAsset = true;
+            }
+        }
         for (auto& shader_info : shadersWatchingList)
         {
-            if (!shader_info.ShouldTryReloadAsset)
+            if (shader_info.ShouldTryReloadAsset.exchange(false))
+            {
+                prepareShader(shader_info);
+            }
+        }
+        buildReadyShaders();
+        swapBuiltShaders();
+        for (auto& texture_info : texturesWatchingList)
+        {
+            if (!has_settled(texture_info.ShouldTryReloadAsset, texture_info.IsSettling, texture_info.SinceLastChange))
                 continue;
 
-            shader_info.ShouldTryReloadAsset = false;
-            auto& shader                     = *shader_info.ShaderPtr;
+            prepareTexture(texture_info);
+        }
+        uploadReadyTextures();
+    }
+
+    void Reloader::prepareShader(ShaderState& shader_info)
+    {
+        // reading and preprocessing the files happens on a loading job, the render thread only makes the GL calls
+        const unsigned version = ++shader_info.PreparingVersion;
+        get_loading_jobs().DoJob(
+            [ready_shaders = readyShaders, state = &shader_info, version, paths = shader_info.AbsolutePaths]
+            {
+                const util::ProfileScope profile_scope("Prepare Shader");
+                ReadyShader              ready{ state, version, false, {}, {}, {} };
+                ready.IsPrepared = GLShader::PrepareStages(paths, ready.Stages, ready.ErrorLog);
+                // the edit may have added an #include
+                ready.Dependencies = get_dependencies(paths);
+                const std::lock_guard lock(ready_shaders->Mutex);
+                ready_shaders->Shaders.push_back(std::move(ready));
+            });
+    }
+
+    void Reloader::buildReadyShaders()
+    {
+        std::vector<ReadyShader> ready;
+        {
+            const std::lock_guard lock(readyShaders->Mutex);
+            ready.swap(readyShaders->Shaders);
+        }
+        for (const auto& [shader_info, version, is_prepared, stages, dependencies, error_log] : ready)
+        {
+            // a newer edit is already being prepared
+            if (version != shader_info->PreparingVersion)
+                continue;
+
+            watchShaderFiles(*shader_info, dependencies);
+            if (!is_prepared)
+            {
+                std::cerr << "Failed to reload shader\n"
+                          << error_log << '\n';
+                continue;
+            }
+            const util::ProfileScope profile_scope("Submit Shader Build");
+            auto&                    shader = *shader_info->ShaderPtr;
             try
             {
-                auto new_version = GLShader(shader.GetName(), std::span{ shader_info.AbsolutePaths });
-                shader           = std::move(new_version);
+                // keep drawing with the current version until the new one is built, the stages that didn't change are attached as they are
+                shader_info->PendingShader = GLShader(shader.GetName(), std::span{ stages }, GLShader::BuildMode::Async, &shader);
             }
             catch (const std::exception& e)
             {
                 std::cerr << "Failed to reload shader\n"
                           << e.what() << '\n';
+                shader_info->PendingShader = GLShader{};
             }
         }
-        for (auto& texture_info : texturesWatchingList)
+    }
+
+    void Reloader::swapBuiltShaders()
+    {
+        for (auto& shader_info : shadersWatchingList)
         {
-            if (!texture_info.ShouldTryReloadAsset)
-                continue;
+            auto& pending_shader = shader_info.PendingShader;
+            if (pending_shader.IsReady())
+            {
+                *shader_info.ShaderPtr = std::move(pending_shader);
+                pending_shader         = GLShader{};
+            }
+            else if (pending_shader.HasFailed())
+            {
+                std::cerr << "Failed to reload shader\n";
+                pending_shader = GLShader{};
+            }
+        }
+    }
 
-            texture_info.ShouldTryReloadAsset = false;
+    void Reloader::prepareTexture(TextureState& texture_info)
+    {
+        prepare_texture_file_async(texture_info.AbsolutePath, texture_info.FlipVertical, texture_info.Compression,
+                                   [ready_textures = readyTextures, state = &texture_info](PreparedTexture&& prepared)
+                                   {
+                                       const std::lock_guard lock(ready_textures->Mutex);
+                                       ready_textures->Textures.push_back({ state, std::move(prepared) });
+                                   });
+    }
+
+    void Reloader::uploadReadyTextures()
+    {
+        std::vector<ReadyTexture> ready;
+        {
+            const std::lock_guard lock(readyTextures->Mutex);
+            ready.swap(readyTextures->Textures);
+        }
+        for (const auto& [texture_info, prepared] : ready)
+        {
             GLTexture new_version;
-            if (const bool loaded = new_version.LoadFromFileImage(texture_info.AbsolutePath); !loaded)
+            if (!new_version.LoadFromPreparedTexture(prepared))
             {
-                std::cerr << "Failed to reload texture\nCould not open " << texture_info.AbsolutePath.string() << '\n';
+                std::cerr << "Failed to load texture\nCould not open " << texture_info->AbsolutePath.string() << '\n';
+                continue;
             }
-            else
+            // keep the settings the demo gave the placeholder or the previous version
+            new_version.SetFiltering(texture_info->TexturePtr->GetFiltering());
+            const auto wrapping = texture_info->TexturePtr->GetWrapping();
+            new_version.SetWrapping(wrapping[0], GLTexture::S);
+            new_version.SetWrapping(wrapping[1], GLTexture::T);
+            *texture_info->TexturePtr = std::move(new_version);
+        }
+    }
+
+    void Reloader::applyFileChanges()
+    {
+        util::FileChange change;
+        while (fileChanges.TryPop(change))
+        {
+            *static_cast<std::atomic_bool*>(change.Context) = (change.Status == util::FileStatus::Created || change.Status == util::FileStatus::Modified);
+        }
+        if (fileChanges.TakeOverflow())
+        {
+            // some changes didn't fit in the queue, so we can't tell which files they were about
+            for (auto& file_info : shaderFilesWatchingList)
+                file_info.HasChanged = true;
+            for (auto& texture_info : texturesWatchingList)
+                texture_info.ShouldTryReloadAsset = true;
+        }
+    }
+
+    void Reloader::watchShaderFiles(ShaderState& shader_info, std::span<const std::filesystem::path> file_paths)
+    {
+        for (const auto& file_path : file_paths)
+        {
+            auto file_info = std::find_if(std::begin(shaderFilesWatchingList), std::end(shaderFilesWatchingList), [&](const ShaderFileState& watched) { return watched.AbsolutePath == file_path; });
+            if (file_info == std::end(shaderFilesWatchingList))
             {
-                new_version.SetFiltering(texture_info.TexturePtr->GetFiltering());
-                const auto wrapping = texture_info.TexturePtr->GetWrapping();
-                new_version.SetWrapping(wrapping[0], GLTexture::S);
-                new_version.SetWrapping(wrapping[1], GLTexture::T);
-                *texture_info.TexturePtr = std::move(new_version);
+                auto& new_file_info            = shaderFilesWatchingList.emplace_front(file_path);
+                new_file_info.FileSubscription = util::get_file_watch_service().Subscribe(new_file_info.AbsolutePath, fileChanges, &new_file_info.HasChanged);
+                file_info                      = shaderFilesWatchingList.begin();
+            }
+            auto& dependents = file_info->Dependents;
+            if (std::find(std::begin(dependents), std::end(dependents), &shader_info) == std::end(dependents))
+            {
+                dependents.push_back(&shader_info);
             }
         }
     }
@@ -127,4 +260,35 @@ namespace
         }
         return absolute_paths;
     }
+
+    std::vector<std::filesystem::path> get_dependencies(std::span<const std::filesystem::path> stage_paths)
+    {
+        std::vector<std::filesystem::path> dependencies;
+        for (const auto& stage_path : stage_paths)
+        {
+            for (auto& file_path : assets::get_shader_file_dependencies(stage_path))
+            {
+                if (std::find(std::begin(dependencies), std::end(dependencies), file_path) == std::end(dependencies))
+                {
+                    dependencies.push_back(std::move(file_path));
+                }
+            }
+        }
+        return dependencies;
+    }
+
+    // editors often save a file in several steps, so a reload waits until the file has been quiet for a moment
+    bool has_settled(std::atomic_bool& has_changed, bool& is_settling, util::Timer& since_last_change) noexcept
+    {
+        constexpr double SettleSeconds = 0.1;
+        if (has_changed.exchange(false))
+        {
+            is_settling = true;
+            since_last_change.ResetTimeStamp();
+        }
+        if (!is_settling || since_last_change.GetElapsedSeconds() < SettleSeconds)
+            return false;
+        is_settling = false;
+        return true;
+    }
 }
@@ -7,15 +7,19 @@
  */
 #pragma once
 
-#include "util/WatchFiles.hpp"
+#include "TextureCache.hpp"
+#include "opengl/GLShader.hpp"
+#include "util/FileWatchService.hpp"
+#include "util/Timer.hpp"
 #include <atomic>
 #include <filesystem>
 #include <forward_list>
+#include <memory>
+#include <mutex>
 #include <span>
 #include <string_view>
 #include <vector>
 
-class GLShader;
 class GLTexture;
 
 namespace assets
@@ -25,11 +29,16 @@ namespace assets
     public:
 
         // Will create the shader and start watching the shader files to reload it if they change
+        // The shader is built asynchronously, so creating several in a row lets the driver compile them in parallel
+        // A reload waits for the files to settle, reads them on a loading job and only recompiles the stages whose text changed
         void SetAndAutoReloadShader(GLShader& shader_to_reload, std::string_view shader_name, std::span<const std::filesystem::path> shader_file_paths);
         void SetAndAutoReloadShader(GLShader& shader_to_reload, std::string_view shader_name, const std::initializer_list<std::filesystem::path>& shader_file_paths);
 
-        // Will create the texture and start watching the shader files to reload it if they change
-        void SetAndAutoReloadTexture(GLTexture& texture_to_reload, const std::filesystem::path& image_filepath, bool flip_vertical = true);
+        // Gives the texture a 1x1 white placeholder, prepares the image and its mip chain on a background thread and swaps it in during Update()
+        // Also starts watching the image file to reload it if it changes
+        // Compression is skipped if the OpenGL context can't sample S3TC textures
+        void SetAndAutoReloadTexture(GLTexture& texture_to_reload, const std::filesystem::path& image_filepath, bool flip_vertical = true,
+                                     TextureCompression compression = TextureCompression::None);
 
         void Update();
 
@@ -41,6 +50,8 @@ namespace assets
             std::vector<std::filesystem::path> AbsolutePaths;
             std::atomic_bool                   ShouldTryReloadAsset;
             GLShader*                          ShaderPtr;
+            GLShader                           PendingShader{};      // replaces *ShaderPtr once it is ready so reloading doesn't stall the frame
+            unsigned                           PreparingVersion = 0; // stages prepared for an older version are dropped
 
             ShaderState(std::vector<std::filesystem::path>&& paths, GLShader* shader_ptr)
                 : AbsolutePaths{ std::move(paths) }, ShouldTryReloadAsset{ false }, ShaderPtr(shader_ptr)
@@ -50,18 +61,84 @@ namespace assets
 
         struct TextureState
         {
-            std::filesystem::path AbsolutePath;
-            std::atomic_bool      ShouldTryReloadAsset;
-            GLTexture*            TexturePtr;
+            std::filesystem::path                AbsolutePath;
+            std::atomic_bool                     ShouldTryReloadAsset;
+            GLTexture*                           TexturePtr;
+            bool                                 FlipVertical;
+            TextureCompression                   Compression;
+            util::FileWatchService::Subscription FileSubscription{};
+            bool                                 IsSettling = false;
+            util::Timer                          SinceLastChange{};
 
-            TextureState(std::filesystem::path&& path, GLTexture* texture_ptr)
-                : AbsolutePath{ std::move(path) }, ShouldTryReloadAsset{ false }, TexturePtr(texture_ptr)
+            TextureState(std::filesystem::path&& path, GLTexture* texture_ptr, bool flip_vertical, TextureCompression compression)
+                : AbsolutePath{ std::move(path) }, ShouldTryReloadAsset{ false }, TexturePtr(texture_ptr), FlipVertical(flip_vertical), Compression(compression)
             {
             }
         };
 
-        std::forward_list<ShaderState>  shadersWatchingList;
-        std::forward_list<TextureState> texturesWatchingList;
-        util::WatchFiles                fileWatcher{};
+        struct ReadyTexture
+        {
+            TextureState*   State;
+            PreparedTexture Prepared;
+        };
+
+        // Filled by the loading threads, emptied by Update()
+        // Shared with the pending loads so it outlives a Reloader that is destroyed while they are still running
+        struct ReadyTextureQueue
+        {
+            std::mutex                Mutex;
+            std::vector<ReadyTexture> Textures;
+        };
+
+        struct ReadyShader
+        {
+            ShaderState*                       State;
+            unsigned                           Version;
+            bool                               IsPrepared;
+            std::vector<GLShader::Stage>       Stages;
+            std::vector<std::filesystem::path> Dependencies;
+            std::string                        ErrorLog;
+        };
+
+        // Filled by the loading jobs with shader text that is ready to compile, emptied by Update()
+        struct ReadyShaderQueue
+        {
+            std::mutex               Mutex;
+            std::vector<ReadyShader> Shaders;
+        };
+
+        // A glsl file on disk, shared by every shader that uses it directly or through an #include
+        struct ShaderFileState
+        {
+            std::filesystem::path                AbsolutePath;
+            std::atomic_bool                     HasChanged;
+            std::vector<ShaderState*>            Dependents;
+            util::FileWatchService::Subscription FileSubscription{};
+            bool                                 IsSettling = false;
+            util::Timer                          SinceLastChange{};
+
+            explicit ShaderFileState(const std::filesystem::path& path)
+                : AbsolutePath{ path }, HasChanged{ false }
+            {
+            }
+        };
+
+        // the file watch service pushes the address of the flag to set, drained in Update()
+        // declared before the states so it outlives their subscriptions
+        util::FileChangeQueue              fileChanges;
+        std::forward_list<ShaderState>     shadersWatchingList;
+        std::forward_list<ShaderFileState> shaderFilesWatchingList;
+        std::forward_list<TextureState>    texturesWatchingList;
+        std::shared_ptr<ReadyTextureQueue> readyTextures = std::make_shared<ReadyTextureQueue>();
+        std::shared_ptr<ReadyShaderQueue>  readyShaders  = std::make_shared<ReadyShaderQueue>();
+
+    private:
+        void watchShaderFiles(ShaderState& shader_info, std::span<const std::filesystem::path> file_paths);
+        void prepareShader(ShaderState& shader_info);
+        void buildReadyShaders();
+        void swapBuiltShaders();
+        void prepareTexture(TextureState& texture_info);
+        void uploadReadyTextures();
+        void applyFileChanges();
     };
 }
@@ -0,0 +1,239 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "ShaderSource.hpp"
+
+#include "Path.hpp"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string_view>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    // The text between two #include (or #version) lines, followed by the file the second one pulls in
+    struct Piece
+    {
+        std::string Text;
+        int         FirstLine = 1; // of Text in its file, so the compiler's errors can point back at it
+        fs::path    IncludePath;
+    };
+
+    struct CachedFile
+    {
+        std::string        Version; // the #version line, it is taken out of the pieces
+        std::vector<Piece> Pieces;
+    };
+
+    // keyed by canonical path, so the same file reached through different relative paths is only read once
+    // the Reloader preprocesses on the loading jobs, so every access holds the mutex and readers keep their own reference
+    std::map<fs::path, std::shared_ptr<const CachedFile>> cached_files;
+    std::mutex                                            cached_files_mutex;
+    // bumped by forget_shader_file() so a read that started before it doesn't cache the old text
+    unsigned                                              cached_files_generation = 0;
+
+    constexpr std::string_view trim_front(std::string_view text) noexcept
+    {
+        const auto first = text.find_first_not_of(" \t");
+        return (first == std::string_view::npos) ? std::string_view{} : text.substr(first);
+    }
+
+    constexpr bool is_version_directive(std::string_view line) noexcept
+    {
+        line = trim_front(line);
+        if (!line.starts_with('#'))
+            return false;
+        return trim_front(line.substr(1)).starts_with("version");
+    }
+
+    struct IncludeDirective
+    {
+        std::string_view Name;
+        bool             IsRelativeToIncluder;
+    };
+
+    constexpr std::optional<IncludeDirective> parse_include(std::string_view line) noexcept
+    {
+        line = trim_front(line);
+        if (!line.starts_with('#'))
+            return {};
+        line = trim_front(line.substr(1));
+        if (!line.starts_with("include"))
+            return {};
+        line = trim_front(line.substr(std::string_view("include").size()));
+        if (line.empty() || (line[0] != '"' && line[0] != '<'))
+            return {};
+        const char close_quote = (line[0] == '"') ? '"' : '>';
+        const auto close       = line.find(close_quote, 1);
+        if (close == std::string_view::npos || close == 1)
+            return {};
+        return IncludeDirective{ line.substr(1, close - 1), close_quote == '"' };
+    }
+
+    std::optional<fs::path> resolve_path(const fs::path& file_path)
+    {
+        if (fs::exists(file_path))
+            return fs::weakly_canonical(file_path);
+        // try prepending the asset directory path
+        if (const auto in_assets = assets::get_base_path() / file_path; fs::exists(in_assets))
+            return fs::weakly_canonical(in_assets);
+        return {};
+    }
+
+    std::optional<fs::path> resolve_include(const IncludeDirective& include, const fs::path& includer_path)
+    {
+        if (include.IsRelativeToIncluder)
+        {
+            if (const auto next_to_includer = includer_path.parent_path() / include.Name; fs::exists(next_to_includer))
+                return fs::weakly_canonical(next_to_includer);
+        }
+        if (const auto in_assets = assets::get_base_path() / include.Name; fs::exists(in_assets))
+            return fs::weakly_canonical(in_assets);
+        return {};
+    }
+
+    std::shared_ptr<const CachedFile> find_or_read(const fs::path& canonical_path, std::string& error_log)
+    {
+        unsigned generation = 0;
+        {
+            const std::lock_guard lock(cached_files_mutex);
+            if (const auto found = cached_files.find(canonical_path); found != cached_files.end())
+                return found->second;
+            generation = cached_files_generation;
+        }
+
+        // read outside of the lock, if two threads race for the same file the first one to finish wins
+        std::ifstream ifs(canonical_path, std::ios::in);
+        if (!ifs)
+        {
+            error_log = "Cannot open " + canonical_path.string() + "\n";
+            return nullptr;
+        }
+        auto        file = std::make_shared<CachedFile>();
+        Piece       piece;
+        std::string line;
+        int         line_number = 0;
+        while (std::getline(ifs, line))
+        {
+            ++line_number;
+            if (file->Version.empty() && is_version_directive(line))
+            {
+                file->Version = line;
+                file->Pieces.push_back(std::move(piece));
+                piece           = Piece{};
+                piece.FirstLine = line_number + 1;
+                continue;
+            }
+            if (const auto include = parse_include(line); include)
+            {
+                const auto include_path = resolve_include(*include, canonical_path);
+                if (!include_path)
+                {
+                    error_log = "Cannot find #include " + std::string(include->Name) + " in " + canonical_path.string() + "\n";
+                    return nullptr;
+                }
+                piece.IncludePath = *include_path;
+                file->Pieces.push_back(std::move(piece));
+                piece           = Piece{};
+                piece.FirstLine = line_number + 1;
+                continue;
+            }
+            piece.Text += line;
+            piece.Text += '\n';
+        }
+        file->Pieces.push_back(std::move(piece));
+        const std::lock_guard lock(cached_files_mutex);
+        if (generation != cached_files_generation)
+            return file;
+        return cached_files.emplace(canonical_path, std::move(file)).first->second;
+    }
+
+    // Every piece starts with a #line so errors report the line in its own file,
+    // the source string number is the file's order of inclusion: 0 for the shader itself, 1 for the first include...
+    bool expand(const fs::path& canonical_path, std::string& glsl_text, std::set<fs::path>& included_files, std::string& error_log)
+    {
+        if (!included_files.insert(canonical_path).second)
+            return true;
+        const auto file = find_or_read(canonical_path, error_log);
+        if (file == nullptr)
+            return false;
+        const auto source_number = included_files.size() - 1;
+        // only the shader's own #version counts, it has to come before anything else
+        if (source_number == 0 && !file->Version.empty())
+        {
+            glsl_text += file->Version;
+            glsl_text += '\n';
+        }
+        for (const auto& piece : file->Pieces)
+        {
+            if (!piece.Text.empty())
+            {
+                glsl_text += "#line " + std::to_string(piece.FirstLine) + ' ' + std::to_string(source_number) + " // " + canonical_path.filename().string() + '\n';
+                glsl_text += piece.Text;
+            }
+            if (!piece.IncludePath.empty() && !expand(piece.IncludePath, glsl_text, included_files, error_log))
+                return false;
+        }
+        return true;
+    }
+}
+
+namespace assets
+{
+    bool preprocess_shader_file(const std::filesystem::path& file_path, std::string& glsl_text, std::string& error_log)
+    {
+        const auto canonical_path = resolve_path(file_path);
+        if (!canonical_path)
+        {
+            error_log = "Cannot find " + file_path.string() + "\n";
+            return false;
+        }
+        std::set<fs::path> included_files;
+        glsl_text.clear();
+        return expand(*canonical_path, glsl_text, included_files, error_log);
+    }
+
+    std::vector<std::filesystem::path> get_shader_file_dependencies(const std::filesystem::path& file_path)
+    {
+        std::vector<fs::path> dependencies;
+        const auto            canonical_path = resolve_path(file_path);
+        if (!canonical_path)
+            return dependencies;
+        dependencies.push_back(*canonical_path);
+        std::string error_log;
+        // the list doubles as the work queue, every file gets visited once
+        for (std::size_t i = 0; i < dependencies.size(); ++i)
+        {
+            const auto file = find_or_read(dependencies[i], error_log);
+            if (file == nullptr)
+                continue;
+            for (const auto& piece : file->Pieces)
+            {
+                if (!piece.IncludePath.empty() && std::find(dependencies.begin(), dependencies.end(), piece.IncludePath) == dependencies.end())
+                    dependencies.push_back(piece.IncludePath);
+            }
+        }
+        return dependencies;
+    }
+
+    void forget_shader_file(const std::filesystem::path& file_path)
+    {
+        const auto            canonical_path = resolve_path(file_path);
+        const std::lock_guard lock(cached_files_mutex);
+        ++cached_files_generation;
+        if (canonical_path)
+            cached_files.erase(*canonical_path);
+        else
+            cached_files.erase(file_path);
+    }
+}
@@ -0,0 +1,28 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace assets
+{
+    // Reads a glsl file and pastes in every file it #include's, either "relative/to/the/includer.glsl" or <relative/to/assets.glsl>
+    // A file is only pasted in once per shader, as if it had an include guard
+    // Each pasted in part starts with a #line naming its file, a #version in an included file is dropped
+    // Files are read from disk once and then cached until forget_shader_file() is called for them
+    // Safe to call from any thread, it makes no OpenGL calls
+    [[nodiscard]] bool preprocess_shader_file(const std::filesystem::path& file_path, std::string& glsl_text, std::string& error_log);
+
+    // The file itself followed by every file it includes, directly or indirectly
+    [[nodiscard]] std::vector<std::filesystem::path> get_shader_file_dependencies(const std::filesystem::path& file_path);
+
+    // Drops the cached text of the file so the next preprocess reads it again
+    void forget_shader_file(const std::filesystem::path& file_path);
+}
@@ -0,0 +1,250 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "TextureCache.hpp"
+
+#include "BlockCompression.hpp"
+#include "ImageFile.hpp"
+#include "util/JobSystem.hpp"
+#include "util/Profiler.hpp"
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    fs::path cache_directory;
+
+    std::atomic<unsigned> partial_file_count{ 0 };
+
+    // bump when the filtering, the encoders or the layout below change so old files get rebuilt
+    constexpr std::uint32_t CACHE_VERSION = 2;
+    constexpr std::array    CACHE_MAGIC   = { 'C', 'S', '2', '5', '0', 'T', 'E', 'X' };
+
+    struct CacheHeader
+    {
+        std::array<char, 8> Magic{};
+        std::uint32_t       Version    = 0;
+        std::uint32_t       Format     = 0;
+        std::uint64_t       SourceSize = 0;
+        std::int64_t        SourceTime = 0;
+        std::uint32_t       LevelCount = 0;
+    };
+
+    struct CacheLevelHeader
+    {
+        std::int32_t  Width    = 0;
+        std::int32_t  Height   = 0;
+        std::uint64_t DataSize = 0;
+    };
+
+    // FNV-1a
+    std::uint64_t hash_text(std::string_view text) noexcept
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (const char c : text)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    fs::path cache_file_path(const fs::path& source_path, bool flip_vertical, assets::TextureCompression compression)
+    {
+        std::ostringstream key;
+        // a path that can't be resolved still names the same file every run, so it keys the cache as is
+        std::error_code error;
+        fs::path        resolved_path = fs::weakly_canonical(source_path, error);
+        if (error)
+            resolved_path = source_path;
+        key << resolved_path.string() << '|' << flip_vertical << '|' << static_cast<int>(compression);
+        std::ostringstream file_name;
+        file_name << source_path.stem().string() << '_' << std::hex << hash_text(key.str()) << ".texture";
+        return cache_directory / file_name.str();
+    }
+
+    CacheHeader make_header(const fs::path& source_path, std::error_code& error)
+    {
+        CacheHeader header;
+        header.Magic      = CACHE_MAGIC;
+        header.Version    = CACHE_VERSION;
+        // each call clears the error when it succeeds, so check after every one of them
+        header.SourceSize = fs::file_size(source_path, error);
+        if (error)
+            return header;
+        header.SourceTime = static_cast<std::int64_t>(fs::last_write_time(source_path, error).time_since_epoch().count());
+        return header;
+    }
+
+    template <typename T>
+    bool read_value(std::istream& is, T& value)
+    {
+        return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    template <typename T>
+    void write_value(std::ostream& os, const T& value)
+    {
+        os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    bool load_from_cache(const fs::path& cache_path, const CacheHeader& expected, assets::PreparedTexture& prepared)
+    {
+        std::ifstream ifs(cache_path, std::ios::in | std::ios::binary);
+        if (!ifs)
+            return false;
+        CacheHeader header;
+        if (!read_value(ifs, header) || header.Magic != expected.Magic || header.Version != expected.Version || header.SourceSize != expected.SourceSize ||
+            header.SourceTime != expected.SourceTime || header.Format > assets::PreparedTexture::BC3)
+            return false;
+
+        prepared.Format = static_cast<assets::PreparedTexture::PixelFormat>(header.Format);
+        prepared.Levels.resize(header.LevelCount);
+        for (auto& level : prepared.Levels)
+        {
+            CacheLevelHeader level_header;
+            if (!read_value(ifs, level_header))
+                return false;
+            level.Width  = level_header.Width;
+            level.Height = level_header.Height;
+            level.Data.resize(level_header.DataSize);
+            if (!ifs.read(reinterpret_cast<char*>(level.Data.data()), static_cast<std::streamsize>(level.Data.size())))
+                return false;
+        }
+        return !prepared.Levels.empty();
+    }
+
+    void save_to_cache(const fs::path& cache_path, CacheHeader header, const assets::PreparedTexture& prepared)
+    {
+        std::error_code error;
+        fs::create_directories(cache_path.parent_path(), error);
+        // write next to it and then swap it in, so a half written file is never read
+        // every writer gets its own file, two jobs preparing the same texture would interleave in a shared one
+        fs::path temporary_path = cache_path;
+        temporary_path += ".partial" + std::to_string(partial_file_count.fetch_add(1, std::memory_order_relaxed));
+        {
+            std::ofstream ofs(temporary_path, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!ofs)
+                return;
+            header.Format     = prepared.Format;
+            header.LevelCount = static_cast<std::uint32_t>(prepared.Levels.size());
+            write_value(ofs, header);
+            for (const auto& level : prepared.Levels)
+            {
+                write_value(ofs, CacheLevelHeader{ level.Width, level.Height, level.Data.size() });
+                ofs.write(reinterpret_cast<const char*>(level.Data.data()), static_cast<std::streamsize>(level.Data.size()));
+            }
+            if (!ofs)
+            {
+                ofs.close();
+                fs::remove(temporary_path, error);
+                return;
+            }
+        }
+        fs::rename(temporary_path, cache_path, error);
+        if (error)
+        {
+            std::cerr << "Failed to save " << cache_path.string() << " : " << error.message() << '\n';
+            fs::remove(temporary_path, error);
+        }
+    }
+
+    bool has_alpha(const assets::Image& image) noexcept
+    {
+        for (const auto pixel : image.Pixels)
+        {
+            if ((pixel >> 24) != 0xFFu)
+                return true;
+        }
+        return false;
+    }
+
+    bool build_prepared_texture(const fs::path& file_path, bool flip_vertical, assets::TextureCompression compression, assets::PreparedTexture& prepared)
+    {
+        assets::Image image;
+        if (!assets::decode_image_file(file_path, flip_vertical, image))
+            return false;
+
+        prepared.Format = assets::PreparedTexture::RGBA8;
+        if (compression == assets::TextureCompression::BC)
+        {
+            prepared.Format = has_alpha(image) ? assets::PreparedTexture::BC3 : assets::PreparedTexture::BC1;
+        }
+
+        // image files hold sRGB colors
+        auto mip_chain = assets::generate_mip_chain(std::move(image), assets::MipFilter::Kaiser, assets::ColorEncoding::SRGB);
+        prepared.Levels.resize(mip_chain.size());
+        const auto prepare_level = [&](int index)
+        {
+            const auto& level          = mip_chain[static_cast<std::size_t>(index)];
+            auto&       prepared_level = prepared.Levels[static_cast<std::size_t>(index)];
+            prepared_level.Width       = level.Width;
+            prepared_level.Height      = level.Height;
+            switch (prepared.Format)
+            {
+                case assets::PreparedTexture::BC1: prepared_level.Data = assets::encode_bc1(level); break;
+                case assets::PreparedTexture::BC3: prepared_level.Data = assets::encode_bc3(level); break;
+                case assets::PreparedTexture::RGBA8:
+                    prepared_level.Data.resize(level.Pixels.size() * sizeof(unsigned));
+                    std::memcpy(prepared_level.Data.data(), level.Pixels.data(), prepared_level.Data.size());
+                    break;
+            }
+        };
+        assets::get_loading_jobs().DoJobsAndWait(static_cast<int>(mip_chain.size()), prepare_level);
+        return true;
+    }
+}
+
+namespace assets
+{
+    void set_texture_cache_directory(const std::filesystem::path& directory_path)
+    {
+        cache_directory = directory_path;
+    }
+
+    bool prepare_texture_file(const std::filesystem::path& file_path, bool flip_vertical, TextureCompression compression, PreparedTexture& prepared)
+    {
+        if (cache_directory.empty())
+            return build_prepared_texture(file_path, flip_vertical, compression, prepared);
+
+        std::error_code   error;
+        const CacheHeader header     = make_header(file_path, error);
+        const fs::path    cache_path = cache_file_path(file_path, flip_vertical, compression);
+        if (!error && load_from_cache(cache_path, header, prepared))
+            return true;
+
+        prepared = PreparedTexture{};
+        if (!build_prepared_texture(file_path, flip_vertical, compression, prepared))
+            return false;
+        if (!error)
+            save_to_cache(cache_path, header, prepared);
+        return true;
+    }
+
+    void prepare_texture_file_async(std::filesystem::path file_path, bool flip_vertical, TextureCompression compression, TexturePreparedCallback on_prepared)
+    {
+        get_loading_jobs().DoJob(
+            [file_path = std::move(file_path), flip_vertical, compression, on_prepared = std::move(on_prepared)]
+            {
+                const util::ProfileScope profile_scope("Prepare Texture");
+                PreparedTexture          prepared;
+                if (!prepare_texture_file(file_path, flip_vertical, compression, prepared))
+                {
+                    prepared = PreparedTexture{};
+                }
+                on_prepared(std::move(prepared));
+            });
+    }
+}
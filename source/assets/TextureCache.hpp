@@ -0,0 +1,58 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+namespace assets
+{
+    enum class TextureCompression
+    {
+        None, // RGBA8, lossless
+        BC    // BC1 for opaque images and BC3 for images with alpha, a quarter or an eighth of the memory
+    };
+
+    // A full mip chain, ready to hand to GLTexture::LoadFromPreparedTexture
+    struct PreparedTexture
+    {
+        enum PixelFormat : std::uint32_t
+        {
+            RGBA8,
+            BC1,
+            BC3
+        };
+
+        struct Level
+        {
+            int                    Width  = 0;
+            int                    Height = 0;
+            std::vector<std::byte> Data{};
+        };
+
+        PixelFormat        Format = RGBA8;
+        std::vector<Level> Levels{};
+    };
+
+    // Where prepared textures are saved, no caching happens until this is set
+    // Set it once at startup, before any textures are loaded
+    void set_texture_cache_directory(const std::filesystem::path& directory_path);
+
+    // Reads the image's prepared version from the cache if it is newer than the image.
+    // Otherwise decodes it, builds the mip chain, compresses it if asked and saves the result to the cache.
+    // Safe to call from any thread
+    [[nodiscard]] bool prepare_texture_file(const std::filesystem::path& file_path, bool flip_vertical, TextureCompression compression, PreparedTexture& prepared);
+
+    // Runs prepare_texture_file on the loading jobs and then calls on_prepared on that worker.
+    // The texture has no levels if it couldn't be prepared
+    using TexturePreparedCallback = std::function<void(PreparedTexture&&)>;
+    void prepare_texture_file_async(std::filesystem::path file_path, bool flip_vertical, TextureCompression compression, TexturePreparedCallback on_prepared);
+}
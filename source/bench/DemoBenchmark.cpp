@@ -0,0 +1,217 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "DemoBenchmark.hpp"
+
+#include "environment/Environment.hpp"
+#include "environment/Input.hpp"
+#include "opengl/GL.hpp"
+#include "util/Timer.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <exception>
+#include <iomanip>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    using environment::input::KeyboardButtons;
+    using environment::input::MouseButtons;
+
+    // The same input every run: walk forward, strafe, back up and strafe back while the mouse circles the screen
+    // and the left button and wheel are tapped now and then
+    class ScriptedInput
+    {
+    public:
+        void Apply(int frame, int frame_count, int width, int height)
+        {
+            constexpr std::array<KeyboardButtons, 4> walk_keys = { KeyboardButtons::W, KeyboardButtons::D, KeyboardButtons::S, KeyboardButtons::A };
+            constexpr int                            TapEvery  = 60;
+            const int                                quarter   = std::max(frame_count / 4, 1);
+
+            pressedKeys.assign(1, walk_keys[static_cast<std::size_t>(std::min(frame / quarter, 3))]);
+            pressedMouse.clear();
+            if ((frame / TapEvery) % 2 == 1)
+                pressedMouse.push_back(MouseButtons::Left);
+
+            constexpr double Radius = 0.25;
+            const double     angle  = 2.0 * 3.14159265358979323846 * static_cast<double>(frame) / static_cast<double>(std::max(frame_count, 1));
+            const double     x      = (0.5 + Radius * std::cos(angle)) * static_cast<double>(width);
+            const double     y      = (0.5 + Radius * std::sin(angle)) * static_cast<double>(height);
+
+            using namespace environment::input;
+            MouseVelocityX          = (frame == 0) ? 0.0 : x - MouseWindowX;
+            MouseVelocityY          = (frame == 0) ? 0.0 : y - MouseWindowY;
+            MouseWindowX            = x;
+            MouseWindowY            = y;
+            MouseDisplayX           = x;
+            MouseDisplayY           = static_cast<double>(height) - y;
+            MouseWheel              = (frame % TapEvery == TapEvery - 1) ? 1.0 : 0.0;
+            PressedKeyboardButtons  = pressedKeys;
+            ReleasedKeyboardButtons = {};
+            PressedMouseButtons     = pressedMouse;
+            ReleasedMouseButtons    = {};
+        }
+
+        ~ScriptedInput()
+        {
+            // the spans would point into this object
+            using namespace environment::input;
+            PressedKeyboardButtons = {};
+            PressedMouseButtons    = {};
+        }
+
+    private:
+        std::vector<KeyboardButtons> pressedKeys;
+        std::vector<MouseButtons>    pressedMouse;
+    };
+
+    double milliseconds_since(const util::Timer& timer) noexcept
+    {
+        return timer.GetElapsedSeconds() * 1000.0;
+    }
+
+    void write_json_string(std::ostream& output, std::string_view text)
+    {
+        output << '"';
+        for (const char c : text)
+        {
+            switch (c)
+            {
+                case '"': output << "\\\""; break;
+                case '\\': output << "\\\\"; break;
+                case '\n': output << "\\n"; break;
+                default:
+                    if (static_cast<unsigned char>(c) >= 0x20)
+                        output << c;
+                    break;
+            }
+        }
+        output << '"';
+    }
+
+    void write_phase(std::ostream& output, std::string_view name, const bench::PhaseTime& phase, int frames)
+    {
+        const double average = (frames > 0) ? phase.TotalMilliseconds / frames : 0.0;
+        output << '"' << name << "\":{\"average_ms\":" << average << ",\"max_ms\":" << phase.MaxMilliseconds << ",\"total_ms\":" << phase.TotalMilliseconds << '}';
+    }
+}
+
+namespace bench
+{
+    void PhaseTime::Add(double milliseconds) noexcept
+    {
+        TotalMilliseconds += milliseconds;
+        MaxMilliseconds = std::max(MaxMilliseconds, milliseconds);
+    }
+
+    DemoResult run_demo(demos::Demos the_demo, const BenchOptions& options)
+    {
+        DemoResult result;
+        result.Demo = the_demo;
+
+        environment::DeltaTime   = 0;
+        environment::ElapsedTime = 0;
+        environment::FrameCount  = 0;
+        GL::InvalidateStateCache();
+
+        ScriptedInput                 input;
+        util::FrameTimes              frame_times;
+        util::Timer                   timer;
+        std::unique_ptr<demos::IDemo> demo;
+        try
+        {
+            demo.reset(demos::create_demo(the_demo));
+            demo->SetDisplaySize(options.Width, options.Height);
+            GL::Finish();
+            result.CreateMilliseconds = milliseconds_since(timer);
+
+            GL::ResetStateCacheCounts();
+            for (int frame = 0; frame < options.Frames; ++frame)
+            {
+                environment::DeltaTime = options.TimeStepSeconds;
+                environment::ElapsedTime += options.TimeStepSeconds;
+                ++environment::FrameCount;
+                input.Apply(frame, options.Frames, options.Width, options.Height);
+
+                // one fixed step per frame, run inline so it counts as update time
+                timer.ResetTimeStamp();
+                demo->Simulate(demos::SimulationStep{ options.TimeStepSeconds, static_cast<unsigned long long>(frame) });
+                demo->PublishSimulation();
+                demo->Update();
+                const double update_ms = milliseconds_since(timer);
+
+                timer.ResetTimeStamp();
+                demo->Draw();
+                const double draw_ms = milliseconds_since(timer);
+
+                timer.ResetTimeStamp();
+                GL::Finish();
+                const double finish_ms = milliseconds_since(timer);
+
+                result.Update.Add(update_ms);
+                result.Draw.Add(draw_ms);
+                result.Finish.Add(finish_ms);
+                frame_times.Add((update_ms + draw_ms + finish_ms) / 1000.0);
+
+                const auto counts = GL::GetStateCacheCounts();
+                GL::ResetStateCacheCounts();
+                result.DrawCalls += counts.DrawCalls;
+                result.Dispatches += counts.Dispatches;
+                result.StateChanges += counts.Issued;
+                result.RedundantStateChanges += counts.Redundant;
+                ++result.Frames;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            result.Error = e.what();
+        }
+        demo.reset();
+        result.FrameTimes = frame_times.GetStatistics();
+        return result;
+    }
+
+    void write_json(std::ostream& output, const std::string& renderer, const std::string& version, const BenchOptions& options, std::span<const DemoResult> results)
+    {
+        output << std::fixed << std::setprecision(3) << "{\n\"renderer\":";
+        write_json_string(output, renderer);
+        output << ",\n\"version\":";
+        write_json_string(output, version);
+        output << ",\n\"frames\":" << options.Frames << ",\n\"width\":" << options.Width << ",\n\"height\":" << options.Height << ",\n\"time_step_ms\":" << options.TimeStepSeconds * 1000.0
+               << ",\n\"demos\":[";
+        bool is_first = true;
+        for (const auto& result : results)
+        {
+            output << (is_first ? "\n" : ",\n") << "{\"name\":";
+            is_first = false;
+            write_json_string(output, demos::demo_to_string(result.Demo));
+            if (!result.Error.empty())
+            {
+                output << ",\"error\":";
+                write_json_string(output, result.Error);
+            }
+            const double frames = std::max(result.Frames, 1);
+            output << ",\"frames\":" << result.Frames << ",\"create_ms\":" << result.CreateMilliseconds << ",\n \"phases\":{";
+            write_phase(output, "update", result.Update, result.Frames);
+            output << ',';
+            write_phase(output, "draw", result.Draw, result.Frames);
+            output << ',';
+            write_phase(output, "finish", result.Finish, result.Frames);
+            output << "},\n \"gl_per_frame\":{\"draw_calls\":" << static_cast<double>(result.DrawCalls) / frames << ",\"dispatches\":" << static_cast<double>(result.Dispatches) / frames
+                   << ",\"state_changes\":" << static_cast<double>(result.StateChanges) / frames << ",\"redundant_state_changes\":" << static_cast<double>(result.RedundantStateChanges) / frames
+                   << "},\n \"frame_times\":{\"average_ms\":" << result.FrameTimes.AverageMilliseconds << ",\"p50_ms\":" << result.FrameTimes.P50Milliseconds
+                   << ",\"p95_ms\":" << result.FrameTimes.P95Milliseconds << ",\"p99_ms\":" << result.FrameTimes.P99Milliseconds << ",\"max_ms\":" << result.FrameTimes.MaxMilliseconds
+                   << ",\"hitches\":" << result.FrameTimes.Hitches << "}}";
+        }
+        output << "\n]\n}\n";
+    }
+}
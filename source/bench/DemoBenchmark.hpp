@@ -0,0 +1,56 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include "demos/DemosFactory.hpp"
+#include "util/FrameTimes.hpp"
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+
+namespace bench
+{
+    struct BenchOptions
+    {
+        int    Frames          = 600;
+        int    Width           = 800;
+        int    Height          = 600;
+        double TimeStepSeconds = 1.0 / 60.0; // every frame claims this much time passed, so runs are repeatable
+    };
+
+    struct PhaseTime
+    {
+        double TotalMilliseconds = 0;
+        double MaxMilliseconds   = 0;
+
+        void Add(double milliseconds) noexcept;
+    };
+
+    struct DemoResult
+    {
+        demos::Demos              Demo = demos::Demos::None;
+        std::string               Error{}; // empty when the demo ran every frame
+        int                       Frames             = 0;
+        double                    CreateMilliseconds = 0;
+        PhaseTime                 Update{};
+        PhaseTime                 Draw{};   // CPU time spent issuing the frame's GL calls
+        PhaseTime                 Finish{}; // waiting for the GPU to catch up with them
+        std::uint64_t             DrawCalls             = 0;
+        std::uint64_t             Dispatches            = 0;
+        std::uint64_t             StateChanges          = 0;
+        std::uint64_t             RedundantStateChanges = 0;
+        util::FrameTimeStatistics FrameTimes{};
+    };
+
+    // Creates the demo through demos::create_demo, plays a fixed input script over options.Frames frames and times each phase.
+    // Needs a current OpenGL context. Exceptions from the demo end up in DemoResult::Error.
+    [[nodiscard]] DemoResult run_demo(demos::Demos the_demo, const BenchOptions& options);
+
+    void write_json(std::ostream& output, const std::string& renderer, const std::string& version, const BenchOptions& options, std::span<const DemoResult> results);
+}
@@ -0,0 +1,90 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "HeadlessContext.hpp"
+
+#include "environment/Environment.hpp"
+#include "environment/OpenGL.hpp"
+#include "opengl/GL.hpp"
+#include <GL/glew.h>
+#include <SDL.h>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    template <typename... Messages>
+    [[noreturn]] void throw_error_message(Messages&&... more_messages)
+    {
+        std::ostringstream sout;
+        (sout << ... << more_messages);
+        std::cerr << sout.str() << '\n';
+        throw std::runtime_error{ sout.str() };
+    }
+}
+
+namespace bench
+{
+    HeadlessContext::HeadlessContext(int width, int height)
+    {
+        // an explicit SDL_VIDEODRIVER wins over the hint
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+        if (SDL_Init(SDL_INIT_VIDEO) < 0)
+        {
+            throw_error_message("Failed to init SDL for offscreen rendering: ", SDL_GetError());
+        }
+
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+        SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, true);
+        SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+        SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
+
+        ptr_window = SDL_CreateWindow("graphics_fun_bench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+        if (ptr_window == nullptr)
+        {
+            throw_error_message("Failed to create offscreen window: ", SDL_GetError());
+        }
+        if (gl_context = SDL_GL_CreateContext(ptr_window); gl_context == nullptr)
+        {
+            throw_error_message("Failed to create offscreen opengl context: ", SDL_GetError());
+        }
+        SDL_GL_MakeCurrent(ptr_window, gl_context);
+        // don't wait for a vsync that isn't there
+        SDL_GL_SetSwapInterval(0);
+
+        // glewInit() also loads the GLX extensions and fails without an X display,
+        // the context part is all we need and works for the EGL context SDL made
+        glewExperimental = GL_TRUE;
+        if (const auto result = glewContextInit(); GLEW_OK != result)
+        {
+            throw_error_message("Unable to initialize GLEW - error: ", glewGetErrorString(result));
+        }
+
+        renderer = reinterpret_cast<const char*>(GL::GetString(GL_RENDERER));
+        version  = reinterpret_cast<const char*>(GL::GetString(GL_VERSION));
+        environment::opengl::query_current_context();
+
+        environment::WindowWidth   = width;
+        environment::WindowHeight  = height;
+        environment::DisplayWidth  = width;
+        environment::DisplayHeight = height;
+        GL::Viewport(0, 0, width, height);
+    }
+
+    HeadlessContext::~HeadlessContext()
+    {
+        SDL_GL_DeleteContext(gl_context);
+        SDL_DestroyWindow(ptr_window);
+        SDL_Quit();
+    }
+
+    void HeadlessContext::Present() const
+    {
+        SDL_GL_SwapWindow(ptr_window);
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include <gsl/gsl>
+#include <string>
+
+struct SDL_Window;
+typedef void* SDL_GLContext;
+
+namespace bench
+{
+    // An OpenGL context without anything on screen, for machines that have no display and maybe no GPU.
+    // Uses SDL's offscreen video driver, which renders into an EGL pbuffer, so Mesa's llvmpipe works on a build farm.
+    // Set SDL_VIDEODRIVER to use a different driver, like x11 under Xvfb.
+    class [[nodiscard]] HeadlessContext
+    {
+    public:
+        HeadlessContext(int width, int height);
+        ~HeadlessContext();
+
+        HeadlessContext(const HeadlessContext&)                = delete;
+        HeadlessContext& operator=(const HeadlessContext&)     = delete;
+        HeadlessContext(HeadlessContext&&) noexcept            = delete;
+        HeadlessContext& operator=(HeadlessContext&&) noexcept = delete;
+
+        void Present() const;
+
+        [[nodiscard]] const std::string& GetRenderer() const noexcept
+        {
+            return renderer;
+        }
+
+        [[nodiscard]] const std::string& GetVersion() const noexcept
+        {
+            return version;
+        }
+
+    private:
+        gsl::owner<SDL_Window*>   ptr_window = nullptr;
+        gsl::owner<SDL_GLContext> gl_context = nullptr;
+        std::string               renderer;
+        std::string               version;
+    };
+}
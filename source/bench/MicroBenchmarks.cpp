@@ -0,0 +1,497 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "graphics/Color.hpp"
+#include "graphics/DrawCulling.hpp"
+#include "graphics/Frustum.hpp"
+#include "graphics/MathHelper.hpp"
+#include "graphics/Mesh.hpp"
+#include "graphics/TransformSystem.hpp"
+#include "graphics/curve/CurveGeneration.hpp"
+#include "graphics/noise/ValueNoise.hpp"
+#include "util/JobSystem.hpp"
+
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <glm/ext/matrix_clip_space.hpp> // perspective
+#include <glm/ext/matrix_transform.hpp>  // translate, scale, lookAt
+#include <glm/matrix.hpp>                // inverse, transpose
+#include <glm/trigonometric.hpp>         // radians
+#include <iostream>
+#include <span>
+#include <vector>
+
+// CPU only, nothing here needs an OpenGL context.
+// Before timing anything it checks that cull_draws, the CPU reference for D05's culling compute shader, keeps the same objects as
+// FrustumCuller, and exits with 1 if it doesn't.
+// For results that other runs can be compared against:
+//   graphics_fun_microbench --benchmark_out=micro.json --benchmark_out_format=json
+// and compare two files with Google Benchmark's tools/compare.py
+
+namespace
+{
+    using graphics::noise::PeriodDimension;
+    using graphics::noise::SmoothMethod;
+
+    constexpr int SamplesPerSide = 32; // every noise benchmark evaluates SamplesPerSide squared samples per iteration
+
+    // Arguments are plain integers, so smoothing and period go in as their enum values
+    const std::vector<std::int64_t> AllSmoothMethods = { static_cast<int>(SmoothMethod::Linear), static_cast<int>(SmoothMethod::Cosine), static_cast<int>(SmoothMethod::Smoothstep),
+                                                         static_cast<int>(SmoothMethod::Quintic) };
+    const std::vector<std::int64_t> SomePeriods      = { static_cast<int>(PeriodDimension::_16), static_cast<int>(PeriodDimension::_256), static_cast<int>(PeriodDimension::_4096) };
+
+    graphics::noise::ValueNoise<float> make_noise(const benchmark::State& state)
+    {
+        return graphics::noise::ValueNoise<float>(static_cast<PeriodDimension>(state.range(1)), static_cast<SmoothMethod>(state.range(0)));
+    }
+
+    // spread the samples over a few periods so every part of the table gets used
+    float sample_position(int index) noexcept
+    {
+        return static_cast<float>(index) * 0.37f;
+    }
+
+    void BM_ValueNoise1D(benchmark::State& state)
+    {
+        const auto noise = make_noise(state);
+        for (auto _ : state)
+        {
+            float sum = 0;
+            for (int x = 0; x < SamplesPerSide * SamplesPerSide; ++x)
+                sum += noise.Evaluate(sample_position(x));
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * SamplesPerSide * SamplesPerSide);
+    }
+
+    void BM_ValueNoise2D(benchmark::State& state)
+    {
+        const auto noise = make_noise(state);
+        for (auto _ : state)
+        {
+            float sum = 0;
+            for (int y = 0; y < SamplesPerSide; ++y)
+                for (int x = 0; x < SamplesPerSide; ++x)
+                    sum += noise.Evaluate(sample_position(x), sample_position(y));
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * SamplesPerSide * SamplesPerSide);
+    }
+
+    void BM_ValueNoise3D(benchmark::State& state)
+    {
+        const auto noise = make_noise(state);
+        for (auto _ : state)
+        {
+            float sum = 0;
+            for (int z = 0; z < SamplesPerSide / 4; ++z)
+                for (int y = 0; y < SamplesPerSide / 4; ++y)
+                    for (int x = 0; x < SamplesPerSide / 2; ++x)
+                        sum += noise.Evaluate(sample_position(x), sample_position(y), sample_position(z));
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * SamplesPerSide * SamplesPerSide);
+    }
+
+    BENCHMARK(BM_ValueNoise1D)->ArgsProduct({ AllSmoothMethods, SomePeriods })->ArgNames({ "smooth", "period" });
+    BENCHMARK(BM_ValueNoise2D)->ArgsProduct({ AllSmoothMethods, SomePeriods })->ArgNames({ "smooth", "period" });
+    BENCHMARK(BM_ValueNoise3D)->ArgsProduct({ AllSmoothMethods, SomePeriods })->ArgNames({ "smooth", "period" });
+
+    void BM_PermutationHash(benchmark::State& state)
+    {
+        const graphics::noise::PermutationHash hash(static_cast<PeriodDimension>(state.range(0)));
+        const auto                             dimensions = state.range(1);
+        for (auto _ : state)
+        {
+            int sum = 0;
+            for (int i = 0; i < SamplesPerSide * SamplesPerSide; ++i)
+            {
+                switch (dimensions)
+                {
+                    case 1: sum += hash(i); break;
+                    case 2: sum += hash(i, i >> 5); break;
+                    default: sum += hash(i, i >> 5, i >> 10); break;
+                }
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * SamplesPerSide * SamplesPerSide);
+    }
+
+    BENCHMARK(BM_PermutationHash)->ArgsProduct({ SomePeriods, { 1, 2, 3 } })->ArgNames({ "period", "dimensions" });
+
+    // Every generator that takes stacks and slices gets the same square grids
+    template <typename Generator>
+    void BM_CreateMesh(benchmark::State& state, Generator generator)
+    {
+        const auto resolution = static_cast<int>(state.range(0));
+        for (auto _ : state)
+        {
+            auto geometry = generator(resolution, resolution);
+            benchmark::DoNotOptimize(geometry.Vertices.data());
+            benchmark::DoNotOptimize(geometry.Indicies.data());
+        }
+        state.SetItemsProcessed(state.iterations() * resolution * resolution);
+    }
+
+    BENCHMARK_CAPTURE(BM_CreateMesh, plane, &graphics::create_plane)->Arg(16)->Arg(64)->Arg(256);
+    BENCHMARK_CAPTURE(BM_CreateMesh, cube, &graphics::create_cube)->Arg(16)->Arg(64)->Arg(256);
+    BENCHMARK_CAPTURE(BM_CreateMesh, sphere, &graphics::create_sphere)->Arg(16)->Arg(64)->Arg(256);
+    BENCHMARK_CAPTURE(BM_CreateMesh, torus, [](int stacks, int slices) { return graphics::create_torus(stacks, slices); })->Arg(16)->Arg(64)->Arg(256);
+    BENCHMARK_CAPTURE(BM_CreateMesh, cylinder, &graphics::create_cylinder)->Arg(16)->Arg(64)->Arg(256);
+    BENCHMARK_CAPTURE(BM_CreateMesh, cone, &graphics::create_cone)->Arg(16)->Arg(64)->Arg(256);
+    BENCHMARK_CAPTURE(BM_CreateMesh, trefoil, &graphics::create_trefoil)->Arg(16)->Arg(64)->Arg(256);
+
+    void BM_CreateCircle(benchmark::State& state)
+    {
+        const auto segments = static_cast<int>(state.range(0));
+        for (auto _ : state)
+        {
+            auto geometry = graphics::create_circle(segments);
+            benchmark::DoNotOptimize(geometry.Vertices.data());
+        }
+        state.SetItemsProcessed(state.iterations() * segments);
+    }
+
+    BENCHMARK(BM_CreateCircle)->Arg(64)->Arg(1024);
+
+    void BM_CreateLine(benchmark::State& state)
+    {
+        std::vector<glm::vec3> points(static_cast<std::size_t>(state.range(0)));
+        for (std::size_t i = 0; i < points.size(); ++i)
+            points[i] = glm::vec3(static_cast<float>(i), std::sin(static_cast<float>(i)), 0.0f);
+        for (auto _ : state)
+        {
+            auto geometry = graphics::create_line(points);
+            benchmark::DoNotOptimize(geometry.Vertices.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK(BM_CreateLine)->Arg(64)->Arg(4096);
+
+    void BM_BuildIndexBuffer(benchmark::State& state)
+    {
+        const auto resolution = static_cast<int>(state.range(0));
+        for (auto _ : state)
+        {
+            auto indices = graphics::build_index_buffer(resolution, resolution);
+            benchmark::DoNotOptimize(indices.data());
+        }
+        state.SetItemsProcessed(state.iterations() * resolution * resolution);
+    }
+
+    BENCHMARK(BM_BuildIndexBuffer)->Arg(16)->Arg(64)->Arg(256);
+
+    void BM_ConvertToLinesPattern(benchmark::State& state)
+    {
+        const auto resolution = static_cast<int>(state.range(0));
+        const auto triangles  = graphics::build_index_buffer(resolution, resolution);
+        for (auto _ : state)
+        {
+            auto lines = graphics::convert_to_lines_pattern(triangles);
+            benchmark::DoNotOptimize(lines.data());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(triangles.size() / 3));
+    }
+
+    BENCHMARK(BM_ConvertToLinesPattern)->Arg(16)->Arg(64)->Arg(256);
+
+    std::vector<glm::vec3> make_control_points(std::size_t count)
+    {
+        std::vector<glm::vec3> points(count);
+        for (std::size_t i = 0; i < count; ++i)
+            points[i] = glm::vec3(static_cast<float>(i), std::cos(static_cast<float>(i)), 0.0f);
+        return points;
+    }
+
+    constexpr std::size_t ControlPoints = 8;
+
+    void BM_GenerateHermiteCurve(benchmark::State& state)
+    {
+        const auto points   = make_control_points(ControlPoints);
+        const auto tangents = make_control_points(ControlPoints);
+        const auto segments = static_cast<int>(state.range(0));
+        for (auto _ : state)
+        {
+            auto curve = graphics::generateHermiteCurve(points, tangents, segments);
+            benchmark::DoNotOptimize(curve.data());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ControlPoints - 1) * (segments + 1));
+    }
+
+    BENCHMARK(BM_GenerateHermiteCurve)->Arg(16)->Arg(256);
+
+    void BM_GenerateCatmullRomSpline(benchmark::State& state)
+    {
+        const auto points   = make_control_points(ControlPoints);
+        const auto segments = static_cast<int>(state.range(0));
+        for (auto _ : state)
+        {
+            auto curve = graphics::generateCatmullRomSpline(points, segments);
+            benchmark::DoNotOptimize(curve.data());
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ControlPoints - 3) * (segments + 1));
+    }
+
+    BENCHMARK(BM_GenerateCatmullRomSpline)->Arg(16)->Arg(256);
+
+    // How much the job system itself costs: each job only does an atomic add
+    void BM_JobSystemDoJobs(benchmark::State& state)
+    {
+        static util::JobSystem jobs;
+        const auto             how_many = static_cast<int>(state.range(0));
+        std::atomic_int        total    = 0;
+        for (auto _ : state)
+        {
+            jobs.DoJobs(how_many, [&total](int i) { total.fetch_add(i, std::memory_order_relaxed); });
+            jobs.WaitUntilDone();
+        }
+        benchmark::DoNotOptimize(total.load());
+        state.SetItemsProcessed(state.iterations() * how_many);
+    }
+
+    BENCHMARK(BM_JobSystemDoJobs)->Arg(64)->Arg(1024)->Arg(16384)->UseRealTime();
+
+    void BM_Vec4ToRgba(benchmark::State& state)
+    {
+        std::vector<glm::vec4> colors(static_cast<std::size_t>(state.range(0)));
+        for (std::size_t i = 0; i < colors.size(); ++i)
+        {
+            const float t = static_cast<float>(i) / static_cast<float>(colors.size());
+            colors[i]     = glm::vec4(t, 1.0f - t, t * 2.0f - 0.5f, 1.0f);
+        }
+        std::vector<GLTexture::RGBA> texels(colors.size());
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < colors.size(); ++i)
+                texels[i] = graphics::vec4_to_rgba(colors[i]);
+            benchmark::DoNotOptimize(texels.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK(BM_Vec4ToRgba)->Arg(4096)->Arg(256 * 256);
+
+    // Spheres spread over twice the clip cube in every direction, about a sixth of them survive
+    void BM_FrustumCull(benchmark::State& state)
+    {
+        const auto              how_many = static_cast<std::size_t>(state.range(0));
+        graphics::FrustumCuller culler;
+        culler.Reserve(how_many);
+        for (std::size_t i = 0; i < how_many; ++i)
+        {
+            const float t = static_cast<float>(i);
+            culler.Add(graphics::BoundingSphere{ glm::vec3(std::sin(t) * 2.0f, std::cos(t * 0.7f) * 2.0f, std::sin(t * 1.3f) * 2.0f), 0.1f });
+        }
+        const auto                frustum = graphics::extract_frustum(glm::mat4(1.0f));
+        std::vector<std::uint8_t> visible;
+        for (auto _ : state)
+        {
+            const auto counts = culler.Cull(frustum, visible);
+            benchmark::DoNotOptimize(counts.Drawn);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK(BM_FrustumCull)->Arg(64)->Arg(4096)->Arg(65536);
+
+    // Every object spins a little each iteration, so all of them are dirty, against building each matrix by hand
+    void BM_TransformSystemUpdate(benchmark::State& state)
+    {
+        const auto                how_many = static_cast<std::size_t>(state.range(0));
+        graphics::TransformSystem transforms;
+        transforms.Reserve(how_many);
+        for (std::size_t i = 0; i < how_many; ++i)
+        {
+            const float t = static_cast<float>(i);
+            transforms.Add(glm::vec3(std::sin(t), std::cos(t), t * 0.01f), glm::vec3(t * 0.1f), glm::vec3(1.0f + 0.5f * std::sin(t * 0.3f)));
+        }
+        float spin = 0.0f;
+        for (auto _ : state)
+        {
+            spin += 0.001f;
+            for (std::size_t i = 0; i < how_many; ++i)
+            {
+                transforms.SetEulerAngles(i, glm::vec3(spin, spin * 0.5f, static_cast<float>(i) * 0.1f));
+            }
+            benchmark::DoNotOptimize(transforms.Update());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_TransformByHand(benchmark::State& state)
+    {
+        const auto             how_many = static_cast<std::size_t>(state.range(0));
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> scales;
+        std::vector<glm::mat4> models(how_many);
+        std::vector<glm::mat3> normals(how_many);
+        for (std::size_t i = 0; i < how_many; ++i)
+        {
+            const float t = static_cast<float>(i);
+            positions.emplace_back(std::sin(t), std::cos(t), t * 0.01f);
+            scales.emplace_back(1.0f + 0.5f * std::sin(t * 0.3f));
+        }
+        float spin = 0.0f;
+        for (auto _ : state)
+        {
+            spin += 0.001f;
+            for (std::size_t i = 0; i < how_many; ++i)
+            {
+                const glm::mat4 r = graphics::euler_angle_xyz_matrix(spin, spin * 0.5f, static_cast<float>(i) * 0.1f);
+                const glm::mat4 s = glm::scale(glm::mat4(1.0f), scales[i]);
+                const glm::mat4 t = glm::translate(glm::mat4(1.0f), positions[i]);
+                models[i]         = t * r * s;
+                normals[i]        = glm::transpose(glm::inverse(glm::mat3(models[i])));
+            }
+            benchmark::DoNotOptimize(models.data());
+            benchmark::DoNotOptimize(normals.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK(BM_TransformSystemUpdate)->Arg(64)->Arg(4096);
+    BENCHMARK(BM_TransformByHand)->Arg(64)->Arg(4096);
+
+    struct CullDrawsScene
+    {
+        std::vector<graphics::CullObject> Objects;
+        std::vector<glm::mat4>            ModelMatrices;
+        std::vector<graphics::Frustum>    Views;
+        std::vector<std::uint8_t>         ExpectedInClipCube; // only for the first BoundaryObjects
+        std::size_t                       BoundaryObjects = 0;
+    };
+
+    // The first view is the clip cube, the second a camera looking at it from the side.
+    // The first objects sit against each side of the cube, just inside, exactly touching and just outside it.
+    // Their radius and offsets are powers of two, so the touching ones are exactly on the plane. The rest are spread around like in BM_FrustumCull.
+    CullDrawsScene make_cull_draws_scene(std::size_t how_many)
+    {
+        CullDrawsScene scene;
+        scene.Views = { graphics::extract_frustum(glm::mat4(1.0f)),
+                        graphics::extract_frustum(glm::perspective(glm::radians(60.0f), 1.5f, 0.5f, 20.0f) * glm::lookAt(glm::vec3(3.0f, 2.0f, 6.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f))) };
+
+        constexpr float Radius    = 0.25f;
+        constexpr float Offsets[] = { -1.0f / 16.0f, 0.0f, 1.0f / 16.0f }; // inside, touching, outside
+        const auto      add       = [&](const glm::vec3& center, float radius, bool expected_inside)
+        {
+            const auto i = static_cast<std::uint32_t>(scene.Objects.size());
+            scene.Objects.push_back(graphics::CullObject{ glm::vec4(0.0f, 0.0f, 0.0f, radius), 36 + i, 3 * i, i % 2, 0 });
+            scene.ModelMatrices.push_back(glm::translate(glm::mat4(1.0f), center));
+            scene.ExpectedInClipCube.push_back(static_cast<std::uint8_t>(expected_inside));
+        };
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            for (const float side : { -1.0f, 1.0f })
+            {
+                for (const float offset : Offsets)
+                {
+                    glm::vec3 center(0.0f);
+                    center[axis] = side * (1.0f + Radius + offset);
+                    add(center, Radius, offset <= 0.0f);
+                }
+            }
+        }
+        scene.BoundaryObjects = scene.Objects.size();
+        while (scene.Objects.size() < how_many)
+        {
+            const float t = static_cast<float>(scene.Objects.size());
+            add(glm::vec3(std::sin(t) * 2.0f, std::cos(t * 0.7f) * 2.0f, std::sin(t * 1.3f) * 2.0f), 0.1f, false);
+        }
+        return scene;
+    }
+
+    bool cull_draws_matches_frustum_culler(std::size_t how_many, std::uint32_t view_mask)
+    {
+        const auto        scene        = make_cull_draws_scene(how_many);
+        const std::size_t object_count = scene.Objects.size();
+        std::vector<GLDrawElementsIndirectCommand> commands(2 * scene.Views.size() * object_count);
+        std::vector<std::uint32_t>                 counts(2 * scene.Views.size());
+        graphics::cull_draws(scene.Objects, scene.ModelMatrices, scene.Views, view_mask, commands, counts);
+
+        graphics::FrustumCuller culler;
+        for (std::size_t i = 0; i < object_count; ++i)
+        {
+            const auto& sphere = scene.Objects[i].Sphere;
+            culler.Add(graphics::transform_bounds(graphics::BoundingSphere{ glm::vec3(sphere), sphere.w }, scene.ModelMatrices[i]));
+        }
+
+        std::vector<std::uint8_t> visible;
+        for (std::size_t view = 0; view < scene.Views.size(); ++view)
+        {
+            culler.Cull(scene.Views[view], visible);
+            if (view == 0)
+            {
+                // both culls could agree on the wrong answer, so make sure the boundary is where it should be
+                for (std::size_t i = 0; i < scene.BoundaryObjects; ++i)
+                {
+                    if (visible[i] != scene.ExpectedInClipCube[i])
+                    {
+                        std::cerr << "FrustumCuller got object " << i << (visible[i] != 0 ? " that is just outside the clip cube" : " that is inside or touching the clip cube") << " wrong\n";
+                        return false;
+                    }
+                }
+            }
+            const bool is_in_mask = (view_mask & (1u << view)) != 0;
+            for (std::uint32_t double_sided = 0; double_sided < 2; ++double_sided)
+            {
+                std::vector<GLDrawElementsIndirectCommand> expected;
+                for (std::size_t i = 0; i < object_count; ++i)
+                {
+                    const auto& object = scene.Objects[i];
+                    if (is_in_mask && visible[i] != 0 && object.DoubleSided == double_sided)
+                        expected.push_back(GLDrawElementsIndirectCommand{ object.IndexCount, 1, object.FirstIndex, 0, static_cast<GLuint>(i) });
+                }
+                const std::size_t group = view * 2 + double_sided;
+                const auto        drawn = std::span(commands).subspan(group * object_count, counts[group]);
+                if (!graphics::same_draws(drawn, expected))
+                {
+                    std::cerr << "cull_draws and FrustumCuller disagree for view " << view << (double_sided != 0 ? ", double sided" : ", single sided") << ": " << drawn.size()
+                              << " draws against " << expected.size() << "\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void BM_CullDraws(benchmark::State& state)
+    {
+        const auto                                 scene = make_cull_draws_scene(static_cast<std::size_t>(state.range(0)));
+        std::vector<GLDrawElementsIndirectCommand> commands(2 * scene.Views.size() * scene.Objects.size());
+        std::vector<std::uint32_t>                 counts(2 * scene.Views.size());
+        for (auto _ : state)
+        {
+            graphics::cull_draws(scene.Objects, scene.ModelMatrices, scene.Views, 0b11, commands, counts);
+            benchmark::DoNotOptimize(counts.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK(BM_CullDraws)->Arg(64)->Arg(4096);
+}
+
+int main(int argc, char** argv)
+{
+    // every view, only the first, and a size that doesn't fill whole SSE groups of four
+    if (!cull_draws_matches_frustum_culler(256, 0b11) || !cull_draws_matches_frustum_culler(256, 0b01) || !cull_draws_matches_frustum_culler(61, 0b10))
+    {
+        return 1;
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "DemoBenchmark.hpp"
+#include "HeadlessContext.hpp"
+#include "util/Profiler.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    void print_usage()
+    {
+        std::cerr << "usage: graphics_fun_bench [--frames N] [--width W] [--height H] [--output results.json] [demo names...]\n"
+                     "runs every demo when no names are given, names are the ones graphics_fun takes on its command line\n";
+    }
+
+    bool parse_positive_int(std::string_view text, int& value)
+    {
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc{} && end == text.data() + text.size() && value > 0;
+    }
+}
+
+int main(int argc, char* argv[])
+try
+{
+    bench::BenchOptions       options;
+    std::string               output_path;
+    std::vector<demos::Demos> demos_to_run;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument  = argv[i];
+        const bool             has_value = i + 1 < argc;
+        if (argument == "--frames" && has_value && parse_positive_int(argv[i + 1], options.Frames))
+            ++i;
+        else if (argument == "--width" && has_value && parse_positive_int(argv[i + 1], options.Width))
+            ++i;
+        else if (argument == "--height" && has_value && parse_positive_int(argv[i + 1], options.Height))
+            ++i;
+        else if (argument == "--output" && has_value)
+            output_path = argv[++i];
+        else if (const auto demo = demos::string_to_demo(argument); demos::demo_to_string(demo) == argument)
+            demos_to_run.push_back(demo);
+        else
+        {
+            std::cerr << "Unknown argument " << argument << '\n';
+            print_usage();
+            return 1;
+        }
+    }
+    if (demos_to_run.empty())
+    {
+        for (auto demo = demos::Demos::HelloQuad; demo <= demos::Demos::CurvesNSplines; demo = static_cast<demos::Demos>(static_cast<int>(demo) + 1))
+            demos_to_run.push_back(demo);
+    }
+
+    // scopes would pile up with nobody ending the profiler's frames
+    util::get_profiler().SetEnabled(false);
+    const bench::HeadlessContext context(options.Width, options.Height);
+    std::cerr << "Running on " << context.GetRenderer() << ", " << context.GetVersion() << '\n';
+
+    std::vector<bench::DemoResult> results;
+    bool                           all_ran = true;
+    for (const auto demo : demos_to_run)
+    {
+        std::cerr << demos::demo_to_string(demo) << "...\n";
+        results.push_back(bench::run_demo(demo, options));
+        context.Present();
+        if (!results.back().Error.empty())
+        {
+            std::cerr << "  failed: " << results.back().Error << '\n';
+            all_ran = false;
+        }
+    }
+
+    if (output_path.empty())
+    {
+        bench::write_json(std::cout, context.GetRenderer(), context.GetVersion(), options, results);
+    }
+    else
+    {
+        std::ofstream ofs(output_path, std::ios::out | std::ios::trunc);
+        bench::write_json(ofs, context.GetRenderer(), context.GetVersion(), options, results);
+        if (!ofs)
+        {
+            std::cerr << "Failed to write " << output_path << '\n';
+            return 1;
+        }
+    }
+    return all_ran ? 0 : 1;
+}
+catch (const std::exception& e)
+{
+    std::cerr << e.what() << '\n';
+    return -1;
+}
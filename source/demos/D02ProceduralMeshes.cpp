@@ -8,6 +8,7 @@
 #include "D02ProceduralMeshes.hpp"
 
 #include "environment/Environment.hpp"
+#include "graphics/MathHelper.hpp"
 #include "opengl/GL.hpp"
 #include <glm/ext/matrix_clip_space.hpp> // perspective
 #include <glm/ext/matrix_transform.hpp>  // translate, rotate
@@ -61,6 +62,7 @@ namespace demos
 
         materials[Materials::Textured] = graphics::Material(&texturedShader, "Textured Objects Material");
         materials[Materials::Textured].SetTextures({ &uvTexture });
+        materials[Materials::Textured].SetFallbackShader(&fillShader); // flat shade until the textured shader is built
 
         materials[Materials::TexturedPlane]                 = materials[Materials::Textured];
         materials[Materials::TexturedPlane].Name            = "DoubleSided Textured Material";
@@ -114,6 +116,12 @@ namespace demos
             cone.Translation = glm::vec3(0.5f, -0.5f, 0);
             sceneObjects.push_back(cone);
         }
+
+        objectTransforms.Reserve(sceneObjects.size());
+        for (const auto& scene_object : sceneObjects)
+        {
+            objectTransforms.Add(scene_object.Translation, glm::vec3(0.0f), glm::vec3(0.35f));
+        }
     }
 
     void D02ProceduralMeshes::Update()
@@ -131,24 +139,31 @@ namespace demos
             material.SetMaterialUniform(Uniforms::Projection, ProjectionMatrix);
             material.SetMaterialUniform(Uniforms::ViewMatrix, ViewMatrix);
         }
+
+        const auto angle        = (autoRotate) ? glm::radians(static_cast<float>(environment::ElapsedTime) * 35.0f) : rotationAngle;
+        const auto euler_angles = graphics::euler_angles_xyz(glm::rotate(glm::mat4(1.0f), angle, glm::vec3{ 1, 1, 0 }));
+        for (size_t i = 0; i < objectTransforms.Size(); ++i)
+        {
+            objectTransforms.SetEulerAngles(i, euler_angles);
+        }
+        objectTransforms.Update();
+        cullSceneObjects();
     }
 
     void D02ProceduralMeshes::Draw() const
     {
         GL::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        const auto      angle = (autoRotate) ? glm::radians(static_cast<float>(environment::ElapsedTime) * 35.0f) : rotationAngle;
-        const glm::mat4 r     = glm::rotate(glm::mat4(1.0f), angle, glm::vec3{ 1, 1, 0 });
         if (showNormals)
         {
-            drawSceneObjects(r, meshesNormals);
+            drawSceneObjects(meshesNormals);
         }
         if (showWire)
         {
-            drawSceneObjects(r, meshesLines);
+            drawSceneObjects(meshesLines);
         }
         if (showTextured)
         {
-            drawSceneObjects(r, meshesTriangles);
+            drawSceneObjects(meshesTriangles);
         }
         graphics::DEFAULT_MATERIAL.ForceApplyAllSettings();
     }
@@ -215,6 +230,8 @@ namespace demos
         {
             ImGui::SliderAngle("Angle", &rotationAngle);
         }
+        ImGui::Checkbox("Frustum Culling", &frustumCulling);
+        ImGui::Text("Objects drawn %d, culled %d", cullCounts.Drawn, cullCounts.Culled);
     }
 
     void D02ProceduralMeshes::SetDisplaySize(int width, int height)
@@ -230,19 +247,38 @@ namespace demos
         ViewMatrix = glm::lookAt(eye_position, target_position, relative_up);
     }
 
-    void D02ProceduralMeshes::drawSceneObjects(const glm::mat4& r, const std::array<graphics::Mesh, ObjectModel::Count>& meshes) const
+    void D02ProceduralMeshes::cullSceneObjects()
     {
-        for (const auto& scene_object : sceneObjects)
+        frustumCuller.Clear();
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            frustumCuller.Add(graphics::transform_bounds(modelBounds[sceneObjects[i].Model], objectTransforms.GetModelMatrix(i)));
+        }
+        if (frustumCulling)
         {
-            const auto      t            = glm::translate(glm::mat4(1.0f), scene_object.Translation);
-            const auto      s            = glm::scale(glm::mat4(1.0f), glm::vec3(0.35f));
-            const glm::mat4 ModelMatrix  = t * r * s;
-            const auto&     mesh_to_draw = meshes[scene_object.Model];
+            cullCounts = frustumCuller.Cull(graphics::extract_frustum(ProjectionMatrix * ViewMatrix), visibleObjects);
+        }
+        else
+        {
+            visibleObjects.assign(sceneObjects.size(), 1);
+            cullCounts = graphics::CullCounts{ static_cast<int>(sceneObjects.size()), 0 };
+        }
+    }
+
+    void D02ProceduralMeshes::drawSceneObjects(const std::array<graphics::Mesh, ObjectModel::Count>& meshes) const
+    {
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            if (!visibleObjects[i])
+                continue;
+            const glm::mat4& ModelMatrix  = objectTransforms.GetModelMatrix(i);
+            const auto&      mesh_to_draw = meshes[sceneObjects[i].Model];
             for (const auto& sub_mesh : mesh_to_draw.SubMeshes)
             {
                 auto& material = *sub_mesh.Material;
                 material.SetMaterialUniform(Uniforms::ModelMatrix, ModelMatrix);
-                material.ForceApplyAllSettings();
+                if (!material.ForceApplyAllSettings())
+                    continue;
                 sub_mesh.VertexArrayObj.Use();
                 GLDrawIndexed(sub_mesh.VertexArrayObj);
             }
@@ -260,6 +296,13 @@ namespace demos
             graphics::create_cone(stacks, slices)
         };
 
+        constexpr float NormalLineLength = 0.1f; // how far the normal lines stick out of the surface
+        for (size_t i = 0; i < geometries.size(); ++i)
+        {
+            modelBounds[i] = geometries[i].Sphere;
+            modelBounds[i].Radius += NormalLineLength;
+        }
+
         buildTriangleMeshes(geometries);
         buildLineMeshes(geometries);
         buildNormalsMeshes(geometries);
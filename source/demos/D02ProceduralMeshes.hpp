@@ -10,7 +10,9 @@
 
 #include "IDemo.hpp"
 #include "assets/Reloader.hpp"
+#include "graphics/Frustum.hpp"
 #include "graphics/Mesh.hpp"
+#include "graphics/TransformSystem.hpp"
 #include "opengl/GLShader.hpp"
 #include "opengl/GLTexture.hpp"
 #include <array>
@@ -74,6 +76,7 @@ namespace demos
         std::array<graphics::Mesh, ObjectModel::Count>   meshesNormals;
         std::array<graphics::Material, Materials::Count> materials;
         std::vector<SceneObject>                         sceneObjects;
+        graphics::TransformSystem                        objectTransforms;
         glm::mat4                                        ProjectionMatrix;
         glm::mat4                                        ViewMatrix;
         glm::vec3                                        eyePosition{ 0.0f };
@@ -92,9 +95,16 @@ namespace demos
         bool              autoRotate          = true;
         float             rotationAngle       = 0;
 
+        std::array<graphics::BoundingSphere, ObjectModel::Count> modelBounds;
+        graphics::FrustumCuller                                  frustumCuller;
+        std::vector<std::uint8_t>                                visibleObjects;
+        graphics::CullCounts                                     cullCounts;
+        bool                                                     frustumCulling = true;
+
     private:
         void setViewMatrix(glm::vec3 target_position, float distance = 1.5f);
-        void drawSceneObjects(const glm::mat4& r, const std::array<graphics::Mesh, ObjectModel::Count>& meshes) const;
+        void cullSceneObjects();
+        void drawSceneObjects(const std::array<graphics::Mesh, ObjectModel::Count>& meshes) const;
         void buildMeshes();
         void buildTriangleMeshes(const std::array<const graphics::Geometry, ObjectModel::Count>& geometries);
         void buildLineMeshes(const std::array<const graphics::Geometry, ObjectModel::Count>& geometries);
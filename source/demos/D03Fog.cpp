@@ -8,7 +8,6 @@
 #include "D03Fog.hpp"
 
 #include "environment/Environment.hpp"
-#include "graphics/MathHelper.hpp"
 #include "opengl/GL.hpp"
 #include <glm/ext/matrix_clip_space.hpp> // perspective
 #include <glm/ext/matrix_transform.hpp>  // translate, rotate
@@ -75,10 +74,10 @@ namespace demos
         assetReloader.SetAndAutoReloadShader(shaders[FogStyle::Exponential], asset_paths::ExponentialFogShaderName, { asset_paths::ExponentialFogVertexPath, asset_paths::ExponentialFogFragmentPath });
         assetReloader.SetAndAutoReloadShader(shaders[FogStyle::FragCoordZ], asset_paths::FragCoordZFogShaderName, { asset_paths::FragCoordZFogVertexPath, asset_paths::FragCoordZFogFragmentPath });
 
-        assetReloader.SetAndAutoReloadTexture(textures[Materials::Crate], asset_paths::CrateTexturePath);
+        assetReloader.SetAndAutoReloadTexture(textures[Materials::Crate], asset_paths::CrateTexturePath, true, assets::TextureCompression::BC);
         textures[Materials::Crate].SetFiltering(GLTexture::Linear);
 
-        assetReloader.SetAndAutoReloadTexture(textures[Materials::PoolBall], asset_paths::PoolBallTexturePath);
+        assetReloader.SetAndAutoReloadTexture(textures[Materials::PoolBall], asset_paths::PoolBallTexturePath, true, assets::TextureCompression::BC);
         textures[Materials::Crate].SetFiltering(GLTexture::Linear);
 
         setMaterialsForShader(FogStyle::Linear);
@@ -88,6 +87,12 @@ namespace demos
         createLongLineSceneObjects();
 
         createCirclingSceneObjects();
+
+        objectTransforms.Reserve(sceneObjects.size());
+        for (const auto& scene_object : sceneObjects)
+        {
+            objectTransforms.Add(scene_object.Translation, scene_object.EulerAngles, glm::vec3(1.0f));
+        }
     }
 
     void D03Fog::Update()
@@ -98,10 +103,16 @@ namespace demos
         modelRotations.y += static_cast<float>(-0.7 * environment::DeltaTime);
 
 
-        for (auto& object : sceneObjects)
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
         {
+            auto& object = sceneObjects[i];
             object.Update();
+            objectTransforms.SetPosition(i, object.Translation);
+            objectTransforms.SetEulerAngles(i, object.EulerAngles);
         }
+        objectTransforms.Update();
+        cullSceneObjects();
+        queueSceneObjects();
 
         constexpr double FUDGE_FACTOR = 0.75;
         const auto       easing       = std::min(static_cast<float>(environment::DeltaTime * FUDGE_FACTOR), 1.0f);
@@ -140,22 +151,16 @@ namespace demos
     void D03Fog::Draw() const
     {
         GL::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        for (const auto& scene_object : sceneObjects)
-        {
-            const auto      t            = glm::translate(glm::mat4(1.0f), scene_object.Translation);
-            constexpr auto  s            = glm::mat4(1.0f);
-            const auto      r            = graphics::euler_angle_xyz_matrix(scene_object.EulerAngles.x, scene_object.EulerAngles.y, scene_object.EulerAngles.z);
-            const glm::mat4 ModelMatrix  = t * r * s;
-            const auto&     mesh_to_draw = meshesTriangles[scene_object.Model];
-            for (const auto& sub_mesh : mesh_to_draw.SubMeshes)
+        renderQueue.Execute(
+            0,
+            [this](const GLShader&, unsigned material)
             {
-                auto& material = *sub_mesh.Material;
-                material.SetMaterialUniform(Uniforms::ModelMatrix, ModelMatrix);
-                material.ForceApplyAllSettings();
-                sub_mesh.VertexArrayObj.Use();
-                GLDrawIndexed(sub_mesh.VertexArrayObj);
-            }
-        }
+                materials[material].ForceApplyAllSettings();
+            },
+            [](const GLShader& shader, const graphics::RenderQueue::Packet& packet)
+            {
+                shader.SendUniform(Uniforms::ModelMatrix, packet.ModelMatrix);
+            });
         graphics::DEFAULT_MATERIAL.ForceApplyAllSettings();
     }
 
@@ -206,6 +211,14 @@ namespace demos
                 break;
             default: break;
         }
+        ImGui::Checkbox("Frustum Culling", &frustumCulling);
+        ImGui::Text("Objects drawn %d, culled %d", cullCounts.Drawn, cullCounts.Culled);
+        bool sort_draws = renderQueue.IsSorting();
+        if (ImGui::Checkbox("Sort Draws", &sort_draws))
+        {
+            renderQueue.SetSorting(sort_draws);
+        }
+        ImGui::Text("State changes unsorted %u, sorted %u", renderQueue.GetUnsortedChanges().Total(), renderQueue.GetSortedChanges().Total());
     }
 
     void D03Fog::SetDisplaySize(int width, int height)
@@ -223,12 +236,61 @@ namespace demos
         materials[Materials::PoolBall].SetTextures({ &textures[Materials::PoolBall] });
     }
 
+    void D03Fog::cullSceneObjects()
+    {
+        frustumCuller.Clear();
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            frustumCuller.Add(graphics::transform_bounds(modelBounds[sceneObjects[i].Model], objectTransforms.GetModelMatrix(i)));
+        }
+        if (frustumCulling)
+        {
+            cullCounts = frustumCuller.Cull(graphics::extract_frustum(ProjectionMatrix * ViewMatrix), visibleObjects);
+        }
+        else
+        {
+            visibleObjects.assign(sceneObjects.size(), 1);
+            cullCounts = graphics::CullCounts{ static_cast<int>(sceneObjects.size()), 0 };
+        }
+    }
+
+    void D03Fog::queueSceneObjects()
+    {
+        renderQueue.Clear();
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            if (!visibleObjects[i])
+                continue;
+            const auto& scene_object = sceneObjects[i];
+            for (const auto& sub_mesh : meshesTriangles[scene_object.Model].SubMeshes)
+            {
+                const GLShader* shader = sub_mesh.Material->GetActiveShader();
+                if (shader == nullptr)
+                    continue;
+                graphics::RenderQueue::Packet packet;
+                packet.Shader      = shader;
+                packet.Mesh        = &sub_mesh.VertexArrayObj;
+                packet.Material    = static_cast<unsigned>(sub_mesh.Material - materials.data());
+                packet.Object      = static_cast<unsigned>(i);
+                packet.ModelMatrix = objectTransforms.GetModelMatrix(i);
+                packet.ViewDepth   = glm::length(scene_object.Translation - camera::EyePosition);
+                packet.Flags       = sub_mesh.Material->Culling.Enabled ? graphics::RenderQueue::None : graphics::RenderQueue::DoubleSided;
+                renderQueue.Submit(0, packet);
+            }
+        }
+        renderQueue.Sort();
+    }
+
     void D03Fog::buildMeshes()
     {
         const std::array<const graphics::Geometry, ObjectModel::Count> geometries = {
             graphics::create_cube(1, 1),
             graphics::create_sphere(40, 40)
         };
+        for (size_t i = 0; i < geometries.size(); ++i)
+        {
+            modelBounds[i] = geometries[i].Sphere;
+        }
 
         meshesTriangles[ObjectModel::Cube].Name = "Cube";
         meshesTriangles[ObjectModel::Cube].SubMeshes.clear();
@@ -9,7 +9,10 @@
 
 #include "IDemo.hpp"
 #include "assets/Reloader.hpp"
+#include "graphics/Frustum.hpp"
 #include "graphics/Mesh.hpp"
+#include "graphics/TransformSystem.hpp"
+#include "graphics/RenderQueue.hpp"
 #include "opengl/GLShader.hpp"
 #include "opengl/GLTexture.hpp"
 
@@ -75,6 +78,7 @@ namespace demos
         std::array<graphics::Material, Materials::Count> materials;
         GLTexture                                        textures[Materials::Count];
         std::vector<SceneObject>                         sceneObjects;
+        graphics::TransformSystem                        objectTransforms; // model matrices from each object's Translation and EulerAngles
         glm::mat4                                        ProjectionMatrix;
         glm::mat4                                        ViewMatrix;
 
@@ -100,8 +104,17 @@ namespace demos
         float                      fragCoordZFFarDistance         = FragCoordZFogMaxRange.y;
         float                      targetFragCoordZFogFarDistance = 0.9f;
 
+        std::array<graphics::BoundingSphere, ObjectModel::Count> modelBounds;
+        graphics::FrustumCuller                                  frustumCuller;
+        std::vector<std::uint8_t>                                visibleObjects;
+        graphics::CullCounts                                     cullCounts;
+        bool                                                     frustumCulling = true;
+        graphics::RenderQueue                                    renderQueue;
+
     private:
         void setMaterialsForShader(FogStyle::Type shaded_type);
+        void cullSceneObjects();
+        void queueSceneObjects();
         void buildMeshes();
         void createLongLineSceneObjects();
         void createCirclingSceneObjects();
@@ -419,7 +419,8 @@ void D04ToonShading::drawObject(const glm::mat4& t, const glm::mat4& r, ObjectMo
             auto& m = *sub_mesh.Material;
             m.SetMaterialUniform(Uniforms::ModelMatrix, ModelMatrix);
             m.SetMaterialUniform(Uniforms::NormalMatrix, NormalMatrix);
-            m.ForceApplyAllSettings();
+            if (!m.ForceApplyAllSettings())
+                continue;
             sub_mesh.VertexArrayObj.Use();
             GLDrawIndexed(sub_mesh.VertexArrayObj);
         }
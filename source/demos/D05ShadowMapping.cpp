@@ -11,14 +11,17 @@
 #include "environment/Environment.hpp"
 #include "environment/Input.hpp"
 #include "environment/OpenGL.hpp"
-#include "graphics/MathHelper.hpp"
 #include "opengl/GL.hpp"
+#include "opengl/GLGpuProfiler.hpp"
 #include "util/Random.hpp"
 
 #include <SDL.h>
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cmath>
 #include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp> // lookAt
 #include <imgui.h>
 #include <iostream>
 #include <span>
@@ -42,6 +45,17 @@ namespace
         const auto WriteDepthVertexPath   = "D05ShadowMapping/fill_3d.vert";
         const auto WriteDepthFragmentPath = "D05ShadowMapping/write_depth.frag";
         const auto WriteDepthShaderName   = "Write Depth Map Shader";
+
+        const auto ShadowIndirectVertexPath   = "D05ShadowMapping/shadows_mdi.vert";
+        const auto ShadowIndirectFragmentPath = "D05ShadowMapping/shadows_mdi.frag";
+        const auto ShadowIndirectShaderName   = "Shadow Mapping Multi-Draw Indirect Shader";
+
+        const auto WriteDepthIndirectVertexPath   = "D05ShadowMapping/fill_3d_mdi.vert";
+        const auto WriteDepthIndirectFragmentPath = "D05ShadowMapping/write_depth_mdi.frag";
+        const auto WriteDepthIndirectShaderName   = "Write Depth Map Multi-Draw Indirect Shader";
+
+        const auto CullDrawsComputePath = "D05ShadowMapping/cull_draws.comp";
+        const auto CullDrawsShaderName  = "Cull Draws Compute Shader";
     }
 
     using namespace std::string_literals;
@@ -49,6 +63,9 @@ namespace
     namespace Uniforms
     {
         const auto Ambient             = "uAmbient"s;
+        const auto CascadeCount        = "uCascadeCount"s;
+        const auto CascadeFarDistances = "uCascadeFarDistances"s;
+        const auto CascadeMatrices     = std::array{ "uCascadeMatrices[0]"s, "uCascadeMatrices[1]"s, "uCascadeMatrices[2]"s, "uCascadeMatrices[3]"s };
         const auto Diffuse             = "uDiffuse"s;
         const auto DoShadowBehindLight = "uDoShadowBehindLight";
         const auto FarDistance         = "uFarDistance";
@@ -58,11 +75,14 @@ namespace
         const auto ModelMatrix         = "uModelMatrix"s;
         const auto NearDistance        = "uNearDistance";
         const auto NormalMatrix        = "uNormalMatrix"s;
+        const auto ObjectCount         = "uObjectCount"s;
         const auto Projection          = "uProjection"s;
         const auto ShadowMap           = "uShadowMap"s;
         const auto ShadowMatrix        = "uShadowMatrix"s;
         const auto Shininess           = "uShininess"s;
+        const auto ShowCascades        = "uShowCascades"s;
         const auto SpecularColor       = "uSpecularColor"s;
+        const auto ViewMask            = "uViewMask"s;
         const auto ViewMatrix          = "uViewMatrix"s;
     }
 
@@ -84,6 +104,39 @@ namespace
         constexpr float NearDistance = 0.5f;
         constexpr float FarDistance  = 150.0f;
     }
+
+    constexpr auto      shadow_bias_column_0 = glm::vec4(0.5f, 0.0f, 0.0f, 0.0f);
+    constexpr auto      shadow_bias_column_1 = glm::vec4(0.0f, 0.5f, 0.0f, 0.0f);
+    constexpr auto      shadow_bias_column_2 = glm::vec4(0.0f, 0.0f, 0.5f, 0.0f);
+    constexpr auto      shadow_bias_column_3 = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
+    constexpr glm::mat4 ShadowBias{ shadow_bias_column_0, shadow_bias_column_1, shadow_bias_column_2, shadow_bias_column_3 };
+
+    // Cascades share one shadow map: one square for a single cascade, two side by side for two, a 2x2 grid for three or four
+    [[nodiscard]] constexpr int atlas_columns(int cascade_count) noexcept
+    {
+        return (cascade_count > 1) ? 2 : 1;
+    }
+
+    [[nodiscard]] constexpr int atlas_rows(int cascade_count) noexcept
+    {
+        return (cascade_count > 2) ? 2 : 1;
+    }
+
+    [[nodiscard]] glm::vec3 unproject(const glm::mat4& clip_to_world, float x, float y, float z)
+    {
+        const glm::vec4 p = clip_to_world * glm::vec4(x, y, z, 1.0f);
+        return glm::vec3(p) / p.w;
+    }
+
+#if !defined(OPENGL_ES3_ONLY)
+    // Waits for the GPU to be done with the buffer, only for checking its results
+    void read_back(const GLVertexBuffer& buffer, std::span<std::byte> destination)
+    {
+        GL::BindBuffer(GL_COPY_READ_BUFFER, buffer.GetHandle());
+        GL::GetBufferSubData(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(destination.size()), destination.data());
+        GL::BindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+#endif
 }
 
 namespace demos
@@ -94,9 +147,25 @@ namespace demos
         assetReloader.SetAndAutoReloadShader(shaders[Shaders::Fill], asset_paths::FillShaderName, { asset_paths::FillVertexPath, asset_paths::FillFragmentPath });
         assetReloader.SetAndAutoReloadShader(shaders[Shaders::ViewDepth], asset_paths::ViewDepthShaderName, { asset_paths::ViewDepthVertexPath, asset_paths::ViewDepthFragmentPath });
         assetReloader.SetAndAutoReloadShader(shaders[Shaders::WriteDepth], asset_paths::WriteDepthShaderName, { asset_paths::WriteDepthVertexPath, asset_paths::WriteDepthFragmentPath });
+        IF_CAN_DO_OPENGL(4, 3)
+        {
+            assetReloader.SetAndAutoReloadShader(shaders[Shaders::ShadowIndirect], asset_paths::ShadowIndirectShaderName,
+                                                 { asset_paths::ShadowIndirectVertexPath, asset_paths::ShadowIndirectFragmentPath });
+            assetReloader.SetAndAutoReloadShader(shaders[Shaders::WriteDepthIndirect], asset_paths::WriteDepthIndirectShaderName,
+                                                 { asset_paths::WriteDepthIndirectVertexPath, asset_paths::WriteDepthIndirectFragmentPath });
+            assetReloader.SetAndAutoReloadShader(shaders[Shaders::CullDraws], asset_paths::CullDrawsShaderName, { asset_paths::CullDrawsComputePath });
+            canMultiDrawIndirect = true;
+            multiDrawIndirect    = true;
+            gpuCulling           = true;
+        }
+        IF_CAN_DO_OPENGL(4, 6)
+        {
+            canDrawIndirectCount = true;
+        }
 
         buildMeshes();
         buildScene();
+        setupIndirectDraws();
         setupShadowFrameBuffer();
 
         const float aspect             = static_cast<float>(environment::DisplayWidth) / static_cast<float>(environment::DisplayHeight);
@@ -120,6 +189,10 @@ namespace demos
         assetReloader.Update();
         auto& the_camera = (cameraMode == CameraMode::View) ? camera : lightCamera;
         updateSpectatorCamera(the_camera);
+        // the shaders build in the background, using one before then would wait on it
+        scenePassesReady = sceneShadersAreReady();
+        if (!scenePassesReady)
+            return;
         const auto ViewMatrix = the_camera.ViewMatrix();
 
 
@@ -129,30 +202,97 @@ namespace demos
 
         const auto& Projection = (cameraMode == CameraMode::View) ? projectionMatrix : lightProjectionMatrix;
 
-        constexpr auto      shadow_bias_column_0 = glm::vec4(0.5f, 0.0f, 0.0f, 0.0f);
-        constexpr auto      shadow_bias_column_1 = glm::vec4(0.0f, 0.5f, 0.0f, 0.0f);
-        constexpr auto      shadow_bias_column_2 = glm::vec4(0.0f, 0.0f, 0.5f, 0.0f);
-        constexpr auto      shadow_bias_column_3 = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
-        constexpr glm::mat4 ShadowBias{ shadow_bias_column_0, shadow_bias_column_1, shadow_bias_column_2, shadow_bias_column_3 };
-        const auto          ShadowMatrix = ShadowBias * lightProjectionMatrix * LightViewMatrix;
+        const auto ShadowMatrix = ShadowBias * lightProjectionMatrix * LightViewMatrix;
 
         const auto light_position_viewspace = glm::vec3(ViewMatrix * glm::vec4(lightCamera.Eye, 1.0f));
 
-        shaders[Shaders::Shadow].Use();
-        shaders[Shaders::Shadow].SendUniform(Uniforms::DoShadowBehindLight, DoShadowBehindLight);
-        shaders[Shaders::Shadow].SendUniform(Uniforms::FogColor, FogColor);
-        shaders[Shaders::Shadow].SendUniform(Uniforms::FogDensity, fogDensity);
-        shaders[Shaders::Shadow].SendUniform(Uniforms::LightPosition, light_position_viewspace);
-        shaders[Shaders::Shadow].SendUniform(Uniforms::Projection, Projection);
-        shaders[Shaders::Shadow].SendUniform(Uniforms::ShadowMap, 0);
-        shaders[Shaders::Shadow].SendUniform(Uniforms::ShadowMatrix, ShadowMatrix);
-        shaders[Shaders::Shadow].SendUniform(Uniforms::ViewMatrix, ViewMatrix);
+        const auto& shadow_shader = shaders[multiDrawIndirect ? Shaders::ShadowIndirect : Shaders::Shadow];
+        shadow_shader.Use();
+        shadow_shader.SendUniform(Uniforms::DoShadowBehindLight, DoShadowBehindLight);
+        shadow_shader.SendUniform(Uniforms::FogColor, FogColor);
+        shadow_shader.SendUniform(Uniforms::FogDensity, fogDensity);
+        shadow_shader.SendUniform(Uniforms::LightPosition, light_position_viewspace);
+        shadow_shader.SendUniform(Uniforms::Projection, Projection);
+        shadow_shader.SendUniform(Uniforms::ShadowMap, 0);
+        shadow_shader.SendUniform(Uniforms::ShadowMatrix, ShadowMatrix);
+        shadow_shader.SendUniform(Uniforms::ViewMatrix, ViewMatrix);
+
+        if (shadowMode == ShadowMode::Cascaded)
+        {
+            const bool  is_view_camera = cameraMode == CameraMode::View;
+            const float near_distance  = is_view_camera ? camera::NearDistance : lightNear;
+            const float far_distance   = is_view_camera ? camera::FarDistance : lightFar;
+            updateCascades(ViewMatrix, Projection, near_distance, far_distance);
+
+            glm::vec4 far_distances{ 0.0f };
+            for (int i = 0; i < cascadeCount; ++i)
+            {
+                far_distances[i] = cascades[static_cast<size_t>(i)].SplitFar;
+                shadow_shader.SendUniform(Uniforms::CascadeMatrices[static_cast<size_t>(i)], cascades[static_cast<size_t>(i)].ShadowMatrix);
+            }
+            shadow_shader.SendUniform(Uniforms::CascadeCount, cascadeCount);
+            shadow_shader.SendUniform(Uniforms::CascadeFarDistances, far_distances);
+        }
+        else
+        {
+            shadow_shader.SendUniform(Uniforms::CascadeCount, 0);
+        }
+        shadow_shader.SendUniform(Uniforms::ShowCascades, showCascades);
+
+        const bool culls_on_gpu = multiDrawIndirect && gpuCulling;
+        if (!culls_on_gpu)
+            cullSceneObjects(Projection * ViewMatrix, lightProjectionMatrix * LightViewMatrix);
+        updateShadowCache();
+        if (culls_on_gpu)
+            queueGpuCulling(Projection * ViewMatrix, lightProjectionMatrix * LightViewMatrix);
+        else if (multiDrawIndirect)
+            queueIndirectDraws();
+        else
+            queueSceneObjects();
+    }
+
+    void D05ShadowMapping::Simulate(const SimulationStep& step)
+    {
+        if (!simulationAnimate)
+            return;
+        auto&       back_transforms = objectTransforms[1 - frontTransforms];
+        const float seconds         = static_cast<float>(step.Seconds);
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            const auto& scene_object = sceneObjects[i];
+            auto&       angles       = simulatedEulerAngles[i];
+            angles += scene_object.Spin * seconds;
+            back_transforms.SetEulerAngles(i, angles);
+        }
+        back_transforms.Update();
+        hasNewTransforms = true;
+    }
 
+    void D05ShadowMapping::PublishSimulation()
+    {
+        if (hasNewTransforms)
+        {
+            frontTransforms  = 1 - frontTransforms;
+            hasNewTransforms = false;
+            ++transformsVersion;
+        }
+        simulationAnimate = animateObjects;
     }
 
     void D05ShadowMapping::Draw() const
     {
-        renderToDepthBuffer();
+        if (!scenePassesReady)
+        {
+            GL::ClearColor(FogColor.r, FogColor.g, FogColor.b, 1.0f);
+            GL::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            return;
+        }
+        if (multiDrawIndirect && gpuCulling)
+            cullOnGpu();
+        if (shadowMode == ShadowMode::Cascaded)
+            renderToCascades();
+        else if (shadowMapNeedsRender)
+            renderToDepthBuffer();
         renderToScreen();
         drawLightFrustum();
         drawDepthTexture();
@@ -163,6 +303,7 @@ namespace demos
     {
         ImGui::Text("Press and hold any mouse button to look around.\nW,A,S,D,Q,E to move around");
         ImGui::Checkbox("Draw Depth map", &shouldDrawDepthTexture);
+        ImGui::Checkbox("Animate Objects", &animateObjects);
         int currentCameraIndex = static_cast<int>(cameraMode);
         if (ImGui::Combo("Camera Mode", &currentCameraIndex, "View\0Light\0\0"))
         {
@@ -202,6 +343,7 @@ namespace demos
         {
             depthBitSize = to_enum(current_bit_depth);
             setupShadowFrameBuffer();
+            setupCascadeFrameBuffer();
         }
         static const auto texture_sizes_info = []
         {
@@ -229,7 +371,99 @@ namespace demos
                 setupShadowFrameBuffer();
             }
         }
+        int current_shadow_mode = static_cast<int>(shadowMode);
+        if (ImGui::Combo("Shadow Mode", &current_shadow_mode, "Single Map\0Cascaded\0\0"))
+        {
+            shadowMode = static_cast<ShadowMode>(current_shadow_mode);
+            setupCascadeFrameBuffer();
+        }
+        if (shadowMode == ShadowMode::Cascaded)
+        {
+            if (ImGui::SliderInt("Cascades", &cascadeCount, 2, MaxCascades))
+            {
+                setupCascadeFrameBuffer();
+            }
+            // the atlas is two cascades wide, so a cascade gets at most half the largest texture
+            static const auto cascade_sizes_info = []
+            {
+                std::vector<int> sizes;
+                std::string      names;
+                int              size = environment::opengl::MaxTextureSize / 2;
+                while (size >= 64)
+                {
+                    sizes.push_back(size);
+                    names += std::to_string(size);
+                    names += '\0';
+                    size >>= 1;
+                }
+                names += '\0';
+                return std::make_tuple(sizes, names);
+            }();
+            const auto& [cascade_sizes, cascade_sizes_string] = cascade_sizes_info;
+            const auto size_itr            = std::find(std::begin(cascade_sizes), std::end(cascade_sizes), cascadeResolution);
+            int        resolution_location = (size_itr != std::end(cascade_sizes)) ? static_cast<int>(std::distance(std::begin(cascade_sizes), size_itr)) : 0;
+            if (!cascade_sizes.empty() && ImGui::Combo("Cascade Dimensions", &resolution_location, cascade_sizes_string.c_str()))
+            {
+                cascadeResolution = cascade_sizes[static_cast<size_t>(resolution_location)];
+                setupCascadeFrameBuffer();
+            }
+            ImGui::SliderFloat("Shadow Distance", &shadowDistance, 1.0f, camera::FarDistance);
+            ImGui::SliderFloat("Split Lambda", &cascadeSplitLambda, 0.0f, 1.0f);
+            ImGui::Checkbox("Show Cascades", &showCascades);
+            ImGui::Text("Single map %.1f texels per unit", static_cast<double>(singleMapTexelsPerUnit));
+            int cascade_draws = 0;
+            for (int i = 0; i < cascadeCount; ++i)
+            {
+                const auto& cascade = cascades[static_cast<size_t>(i)];
+                const auto& counts  = cascadeCullCounts[static_cast<size_t>(i)];
+                ImGui::Text("Cascade %d to %.1f: %.1f texels per unit, drawn %d, culled %d", i, static_cast<double>(cascade.SplitFar), static_cast<double>(cascade.TexelsPerUnit), counts.Drawn,
+                            counts.Culled);
+                cascade_draws += counts.Drawn;
+            }
+            ImGui::Text("Cascade draws %d (a single map would draw %d)", cascade_draws, lightCullCounts.Drawn);
+        }
+        ImGui::Checkbox("Cache Shadow Maps", &cacheShadowMaps);
+        ImGui::Text("Shadow passes rendered %llu, skipped %llu", shadowPassesRendered, shadowPassesSkipped);
         ImGui::Checkbox("Draw Light Frustum", &shouldDrawLightFrustum);
+        ImGui::Checkbox("Frustum Culling", &frustumCulling);
+        if (canMultiDrawIndirect)
+            ImGui::Checkbox("Multi-Draw Indirect", &multiDrawIndirect);
+        else
+            ImGui::Text("Multi-Draw Indirect needs OpenGL 4.3");
+        if (multiDrawIndirect)
+            ImGui::Checkbox("Cull on the GPU", &gpuCulling);
+        if (multiDrawIndirect && gpuCulling)
+        {
+            ImGui::Text("Culled by cull_draws.comp in %d draw calls", indirectDrawCalls);
+            if (ImGui::Checkbox("Compare with the CPU", &checkGpuCulling))
+            {
+                gpuCullingChecks     = 0;
+                gpuCullingMismatches = 0;
+            }
+            if (checkGpuCulling)
+                ImGui::Text("Frames checked %llu, groups that differ %llu", gpuCullingChecks, gpuCullingMismatches);
+            return;
+        }
+        ImGui::Text("Camera pass drawn %d, culled %d", cameraCullCounts.Drawn, cameraCullCounts.Culled);
+        if (shadowMode == ShadowMode::Single)
+            ImGui::Text("Shadow pass drawn %d, culled %d", lightCullCounts.Drawn, lightCullCounts.Culled);
+        if (multiDrawIndirect)
+        {
+            ImGui::Text("Indirect commands %d in %d draw calls", static_cast<int>(indirectCommands.size()), indirectDrawCalls);
+        }
+        else
+        {
+            bool sort_draws = renderQueue.IsSorting();
+            if (ImGui::Checkbox("Sort Draws", &sort_draws))
+            {
+                renderQueue.SetSorting(sort_draws);
+            }
+            const auto& unsorted = renderQueue.GetUnsortedChanges();
+            const auto& sorted   = renderQueue.GetSortedChanges();
+            ImGui::Text("State changes unsorted %u, sorted %u", unsorted.Total(), sorted.Total());
+            ImGui::Text("  shaders %u/%u  materials %u/%u  meshes %u/%u  culling %u/%u", unsorted.Shaders, sorted.Shaders, unsorted.Materials, sorted.Materials, unsorted.Meshes, sorted.Meshes,
+                        unsorted.Culling, sorted.Culling);
+        }
     }
 
     void D05ShadowMapping::SetDisplaySize([[maybe_unused]] int width, [[maybe_unused]] int height)
@@ -241,11 +475,13 @@ namespace demos
 
     void D05ShadowMapping::renderToDepthBuffer() const
     {
-        shaders[Shaders::WriteDepth].Use();
-        shaders[Shaders::WriteDepth].SendUniform(Uniforms::Projection,   lightProjectionMatrix);
-        shaders[Shaders::WriteDepth].SendUniform(Uniforms::ViewMatrix,   lightCamera.ViewMatrix());
-        shaders[Shaders::WriteDepth].SendUniform(Uniforms::NearDistance, lightNear);
-        shaders[Shaders::WriteDepth].SendUniform(Uniforms::FarDistance,  lightFar);
+        const GLProfileScope profile_scope("renderToDepthBuffer");
+        const auto&          depth_shader = shaders[multiDrawIndirect ? Shaders::WriteDepthIndirect : Shaders::WriteDepth];
+        depth_shader.Use();
+        depth_shader.SendUniform(Uniforms::Projection,   lightProjectionMatrix);
+        depth_shader.SendUniform(Uniforms::ViewMatrix,   lightCamera.ViewMatrix());
+        depth_shader.SendUniform(Uniforms::NearDistance, lightNear);
+        depth_shader.SendUniform(Uniforms::FarDistance,  lightFar);
 
         GL::ClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         shadowFrameBuffer.Use(true);
@@ -261,7 +497,8 @@ namespace demos
         GL::PolygonOffset(glPolygonOffset_factor, glPolygonOffset_units);
 
         const auto culling = drawBackFacesForRecordDepthPass ? GL_FRONT : GL_BACK;
-        drawSceneObjects(shaders[Shaders::WriteDepth], static_cast<unsigned int>(culling));
+        GL::CullFace(static_cast<unsigned int>(culling));
+        drawSceneObjects(RenderPass::Shadow);
         GL::CullFace(GL_BACK);
         
         shadowFrameBuffer.Use(false);
@@ -272,19 +509,69 @@ namespace demos
         
     }
 
+    void D05ShadowMapping::renderToCascades() const
+    {
+        if (std::none_of(std::begin(cascadeNeedsRender), std::begin(cascadeNeedsRender) + cascadeCount, [](bool needs_render) { return needs_render; }))
+            return;
+        const GLProfileScope profile_scope("renderToCascades");
+        const auto&          depth_shader = shaders[multiDrawIndirect ? Shaders::WriteDepthIndirect : Shaders::WriteDepth];
+        depth_shader.Use();
+
+        GL::ClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        cascadeFrameBuffer.Use(true);
+
+        GL::Enable(GL_CULL_FACE);
+        GL::Enable(GL_DEPTH_TEST);
+        GL::DepthMask(GL_TRUE);
+        GL::Enable(GL_POLYGON_OFFSET_FILL);
+        GL::PolygonOffset(glPolygonOffset_factor, glPolygonOffset_units);
+
+        const auto culling = drawBackFacesForRecordDepthPass ? GL_FRONT : GL_BACK;
+        GL::CullFace(static_cast<unsigned int>(culling));
+        for (int i = 0; i < cascadeCount; ++i)
+        {
+            if (!cascadeNeedsRender[static_cast<size_t>(i)])
+                continue;
+            const auto& cascade = cascades[static_cast<size_t>(i)];
+            // only wipe this cascade's square, the others keep what they cached
+            GL::Enable(GL_SCISSOR_TEST);
+            GL::Scissor(cascade.Viewport.x, cascade.Viewport.y, cascade.Viewport.width, cascade.Viewport.height);
+            GL::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            GL::Disable(GL_SCISSOR_TEST);
+            GL::Viewport(cascade.Viewport.x, cascade.Viewport.y, cascade.Viewport.width, cascade.Viewport.height);
+            depth_shader.SendUniform(Uniforms::Projection,   cascade.Projection);
+            depth_shader.SendUniform(Uniforms::ViewMatrix,   cascade.ViewMatrix);
+            depth_shader.SendUniform(Uniforms::NearDistance, cascade.LightNear);
+            depth_shader.SendUniform(Uniforms::FarDistance,  cascade.LightFar);
+            drawSceneObjects(static_cast<RenderPass::Type>(RenderPass::Cascade0 + static_cast<unsigned>(i)));
+        }
+        GL::CullFace(GL_BACK);
+
+        cascadeFrameBuffer.Use(false);
+
+        GL::Disable(GL_POLYGON_OFFSET_FILL);
+        GL::Viewport(viewport.x, viewport.y, viewport.width, viewport.height);
+        GL::ClearColor(FogColor.r, FogColor.g, FogColor.b, 1.0f);
+    }
+
     void D05ShadowMapping::renderToScreen() const
     {
+        const GLProfileScope profile_scope("renderToScreen");
         GL::ClearColor(FogColor.r, FogColor.g, FogColor.b, 1.0f);
         GL::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         GL::Enable(GL_DEPTH_TEST);
         GL::DepthMask(GL_TRUE);
-        shadowFrameBuffer.DepthTexture().UseForSlot(0);
-        drawSceneObjects(shaders[Shaders::Shadow], GL_BACK);
+        const auto& shadow_map = (shadowMode == ShadowMode::Cascaded) ? cascadeFrameBuffer : shadowFrameBuffer;
+        shadow_map.DepthTexture().UseForSlot(0);
+        GL::CullFace(GL_BACK);
+        if (multiDrawIndirect)
+            shaders[Shaders::ShadowIndirect].Use();
+        drawSceneObjects(RenderPass::Screen);
     }
 
     void D05ShadowMapping::drawLightFrustum() const
     {
-        if (shouldDrawLightFrustum && cameraMode != CameraMode::Light)
+        if (shouldDrawLightFrustum && cameraMode != CameraMode::Light && shaders[Shaders::Fill].IsReady())
         {
 
             shaders[Shaders::Fill].Use(true);
@@ -305,18 +592,29 @@ namespace demos
             
             ndcCube.VertexArrayObj.Use();
             GLDrawIndexed(ndcCube.VertexArrayObj);
+
+            if (shadowMode == ShadowMode::Cascaded)
+            {
+                for (int i = 0; i < cascadeCount; ++i)
+                {
+                    const auto& cascade = cascades[static_cast<size_t>(i)];
+                    shaders[Shaders::Fill].SendUniform(Uniforms::ModelMatrix, glm::inverse(cascade.Projection * cascade.ViewMatrix));
+                    GLDrawIndexed(ndcCube.VertexArrayObj);
+                }
+            }
         }
     }
 
     void D05ShadowMapping::drawDepthTexture() const
     {
-        if (shouldDrawDepthTexture)
+        if (shouldDrawDepthTexture && shaders[Shaders::ViewDepth].IsReady())
         {
             GL::Disable(GL_DEPTH_TEST);
             GL::Disable(GL_CULL_FACE);
             shaders[Shaders::ViewDepth].Use(true);
             shaders[Shaders::ViewDepth].SendUniform(Uniforms::ShadowMap, 0);
-            shadowFrameBuffer.ColorTexture().UseForSlot(0);
+            const auto& shadow_map = (shadowMode == ShadowMode::Cascaded) ? cascadeFrameBuffer : shadowFrameBuffer;
+            shadow_map.ColorTexture().UseForSlot(0);
             ndcQuad.VertexArrayObj.Use(true);
             GLDrawIndexed(ndcQuad.VertexArrayObj);
             GL::Enable(GL_DEPTH_TEST);
@@ -325,39 +623,450 @@ namespace demos
         }
     }
 
-    void D05ShadowMapping::drawSceneObjects(const GLShader& shader, GLenum culling) const
+    void D05ShadowMapping::updateCascades(const glm::mat4& view_matrix, const glm::mat4& projection, float near_distance, float far_distance)
     {
-        auto& the_camera = (cameraMode == CameraMode::View) ? camera : lightCamera;
-        const auto ViewMatrix = glm::mat3(the_camera.ViewMatrix());
-        shader.Use();
-        for (const auto& scene_object : sceneObjects)
+        // Split the view range between the uniform and logarithmic distributions, then fit a light frustum tightly around
+        // the bounding sphere of each slice. The light is a spot light, so each cascade is a narrow perspective frustum
+        // from the light's position that looks at its slice. Using a sphere keeps the fit from changing as the camera turns.
+        const float     last_far      = std::min(far_distance, near_distance + shadowDistance);
+        const glm::mat4 clip_to_world = glm::inverse(projection * view_matrix);
+        const int       columns       = atlas_columns(cascadeCount);
+        const int       rows          = atlas_rows(cascadeCount);
+
+        std::array<glm::vec3, 4> near_corners;
+        std::array<glm::vec3, 4> far_corners;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const float x   = (i & 1) ? 1.0f : -1.0f;
+            const float y   = (i & 2) ? 1.0f : -1.0f;
+            near_corners[i] = unproject(clip_to_world, x, y, -1.0f);
+            far_corners[i]  = unproject(clip_to_world, x, y, 1.0f);
+        }
+
+        float split_near = near_distance;
+        for (int c = 0; c < cascadeCount; ++c)
         {
-            const glm::mat4 s            = glm::scale(glm::mat4(1.0f), scene_object.Scale);
-            const glm::mat4 r            = graphics::euler_angle_xyz_matrix(scene_object.EulerAngles.x, scene_object.EulerAngles.y, scene_object.EulerAngles.z);
-            const glm::mat4 t            = glm::translate(glm::mat4(1.0f), scene_object.Center);
-            const auto      ModelMatrix  = t * r * s;
-            const auto      NormalMatrix = ViewMatrix * glm::mat3(r);
-            shader.SendUniform(Uniforms::ModelMatrix, ModelMatrix);
-            shader.SendUniform(Uniforms::NormalMatrix, NormalMatrix);
-            shader.SendUniform(Uniforms::Ambient,       scene_object.Material.Ambient);
-            shader.SendUniform(Uniforms::Diffuse,       scene_object.Material.Diffuse);
-            shader.SendUniform(Uniforms::SpecularColor, scene_object.Material.SpecularColor);
-            shader.SendUniform(Uniforms::Shininess,     scene_object.Material.Shininess);
-            if (scene_object.Material.CullFaces)
-            {
-                GL::Enable(GL_CULL_FACE);
-                GL::CullFace(culling);
+            auto&       cascade       = cascades[static_cast<size_t>(c)];
+            const float t             = static_cast<float>(c + 1) / static_cast<float>(cascadeCount);
+            const float uniform_split = near_distance + (last_far - near_distance) * t;
+            const float log_split     = near_distance * std::pow(last_far / near_distance, t);
+            const float split_far     = glm::mix(uniform_split, log_split, cascadeSplitLambda);
+
+            std::array<glm::vec3, 8> corners;
+            glm::vec3                center{ 0.0f };
+            for (size_t i = 0; i < 4; ++i)
+            {
+                // depth grows linearly along each corner edge of the view frustum
+                const float from = (split_near - near_distance) / (far_distance - near_distance);
+                const float to   = (split_far - near_distance) / (far_distance - near_distance);
+                corners[i]       = glm::mix(near_corners[i], far_corners[i], from);
+                corners[i + 4]   = glm::mix(near_corners[i], far_corners[i], to);
+                center += corners[i] + corners[i + 4];
+            }
+            center /= 8.0f;
+            float radius = 0;
+            for (const auto& corner : corners)
+            {
+                radius = std::max(radius, glm::length(corner - center));
+            }
+
+            const glm::vec3 to_center = center - lightCamera.Eye;
+            const float     distance  = glm::length(to_center);
+            if (distance <= radius + lightNear)
+            {
+                // the light sits inside the slice, so nothing tighter than the whole light frustum will do
+                cascade.ViewMatrix = lightCamera.ViewMatrix();
+                cascade.Projection = lightProjectionMatrix;
+                cascade.LightNear  = lightNear;
+                cascade.LightFar   = lightFar;
             }
             else
             {
-                GL::Disable(GL_CULL_FACE);
+                const glm::vec3 direction  = to_center / distance;
+                const glm::vec3 up         = (std::abs(glm::dot(direction, graphics::Camera::WORLD_UP)) > 0.99f) ? glm::vec3(0, 0, 1) : graphics::Camera::WORLD_UP;
+                const float     half_angle = std::asin(radius / distance);
+                cascade.LightNear          = lightNear;
+                cascade.LightFar           = distance + radius;
+                cascade.ViewMatrix         = glm::lookAt(lightCamera.Eye, center, up);
+                cascade.Projection         = glm::perspective(2.0f * half_angle, 1.0f, cascade.LightNear, cascade.LightFar);
+            }
+            const float half_fov  = 1.0f / cascade.Projection[1][1]; // tan(fov / 2)
+            cascade.TexelsPerUnit = static_cast<float>(cascadeResolution) / (2.0f * distance * half_fov);
+            cascade.SplitFar      = split_far;
+            if (c == 0)
+            {
+                singleMapTexelsPerUnit = static_cast<float>(shadowMapWidth) / (2.0f * distance * std::tan(lightFOV * 0.5f));
             }
-            const auto& sub_mesh = subMeshes[scene_object.Model];
-            sub_mesh.VertexArrayObj.Use();
-            GLDrawIndexed(sub_mesh.VertexArrayObj);
+
+            cascade.Viewport.x      = (c % columns) * cascadeResolution;
+            cascade.Viewport.y      = (c / columns % rows) * cascadeResolution;
+            cascade.Viewport.width  = cascadeResolution;
+            cascade.Viewport.height = cascadeResolution;
+
+            // squeeze the [0,1] shadow coordinates into this cascade's square of the atlas
+            const float     scale_x = 1.0f / static_cast<float>(columns);
+            const float     scale_y = 1.0f / static_cast<float>(rows);
+            const glm::mat4 to_region{ glm::vec4(scale_x, 0.0f, 0.0f, 0.0f), glm::vec4(0.0f, scale_y, 0.0f, 0.0f), glm::vec4(0.0f, 0.0f, 1.0f, 0.0f),
+                                       glm::vec4(static_cast<float>(c % columns) * scale_x, static_cast<float>(c / columns % rows) * scale_y, 0.0f, 1.0f) };
+            cascade.ShadowMatrix = to_region * ShadowBias * cascade.Projection * cascade.ViewMatrix;
+
+            split_near = split_far;
         }
     }
 
+    void D05ShadowMapping::cullSceneObjects(const glm::mat4& view_projection, const glm::mat4& light_view_projection)
+    {
+        const auto& transforms = objectTransforms[frontTransforms];
+        frustumCuller.Clear();
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            frustumCuller.Add(graphics::transform_bounds(modelBounds[sceneObjects[i].Model], transforms.GetModelMatrix(i)));
+        }
+        if (frustumCulling)
+        {
+            cameraCullCounts = frustumCuller.Cull(graphics::extract_frustum(view_projection), visibleFromCamera);
+            lightCullCounts  = frustumCuller.Cull(graphics::extract_frustum(light_view_projection), visibleFromLight);
+            if (shadowMode == ShadowMode::Cascaded)
+            {
+                for (size_t c = 0; c < static_cast<size_t>(cascadeCount); ++c)
+                {
+                    const auto& cascade  = cascades[c];
+                    cascadeCullCounts[c] = frustumCuller.Cull(graphics::extract_frustum(cascade.Projection * cascade.ViewMatrix), visibleFromCascade[c]);
+                }
+            }
+        }
+        else
+        {
+            visibleFromCamera.assign(sceneObjects.size(), 1);
+            visibleFromLight.assign(sceneObjects.size(), 1);
+            cameraCullCounts = graphics::CullCounts{ static_cast<int>(sceneObjects.size()), 0 };
+            lightCullCounts  = cameraCullCounts;
+            for (size_t c = 0; c < static_cast<size_t>(cascadeCount); ++c)
+            {
+                visibleFromCascade[c].assign(sceneObjects.size(), 1);
+                cascadeCullCounts[c] = cameraCullCounts;
+            }
+        }
+    }
+
+    bool D05ShadowMapping::sceneShadersAreReady() const
+    {
+        if (multiDrawIndirect)
+        {
+            return (!gpuCulling || shaders[Shaders::CullDraws].IsReady()) && shaders[Shaders::ShadowIndirect].IsReady() && shaders[Shaders::WriteDepthIndirect].IsReady();
+        }
+        return shaders[Shaders::Shadow].IsReady() && shaders[Shaders::WriteDepth].IsReady();
+    }
+
+    void D05ShadowMapping::updateShadowCache()
+    {
+        // a program still building keys as 0, so the map is drawn again once it is done
+        const auto&    depth_shader  = shaders[multiDrawIndirect ? Shaders::WriteDepthIndirect : Shaders::WriteDepth];
+        const GLHandle depth_program = depth_shader.IsReady() ? depth_shader.GetHandle() : 0;
+        const auto state_for     = [this, depth_program](const glm::mat4& view_matrix, const glm::mat4& projection)
+        {
+            return ShadowPassState{ view_matrix, projection, glPolygonOffset_factor, glPolygonOffset_units, drawBackFacesForRecordDepthPass, transformsVersion, depth_program };
+        };
+        const auto needs_render = [this](ShadowPassState& rendered, const ShadowPassState& current)
+        {
+            const bool is_dirty = !cacheShadowMaps || rendered != current;
+            rendered            = current;
+            if (is_dirty)
+                ++shadowPassesRendered;
+            else
+                ++shadowPassesSkipped;
+            return is_dirty;
+        };
+
+        if (shadowMode == ShadowMode::Cascaded)
+        {
+            // the cascades are fitted to the camera, so they follow it around while the single map only follows the light
+            for (size_t c = 0; c < static_cast<size_t>(cascadeCount); ++c)
+            {
+                cascadeNeedsRender[c] = needs_render(renderedCascades[c], state_for(cascades[c].ViewMatrix, cascades[c].Projection));
+            }
+        }
+        else
+        {
+            shadowMapNeedsRender = needs_render(renderedShadowMap, state_for(lightCamera.ViewMatrix(), lightProjectionMatrix));
+        }
+    }
+
+    void D05ShadowMapping::queueSceneObjects()
+    {
+        // The shadow pass has no material to speak of, so its draws only differ by mesh and culling.
+        // The screen pass binds colors by material, so objects sharing one are drawn together once sorted.
+        const auto& transforms = objectTransforms[frontTransforms];
+        const auto& view_eye   = (cameraMode == CameraMode::View) ? camera.Eye : lightCamera.Eye;
+        renderQueue.Clear();
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            const auto&                   scene_object = sceneObjects[i];
+            graphics::RenderQueue::Packet packet;
+            const auto&                   range        = packedMeshes.Ranges[scene_object.Model];
+            packet.Mesh        = &packedMeshes.VertexArrayObj;
+            packet.IndexCount  = range.IndexCount;
+            packet.FirstIndex  = range.FirstIndex;
+            packet.Object      = static_cast<unsigned>(i);
+            packet.ModelMatrix = transforms.GetModelMatrix(i);
+            packet.Flags       = scene_object.Material.CullFaces ? graphics::RenderQueue::None : graphics::RenderQueue::DoubleSided;
+            const glm::vec3 center(packet.ModelMatrix[3]);
+            if (shadowMode == ShadowMode::Cascaded)
+            {
+                packet.Shader    = &shaders[Shaders::WriteDepth];
+                packet.Material  = 0;
+                packet.ViewDepth = glm::length(center - lightCamera.Eye);
+                for (size_t c = 0; c < static_cast<size_t>(cascadeCount); ++c)
+                {
+                    if (cascadeNeedsRender[c] && visibleFromCascade[c][i])
+                        renderQueue.Submit(RenderPass::Cascade0 + static_cast<unsigned>(c), packet);
+                }
+            }
+            else if (shadowMapNeedsRender && visibleFromLight[i])
+            {
+                packet.Shader    = &shaders[Shaders::WriteDepth];
+                packet.Material  = 0;
+                packet.ViewDepth = glm::length(center - lightCamera.Eye);
+                renderQueue.Submit(RenderPass::Shadow, packet);
+            }
+            if (visibleFromCamera[i])
+            {
+                packet.Shader    = &shaders[Shaders::Shadow];
+                packet.Material  = static_cast<unsigned>(scene_object.MaterialIndex);
+                packet.ViewDepth = glm::length(center - view_eye);
+                renderQueue.Submit(RenderPass::Screen, packet);
+            }
+        }
+        renderQueue.Sort();
+    }
+
+    void D05ShadowMapping::uploadDrawData()
+    {
+        // Materials never change, the matrices only when new transforms are published
+        if (uploadedDrawDataVersion == transformsVersion)
+            return;
+        const auto& transforms = objectTransforms[frontTransforms];
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            drawData[i].ModelMatrix  = transforms.GetModelMatrix(i);
+            drawData[i].NormalMatrix = glm::mat4(transforms.GetNormalMatrix(i));
+        }
+        drawDataBuffer->SetData(std::span{ drawData });
+        uploadedDrawDataVersion = transformsVersion;
+    }
+
+    void D05ShadowMapping::queueIndirectDraws()
+    {
+        uploadDrawData();
+        indirectCommands.clear();
+        indirectPasses.fill(IndirectPass{});
+        indirectDrawCalls = 0;
+        const auto add_pass = [this](RenderPass::Type pass, const std::vector<std::uint8_t>& is_visible)
+        {
+            auto& indirect_pass = indirectPasses[pass];
+            indirect_pass.First = static_cast<GLsizei>(indirectCommands.size());
+            for (const bool double_sided : { false, true })
+            {
+                for (size_t i = 0; i < sceneObjects.size(); ++i)
+                {
+                    const auto& scene_object = sceneObjects[i];
+                    if (!is_visible[i] || scene_object.Material.CullFaces == double_sided)
+                        continue;
+                    // the base instance is what aDrawIndex reads, so it picks the object's DrawData
+                    const auto& range = packedMeshes.Ranges[scene_object.Model];
+                    indirectCommands.push_back(GLDrawElementsIndirectCommand{ static_cast<GLuint>(range.IndexCount), 1, static_cast<GLuint>(range.FirstIndex), 0, static_cast<GLuint>(i) });
+                }
+                auto& count = double_sided ? indirect_pass.DoubleSidedCount : indirect_pass.SingleSidedCount;
+                count       = static_cast<GLsizei>(indirectCommands.size()) - indirect_pass.First - indirect_pass.SingleSidedCount;
+                if (count > 0)
+                    ++indirectDrawCalls;
+            }
+        };
+
+        if (shadowMode == ShadowMode::Cascaded)
+        {
+            for (size_t c = 0; c < static_cast<size_t>(cascadeCount); ++c)
+            {
+                if (cascadeNeedsRender[c])
+                    add_pass(static_cast<RenderPass::Type>(RenderPass::Cascade0 + c), visibleFromCascade[c]);
+            }
+        }
+        else if (shadowMapNeedsRender)
+        {
+            add_pass(RenderPass::Shadow, visibleFromLight);
+        }
+        add_pass(RenderPass::Screen, visibleFromCamera);
+        if (!indirectCommands.empty())
+            indirectBuffer->SetData(std::span{ indirectCommands });
+    }
+
+    void D05ShadowMapping::queueGpuCulling(const glm::mat4& view_projection, const glm::mat4& light_view_projection)
+    {
+        // last frame's commands are still in the buffers, and so are the matrices and frusta they were culled with
+        if (checkGpuCulling)
+            compareGpuCulling();
+        uploadDrawData();
+
+        graphics::Frustum everything;
+        everything.Planes.fill(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)); // every point is in front of these
+        const auto objects = static_cast<GLsizei>(sceneObjects.size());
+        cullViewMask       = 0;
+        indirectPasses.fill(IndirectPass{});
+        const auto add_view = [&](RenderPass::Type pass, const glm::mat4& pass_view_projection)
+        {
+            cullViews[pass] = frustumCulling ? graphics::extract_frustum(pass_view_projection) : everything;
+            cullViewMask |= 1u << pass;
+            // room for every object in both groups, the GPU writes how many it used into drawCountBuffer
+            const auto group     = static_cast<GLsizei>(pass) * 2;
+            indirectPasses[pass] = IndirectPass{ group * objects, objects, objects, group };
+        };
+
+        if (shadowMode == ShadowMode::Cascaded)
+        {
+            for (size_t c = 0; c < static_cast<size_t>(cascadeCount); ++c)
+            {
+                if (cascadeNeedsRender[c])
+                    add_view(static_cast<RenderPass::Type>(RenderPass::Cascade0 + c), cascades[c].Projection * cascades[c].ViewMatrix);
+            }
+        }
+        else if (shadowMapNeedsRender)
+        {
+            add_view(RenderPass::Shadow, light_view_projection);
+        }
+        add_view(RenderPass::Screen, view_projection);
+        cullViewBuffer->SetData(std::span{ cullViews });
+        indirectDrawCalls = 2 * std::popcount(cullViewMask);
+    }
+
+    void D05ShadowMapping::compareGpuCulling()
+    {
+#if !defined(OPENGL_ES3_ONLY)
+        if (cullViewMask == 0)
+            return;
+        const size_t                               objects = sceneObjects.size();
+        const size_t                               groups  = 2 * cullViews.size();
+        std::vector<GLDrawElementsIndirectCommand> gpu_commands(groups * objects);
+        std::vector<std::uint32_t>                 gpu_counts(groups);
+        read_back(*indirectBuffer, std::as_writable_bytes(std::span{ gpu_commands }));
+        read_back(*drawCountBuffer, std::as_writable_bytes(std::span{ gpu_counts }));
+
+        std::vector<glm::mat4> model_matrices;
+        model_matrices.reserve(objects);
+        for (const auto& draw : drawData)
+        {
+            model_matrices.push_back(draw.ModelMatrix);
+        }
+        std::vector<GLDrawElementsIndirectCommand> cpu_commands(groups * objects);
+        std::vector<std::uint32_t>                 cpu_counts(groups);
+        graphics::cull_draws(cullObjects, model_matrices, cullViews, cullViewMask, cpu_commands, cpu_counts);
+
+        for (size_t group = 0; group < groups; ++group)
+        {
+            const auto gpu_group = std::span{ gpu_commands }.subspan(group * objects, std::min<size_t>(gpu_counts[group], objects));
+            const auto cpu_group = std::span{ cpu_commands }.subspan(group * objects, cpu_counts[group]);
+            if (gpu_counts[group] != cpu_counts[group] || !graphics::same_draws(gpu_group, cpu_group))
+                ++gpuCullingMismatches;
+        }
+        ++gpuCullingChecks;
+#endif
+    }
+
+    void D05ShadowMapping::cullOnGpu() const
+    {
+#if !defined(OPENGL_ES3_ONLY)
+        const GLProfileScope profile_scope("cullOnGpu");
+        // the counts start from 0 every frame, and without count draws the unused commands have to be 0s so they draw nothing
+        GL::BindBuffer(GL_SHADER_STORAGE_BUFFER, drawCountBuffer->GetHandle());
+        GL::ClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        if (!canDrawIndirectCount)
+        {
+            GL::BindBuffer(GL_SHADER_STORAGE_BUFFER, indirectBuffer->GetHandle());
+            GL::ClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        }
+        GL::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        const auto& cull_shader = shaders[Shaders::CullDraws];
+        cull_shader.Use();
+        cull_shader.SendUniform(Uniforms::ObjectCount, static_cast<unsigned>(sceneObjects.size()));
+        cull_shader.SendUniform(Uniforms::ViewMask,    static_cast<unsigned>(cullViewMask));
+        GL::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawDataBuffer->GetHandle());
+        GL::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cullObjectBuffer->GetHandle());
+        GL::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, cullViewBuffer->GetHandle());
+        GL::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, indirectBuffer->GetHandle());
+        GL::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, drawCountBuffer->GetHandle());
+        constexpr GLuint group_size = 64; // cull_draws.comp's local_size_x
+        GL::DispatchCompute((static_cast<GLuint>(sceneObjects.size()) + group_size - 1) / group_size, 1, 1);
+        // the draws read the commands and counts as indirect arguments, compareGpuCulling() reads them back
+        GL::MemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+#endif
+    }
+
+    void D05ShadowMapping::drawSceneObjects(RenderPass::Type pass) const
+    {
+        if (multiDrawIndirect)
+        {
+            drawIndirect(pass);
+            return;
+        }
+        auto&       the_camera = (cameraMode == CameraMode::View) ? camera : lightCamera;
+        const auto  ViewMatrix = glm::mat3(the_camera.ViewMatrix());
+        const auto& transforms = objectTransforms[frontTransforms];
+        renderQueue.Execute(
+            pass,
+            [&](const GLShader& shader, unsigned material)
+            {
+                if (pass != RenderPass::Screen)
+                    return;
+                const auto& the_material = materials[material];
+                shader.SendUniform(Uniforms::Ambient,       the_material.Ambient);
+                shader.SendUniform(Uniforms::Diffuse,       the_material.Diffuse);
+                shader.SendUniform(Uniforms::SpecularColor, the_material.SpecularColor);
+                shader.SendUniform(Uniforms::Shininess,     the_material.Shininess);
+            },
+            [&](const GLShader& shader, const graphics::RenderQueue::Packet& packet)
+            {
+                shader.SendUniform(Uniforms::ModelMatrix,  packet.ModelMatrix);
+                shader.SendUniform(Uniforms::NormalMatrix, ViewMatrix * transforms.GetNormalMatrix(packet.Object));
+            });
+    }
+
+    void D05ShadowMapping::drawIndirect([[maybe_unused]] RenderPass::Type pass) const
+    {
+#if !defined(OPENGL_ES3_ONLY)
+        // the caller has the shader in use, everything per object comes from the storage buffer
+        const auto& indirect_pass = indirectPasses[pass];
+        const auto& vertex_array  = packedMeshes.VertexArrayObj;
+        vertex_array.Use();
+        GL::BindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer->GetHandle());
+        GL::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawDataBuffer->GetHandle());
+        // GPU culled passes know how many commands there are only on the GPU, 4.6 reads it from there
+        const bool gpu_counts = indirect_pass.CountIndex >= 0 && canDrawIndirectCount;
+        if (gpu_counts)
+            GL::BindBuffer(GL_PARAMETER_BUFFER, drawCountBuffer->GetHandle());
+        const auto multi_draw = [&](GLsizei draw_count, GLsizei first_command, GLsizei count_index)
+        {
+            if (gpu_counts)
+                GLMultiDrawIndexedIndirectCount(vertex_array, draw_count, first_command, count_index);
+            else
+                GLMultiDrawIndexedIndirect(vertex_array, draw_count, first_command);
+        };
+        if (indirect_pass.SingleSidedCount > 0)
+        {
+            GL::Enable(GL_CULL_FACE);
+            multi_draw(indirect_pass.SingleSidedCount, indirect_pass.First, indirect_pass.CountIndex);
+        }
+        if (indirect_pass.DoubleSidedCount > 0)
+        {
+            GL::Disable(GL_CULL_FACE);
+            multi_draw(indirect_pass.DoubleSidedCount, indirect_pass.First + indirect_pass.SingleSidedCount, indirect_pass.CountIndex + 1);
+            GL::Enable(GL_CULL_FACE);
+        }
+        if (gpu_counts)
+            GL::BindBuffer(GL_PARAMETER_BUFFER, 0);
+        GL::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#endif
+    }
+
     void D05ShadowMapping::updateSpectatorCamera(graphics::Camera& the_camera)
     {
         using namespace environment;
@@ -443,6 +1152,21 @@ namespace demos
         spec.DepthFormat = depthBitSize;
         spec.ColorFormat = GLFrameBuffer::ColorComponent::RGBA8;
         shadowFrameBuffer.LoadWithSpecification(spec);
+        renderedShadowMap = ShadowPassState{};
+    }
+
+    void D05ShadowMapping::setupCascadeFrameBuffer()
+    {
+        // only pay for the atlas once it is used
+        if (shadowMode != ShadowMode::Cascaded)
+            return;
+        GLFrameBuffer::Specification spec;
+        spec.Width       = atlas_columns(cascadeCount) * cascadeResolution;
+        spec.Height      = atlas_rows(cascadeCount) * cascadeResolution;
+        spec.DepthFormat = depthBitSize;
+        spec.ColorFormat = GLFrameBuffer::ColorComponent::RGBA8;
+        cascadeFrameBuffer.LoadWithSpecification(spec);
+        renderedCascades.fill(ShadowPassState{});
     }
 
     void D05ShadowMapping::buildMeshes()
@@ -450,10 +1174,10 @@ namespace demos
         const std::array geometries = { graphics::create_trefoil(256, 64), graphics::create_plane(1, 1),     graphics::create_cube(1, 1), graphics::create_sphere(64, 64),
                                         graphics::create_torus(64, 64),    graphics::create_cylinder(4, 64), graphics::create_cone(4, 64) };
 
-        for (size_t i = 0; i < subMeshes.size(); ++i)
+        packedMeshes = graphics::pack_as_triangles(geometries);
+        for (size_t i = 0; i < modelBounds.size(); ++i)
         {
-            auto& sub_mesh = subMeshes[i];
-            sub_mesh       = graphics::to_submesh_as_triangles(geometries[i]);
+            modelBounds[i] = geometries[i].Sphere;
         }
 
         auto cube_geometry = geometries[ObjectModel::Cube];
@@ -473,8 +1197,10 @@ namespace demos
 
     void D05ShadowMapping::buildScene()
     {
-        constexpr float SIZE                = 5.0f;
-        const auto      set_random_material = [](SceneObject& object)
+        constexpr float SIZE = 5.0f;
+        // a small palette instead of colors per object, so the screen pass has materials worth sorting by
+        std::array<ObjectMaterial, 12> palette;
+        for (auto& material : palette)
         {
             glm::vec3 diffuse;
             do
@@ -483,13 +1209,14 @@ namespace demos
                 diffuse.g = util::random();
                 diffuse.b = util::random();
             } while (diffuse.r + diffuse.g + diffuse.b < 1.0f);
-            const glm::vec3 ambient       = diffuse * 0.05f;
-            const glm::vec3 specular      = diffuse;
-            const float     shininess     = util::random(0.5f, 75.0f);
-            object.Material.Diffuse       = diffuse;
-            object.Material.SpecularColor = specular;
-            object.Material.Ambient       = ambient;
-            object.Material.Shininess     = shininess;
+            material.Diffuse       = diffuse;
+            material.SpecularColor = diffuse;
+            material.Ambient       = diffuse * 0.05f;
+            material.Shininess     = util::random(0.5f, 75.0f);
+        }
+        const auto set_random_material = [&palette](SceneObject& object)
+        {
+            object.Material = palette[static_cast<size_t>(util::random(static_cast<int>(palette.size())))];
         };
 
         { // Ground Plane
@@ -555,7 +1282,86 @@ namespace demos
             object.Center      = { x, y, z };
             object.EulerAngles = { util::random(-3.14f, 3.14f), util::random(-3.14f, 3.14f), util::random(-3.14f, 3.14f) };
             object.Scale       = { util::random(SIZE / 20.0f, SIZE / 8.0f), util::random(SIZE / 20.0f, SIZE / 8.0f), util::random(SIZE / 20.0f, SIZE / 8.0f) };
+            object.Spin        = { util::random(-1.0f, 1.0f), util::random(-1.0f, 1.0f), util::random(-1.0f, 1.0f) };
             sceneObjects.push_back(object);
         }
+
+        // objects whose colors and culling match share a material
+        materials.clear();
+        for (auto& scene_object : sceneObjects)
+        {
+            const auto found           = std::find(materials.begin(), materials.end(), scene_object.Material);
+            scene_object.MaterialIndex = static_cast<size_t>(found - materials.begin());
+            if (found == materials.end())
+                materials.push_back(scene_object.Material);
+        }
+
+        simulatedEulerAngles.clear();
+        objectTransforms[0].Clear();
+        objectTransforms[1].Clear();
+        for (const auto& scene_object : sceneObjects)
+        {
+            simulatedEulerAngles.push_back(scene_object.EulerAngles);
+            for (auto& transforms : objectTransforms)
+            {
+                transforms.Add(scene_object.Center, scene_object.EulerAngles, scene_object.Scale);
+            }
+        }
+        for (auto& transforms : objectTransforms)
+        {
+            transforms.Update();
+        }
+    }
+
+    void D05ShadowMapping::setupIndirectDraws()
+    {
+        if (!canMultiDrawIndirect)
+            return;
+        drawData.resize(sceneObjects.size());
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            const auto& material          = sceneObjects[i].Material;
+            drawData[i].Diffuse           = glm::vec4(material.Diffuse, 1.0f);
+            drawData[i].Ambient           = glm::vec4(material.Ambient, 1.0f);
+            drawData[i].SpecularShininess = glm::vec4(material.SpecularColor, material.Shininess);
+        }
+        drawDataBuffer.emplace(static_cast<GLsizei>(drawData.size() * sizeof(DrawData)));
+        uploadedDrawDataVersion = 0;
+
+        // every object can be drawn once by each cascade and once by the screen pass,
+        // GPU culling gives every pass room for all of them twice, once per cull state
+        const auto most_commands     = sceneObjects.size() * (MaxCascades + 1);
+        const auto most_gpu_commands = sceneObjects.size() * 2 * cullViews.size();
+        indirectBuffer.emplace(static_cast<GLsizei>(most_gpu_commands * sizeof(GLDrawElementsIndirectCommand)));
+        indirectCommands.reserve(most_commands);
+
+        cullObjects.resize(sceneObjects.size());
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            const auto& scene_object   = sceneObjects[i];
+            const auto& bounds         = modelBounds[scene_object.Model];
+            const auto& range          = packedMeshes.Ranges[scene_object.Model];
+            cullObjects[i].Sphere      = glm::vec4(bounds.Center, bounds.Radius);
+            cullObjects[i].IndexCount  = static_cast<std::uint32_t>(range.IndexCount);
+            cullObjects[i].FirstIndex  = static_cast<std::uint32_t>(range.FirstIndex);
+            cullObjects[i].DoubleSided = scene_object.Material.CullFaces ? 0u : 1u;
+        }
+        cullObjectBuffer.emplace(std::span{ cullObjects });
+        cullViewBuffer.emplace(static_cast<GLsizei>(sizeof(cullViews)));
+        drawCountBuffer.emplace(static_cast<GLsizei>(2 * cullViews.size() * sizeof(std::uint32_t)));
+
+        // aDrawIndex: 0, 1, 2... stepped once per instance, so each draw reads its base instance
+        std::vector<float> draw_indices(sceneObjects.size());
+        for (size_t i = 0; i < draw_indices.size(); ++i)
+        {
+            draw_indices[i] = static_cast<float>(i);
+        }
+        GLAttributeLayout draw_index;
+        draw_index.component_type         = GLAttributeLayout::Float;
+        draw_index.component_dimension    = GLAttributeLayout::_1;
+        draw_index.vertex_layout_location = 3;
+        draw_index.stride                 = sizeof(float);
+        draw_index.divisor                = 1;
+        packedMeshes.VertexArrayObj.AddVertexBuffer(GLVertexBuffer(std::span{ draw_indices }), { draw_index });
     }
 }
@@ -10,10 +10,15 @@
 #include "IDemo.hpp"
 #include "assets/Reloader.hpp"
 #include "graphics/Camera.hpp"
+#include "graphics/DrawCulling.hpp"
+#include "graphics/Frustum.hpp"
 #include "graphics/Mesh.hpp"
+#include "graphics/RenderQueue.hpp"
+#include "graphics/TransformSystem.hpp"
 #include "opengl/GLFrameBuffer.hpp"
 #include "opengl/GLShader.hpp"
 #include "opengl/GLVertexArray.hpp"
+#include <optional>
 
 namespace demos
 {
@@ -23,6 +28,8 @@ namespace demos
         D05ShadowMapping();
 
         void Update() override;
+        void Simulate(const SimulationStep& step) override;
+        void PublishSimulation() override;
 
         void Draw() const override;
         void ImGuiDraw() override;
@@ -54,26 +61,95 @@ namespace demos
                 Fill,
                 WriteDepth,
                 ViewDepth,
+                ShadowIndirect,     // the multi-draw indirect versions read each draw's data from a storage buffer
+                WriteDepthIndirect,
+                CullDraws, // compute, writes the indirect commands
                 Count
             };
         };
 
+        struct ObjectMaterial
+        {
+            glm::vec3 Diffuse;
+            glm::vec3 SpecularColor;
+            glm::vec3 Ambient;
+            float     Shininess;
+            bool      CullFaces = true;
+
+            bool operator==(const ObjectMaterial&) const = default;
+        };
+
         struct SceneObject
         {
             glm::vec3         Center{};
             glm::vec3         EulerAngles{};
             glm::vec3         Scale{};
-            size_t            MaterialIndex = 0;
+            glm::vec3         Spin{}; // radians per second around each axis
+            size_t            MaterialIndex = 0; // into materials, objects with the same colors share one
             ObjectModel::Type Model{};
+            ObjectMaterial    Material;
+        };
+
+        struct RenderPass
+        {
+            enum Type : unsigned
+            {
+                Shadow,
+                Screen,
+                Cascade0 // cascade i renders in pass Cascade0 + i
+            };
+        };
+
+        static constexpr int MaxCascades = 4;
 
+        // One slice of the view frustum and the light frustum fitted around it
+        struct Cascade
+        {
+            glm::mat4 ViewMatrix{ 1.0f };
+            glm::mat4 Projection{ 1.0f };
+            glm::mat4 ShadowMatrix{ 1.0f }; // world space to this cascade's square of the atlas
+            float     LightNear     = 0;
+            float     LightFar      = 0;
+            float     SplitFar      = 0; // view space depth where the cascade ends
+            float     TexelsPerUnit = 0; // shadow map texels across one world unit at the middle of the slice
             struct
             {
-                glm::vec3 Diffuse;
-                glm::vec3 SpecularColor;
-                glm::vec3 Ambient;
-                float     Shininess;
-                bool      CullFaces = true;
-            } Material;
+                int x = 0, y = 0, width = 0, height = 0;
+            } Viewport;
+        };
+
+        // One entry of draw_data.glsl's storage buffer, laid out the way std430 packs it
+        struct DrawData
+        {
+            glm::mat4 ModelMatrix{ 1.0f };
+            glm::mat4 NormalMatrix{ 1.0f };
+            glm::vec4 Diffuse{ 0.0f };
+            glm::vec4 Ambient{ 0.0f };
+            glm::vec4 SpecularShininess{ 0.0f };
+        };
+
+        // Where a pass's commands are in the indirect buffer, the single sided ones come first.
+        // When the GPU culls, the counts are how many commands fit and the real ones are at drawCountBuffer[CountIndex] and the one after.
+        struct IndirectPass
+        {
+            GLsizei First            = 0;
+            GLsizei SingleSidedCount = 0;
+            GLsizei DoubleSidedCount = 0;
+            GLsizei CountIndex       = -1;
+        };
+
+        // Everything a shadow pass depends on. When it matches what the pass was last rendered with, its map can be reused.
+        struct ShadowPassState
+        {
+            glm::mat4          ViewMatrix{ 0.0f };
+            glm::mat4          Projection{ 0.0f };
+            float              PolygonOffsetFactor = 0;
+            float              PolygonOffsetUnits  = 0;
+            bool               DrawBackFaces       = false;
+            unsigned long long TransformsVersion   = 0;
+            GLHandle           DepthProgram        = 0; // the program writing depth, reloading its shaders makes a new one
+
+            bool operator==(const ShadowPassState&) const = default;
         };
 
         assets::Reloader                                  assetReloader;
@@ -86,10 +162,54 @@ namespace demos
         graphics::Camera                                  camera;
         graphics::Camera                                  lightCamera;
         std::array<GLShader, Shaders::Count>              shaders;
-        std::array<graphics::SubMesh, ObjectModel::Count> subMeshes;
+        graphics::PackedMeshes                            packedMeshes; // every ObjectModel in one vertex array, one range each
         graphics::SubMesh                                 ndcCube;
         graphics::SubMesh                                 ndcQuad;
         std::vector<SceneObject>                          sceneObjects;
+        std::vector<ObjectMaterial>                       materials;
+        // Simulate() owns the angles and writes the back transforms, the render thread only reads the front ones
+        std::vector<glm::vec3>                            simulatedEulerAngles;
+        std::array<graphics::TransformSystem, 2>          objectTransforms;
+        size_t                                            frontTransforms   = 0;
+        unsigned long long                                transformsVersion = 1; // bumped whenever new transforms are published
+        bool                                              hasNewTransforms  = false;
+        bool                                              simulationAnimate = false;
+        bool                                              animateObjects    = false;
+
+        std::array<graphics::BoundingSphere, ObjectModel::Count> modelBounds;
+        graphics::FrustumCuller                                  frustumCuller;
+        std::vector<std::uint8_t>                                visibleFromCamera;
+        std::vector<std::uint8_t>                                visibleFromLight;
+        graphics::CullCounts                                     cameraCullCounts;
+        graphics::CullCounts                                     lightCullCounts;
+        bool                                                     frustumCulling = true;
+        graphics::RenderQueue                                    renderQueue;
+
+        // Multi-draw indirect: one glMultiDrawElementsIndirect per pass and cull state, drawing from packedMeshes.
+        // Without OpenGL 4.3 the render queue draws the same ranges one at a time.
+        std::vector<DrawData>                                        drawData;
+        std::vector<GLDrawElementsIndirectCommand>                   indirectCommands;
+        std::array<IndirectPass, RenderPass::Cascade0 + MaxCascades> indirectPasses{};
+        std::optional<GLVertexBuffer>                                drawDataBuffer;
+        std::optional<GLVertexBuffer>                                indirectBuffer;
+        unsigned long long                                           uploadedDrawDataVersion = 0;
+        int                                                          indirectDrawCalls       = 0;
+        bool                                                         canMultiDrawIndirect    = false;
+        bool                                                         multiDrawIndirect       = false;
+
+        // GPU culling: cull_draws.comp fills the indirect buffer from the frusta, graphics::cull_draws() is its CPU reference
+        std::vector<graphics::CullObject>                                 cullObjects;
+        std::array<graphics::Frustum, RenderPass::Cascade0 + MaxCascades> cullViews{}; // indexed by pass
+        std::optional<GLVertexBuffer>                                     cullObjectBuffer;
+        std::optional<GLVertexBuffer>                                     cullViewBuffer;
+        std::optional<GLVertexBuffer>                                     drawCountBuffer;
+        std::uint32_t                                                     cullViewMask         = 0; // one bit per pass that culls this frame
+        unsigned long long                                                gpuCullingChecks     = 0;
+        unsigned long long                                                gpuCullingMismatches = 0;
+        bool                                                              canDrawIndirectCount = false;
+        bool                                                              gpuCulling           = false;
+        bool                                                              checkGpuCulling      = false;
+
         static constexpr glm::vec3                        FogColor{ 0.337f };
         float                                             fogDensity = 0.01f;
 
@@ -99,6 +219,27 @@ namespace demos
         } viewport;
 
         GLFrameBuffer  shadowFrameBuffer;
+        GLFrameBuffer  cascadeFrameBuffer; // every cascade in one atlas, two squares across and up to two down
+
+        std::array<Cascade, MaxCascades>                   cascades;
+        std::array<std::vector<std::uint8_t>, MaxCascades> visibleFromCascade;
+        std::array<graphics::CullCounts, MaxCascades>      cascadeCullCounts;
+        int                                                cascadeCount           = 3;
+        int                                                cascadeResolution      = 1024;
+        float                                              cascadeSplitLambda     = 0.75f; // 0 splits the range evenly, 1 logarithmically
+        float                                              shadowDistance         = 40.0f; // how far from the camera the cascades reach
+        float                                              singleMapTexelsPerUnit = 0;     // the single shadow map's density at the first cascade, for comparison
+        bool                                               showCascades           = false;
+
+        // a default ShadowPassState never matches a real one, so resetting these forces a redraw
+        ShadowPassState                                    renderedShadowMap;
+        std::array<ShadowPassState, MaxCascades>           renderedCascades;
+        bool                                               shadowMapNeedsRender = true;
+        bool                                               scenePassesReady     = false;
+        std::array<bool, MaxCascades>                      cascadeNeedsRender{};
+        bool                                               cacheShadowMaps      = true;
+        unsigned long long                                 shadowPassesRendered = 0;
+        unsigned long long                                 shadowPassesSkipped  = 0;
 
         struct
         {
@@ -115,7 +256,13 @@ namespace demos
             View,
             Light
         };
+        enum class ShadowMode
+        {
+            Single,
+            Cascaded
+        };
         CameraMode cameraMode             = CameraMode::View;
+        ShadowMode shadowMode             = ShadowMode::Single;
         bool       shouldDrawDepthTexture = false;
         bool       shouldDrawLightFrustum = true;
         bool       DoShadowBehindLight    = true;
@@ -128,14 +275,28 @@ namespace demos
 
     private:
         void renderToDepthBuffer() const;
+        void renderToCascades() const;
         void renderToScreen() const;
         void drawLightFrustum() const;
         void drawDepthTexture() const;
-        void drawSceneObjects(const GLShader& shader, GLenum culling) const;
+        void updateCascades(const glm::mat4& view_matrix, const glm::mat4& projection, float near_distance, float far_distance);
+        void cullSceneObjects(const glm::mat4& view_projection, const glm::mat4& light_view_projection);
+        bool sceneShadersAreReady() const;
+        void updateShadowCache();
+        void queueSceneObjects();
+        void uploadDrawData();
+        void queueIndirectDraws();
+        void queueGpuCulling(const glm::mat4& view_projection, const glm::mat4& light_view_projection);
+        void compareGpuCulling();
+        void cullOnGpu() const;
+        void drawSceneObjects(RenderPass::Type pass) const;
+        void drawIndirect(RenderPass::Type pass) const;
         void updateSpectatorCamera(graphics::Camera& the_camera);
         void setupShadowFrameBuffer();
+        void setupCascadeFrameBuffer();
         void buildMeshes();
         void buildScene();
+        void setupIndirectDraws();
     };
 
 }
@@ -9,7 +9,9 @@
 #include "D06GeometryShaders.hpp"
 
 #include "environment/Environment.hpp"
+#include "graphics/MathHelper.hpp"
 #include "opengl/GL.hpp"
+#include <algorithm>
 #include <glm/ext/matrix_clip_space.hpp> // perspective
 #include <glm/ext/matrix_transform.hpp>  // translate, rotate
 #include <glm/trigonometric.hpp>         // all the GLSL trigonometric functions: radians, cos, asin, etc.
@@ -87,12 +89,16 @@ namespace demos
             {      asset_paths::FunShaderName,      { asset_paths::Textured3DVertexPath, asset_paths::FunGeometryPath, asset_paths::Textured3DFragmentPath }}
         };
 
+        // submit every shader first so the driver can build them in parallel
         for (size_t i = 0; i < Materials::Count; ++i)
         {
             const auto& setup = shader_setup[i];
             const auto  paths = std::span{ setup.ShaderFilePaths };
             assetReloader.SetAndAutoReloadShader(shaders[i], setup.ShaderName, paths);
-            materials[i]                 = graphics::Material(&shaders[i], setup.ShaderName + " Material"s);
+        }
+        for (size_t i = 0; i < Materials::Count; ++i)
+        {
+            materials[i]                 = graphics::Material(&shaders[i], shader_setup[i].ShaderName + " Material"s);
             materials[i].Culling.Enabled = false;
         }
 
@@ -148,6 +154,12 @@ namespace demos
             cone.Translation = glm::vec3(0.5f, -0.5f, 0);
             sceneObjects.push_back(cone);
         }
+
+        objectTransforms.Reserve(sceneObjects.size());
+        for (const auto& scene_object : sceneObjects)
+        {
+            objectTransforms.Add(scene_object.Translation, glm::vec3(0.0f), glm::vec3(0.35f));
+        }
     }
 
     void D06GeometryShaders::Update()
@@ -170,23 +182,30 @@ namespace demos
         materials[Materials::Extrude].SetMaterialUniform(Uniforms::ExtrudeFactor, extrudeFactor);
         materials[Materials::Extrude].SetMaterialUniform(Uniforms::Flat, extrudeFlatly);
         materials[Materials::Shrink].SetMaterialUniform(Uniforms::ShrinkFactor, shrinkFactor);
+
+        const auto angle        = (autoRotate) ? glm::radians(static_cast<float>(environment::ElapsedTime) * 35.0f) : rotationAngle;
+        const auto euler_angles = graphics::euler_angles_xyz(glm::rotate(glm::mat4(1.0f), angle, glm::vec3{ 1, 1, 0 }));
+        for (size_t i = 0; i < objectTransforms.Size(); ++i)
+        {
+            objectTransforms.SetEulerAngles(i, euler_angles);
+        }
+        objectTransforms.Update();
+        cullSceneObjects();
     }
 
     void D06GeometryShaders::Draw() const
     {
         GL::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        const auto      angle = (autoRotate) ? glm::radians(static_cast<float>(environment::ElapsedTime) * 35.0f) : rotationAngle;
-        const glm::mat4 r     = glm::rotate(glm::mat4(1.0f), angle, glm::vec3{ 1, 1, 0 });
 
 
         if (currentMaterial == Materials::Normals)
         {
-            drawSceneObjects(r, materials[Materials::Wireframe]);
-            drawSceneObjects(r, materials[Materials::Normals]);
+            drawSceneObjects(materials[Materials::Wireframe]);
+            drawSceneObjects(materials[Materials::Normals]);
         }
         else
         {
-            drawSceneObjects(r, materials[currentMaterial]);
+            drawSceneObjects(materials[currentMaterial]);
         }
         graphics::DEFAULT_MATERIAL.ForceApplyAllSettings();
     }
@@ -257,6 +276,8 @@ namespace demos
         {
             ImGui::SliderAngle("Angle", &rotationAngle);
         }
+        ImGui::Checkbox("Frustum Culling", &frustumCulling);
+        ImGui::Text("Objects drawn %d, culled %d", cullCounts.Drawn, cullCounts.Culled);
     }
 
     void D06GeometryShaders::SetDisplaySize(int width, int height)
@@ -272,18 +293,48 @@ namespace demos
         ViewMatrix = glm::lookAt(eye_position, target_position, relative_up);
     }
 
-    void D06GeometryShaders::drawSceneObjects(const glm::mat4& r, graphics::Material& material) const
+    void D06GeometryShaders::cullSceneObjects()
     {
-        for (const auto& scene_object : sceneObjects)
+        // the geometry shaders move vertices after the model matrix, grow the spheres by as much as they can
+        float world_margin = 0;
+        switch (currentMaterial)
+        {
+            case Materials::Extrude: world_margin = std::max(extrudeFactor, 0.001f); break;
+            case Materials::Normals: world_margin = 0.05f; break;
+            default: break;
+        }
+        frustumCuller.Clear();
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            auto sphere = graphics::transform_bounds(modelBounds[sceneObjects[i].Model], objectTransforms.GetModelMatrix(i));
+            sphere.Radius += world_margin;
+            frustumCuller.Add(sphere);
+        }
+        // the fun shader twists clip space positions, there is no sphere that is sure to hold the result
+        if (frustumCulling && currentMaterial != Materials::Fun)
         {
-            const auto      t            = glm::translate(glm::mat4(1.0f), scene_object.Translation);
-            const auto      s            = glm::scale(glm::mat4(1.0f), glm::vec3(0.35f));
-            const glm::mat4 ModelMatrix  = t * r * s;
-            const auto&     mesh_to_draw = meshes[scene_object.Model];
+            cullCounts = frustumCuller.Cull(graphics::extract_frustum(ProjectionMatrix * ViewMatrix), visibleObjects);
+        }
+        else
+        {
+            visibleObjects.assign(sceneObjects.size(), 1);
+            cullCounts = graphics::CullCounts{ static_cast<int>(sceneObjects.size()), 0 };
+        }
+    }
+
+    void D06GeometryShaders::drawSceneObjects(graphics::Material& material) const
+    {
+        for (size_t i = 0; i < sceneObjects.size(); ++i)
+        {
+            if (!visibleObjects[i])
+                continue;
+            const glm::mat4& ModelMatrix  = objectTransforms.GetModelMatrix(i);
+            const auto&      mesh_to_draw = meshes[sceneObjects[i].Model];
             for (const auto& sub_mesh : mesh_to_draw.SubMeshes)
             {
                 material.SetMaterialUniform(Uniforms::ModelMatrix, ModelMatrix);
-                material.ForceApplyAllSettings();
+                if (!material.ForceApplyAllSettings())
+                    continue;
                 sub_mesh.VertexArrayObj.Use();
                 GLDrawIndexed(sub_mesh.VertexArrayObj);
             }
@@ -295,6 +346,10 @@ namespace demos
         const std::array<const graphics::Geometry, ObjectModel::Count> geometries = { graphics::create_plane(stacks, slices),    graphics::create_cube(stacks, slices),
                                                                                       graphics::create_sphere(stacks, slices),   graphics::create_torus(stacks, slices),
                                                                                       graphics::create_cylinder(stacks, slices), graphics::create_cone(stacks, slices) };
+        for (size_t i = 0; i < geometries.size(); ++i)
+        {
+            modelBounds[i] = geometries[i].Sphere;
+        }
 
         meshes[ObjectModel::Plane].Name = "Plane";
         meshes[ObjectModel::Plane].SubMeshes.clear();
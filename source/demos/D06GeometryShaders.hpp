@@ -10,7 +10,9 @@
 
 #include "IDemo.hpp"
 #include "assets/Reloader.hpp"
+#include "graphics/Frustum.hpp"
 #include "graphics/Mesh.hpp"
+#include "graphics/TransformSystem.hpp"
 #include "opengl/GLShader.hpp"
 #include "opengl/GLTexture.hpp"
 #include <array>
@@ -74,6 +76,7 @@ namespace demos
         mutable std::array<graphics::Material, Materials::Count> materials;
         std::array<GLShader, Materials::Count>                   shaders;
         std::vector<SceneObject>                                 sceneObjects;
+        graphics::TransformSystem                                objectTransforms;
         glm::mat4                                                ProjectionMatrix{ 1.0f };
         glm::mat4                                                ViewMatrix{ 1.0f };
         glm::vec3                                                eyePosition{ 0.0f };
@@ -92,9 +95,16 @@ namespace demos
         bool              extrudeFlatly       = true;
         float             shrinkFactor        = 0.9f;
 
+        std::array<graphics::BoundingSphere, ObjectModel::Count> modelBounds;
+        graphics::FrustumCuller                                  frustumCuller;
+        std::vector<std::uint8_t>                                visibleObjects;
+        graphics::CullCounts                                     cullCounts;
+        bool                                                     frustumCulling = true;
+
     private:
         void setViewMatrix(glm::vec3 target_position, float distance = 1.5f);
-        void drawSceneObjects(const glm::mat4& r, graphics::Material& material) const;
+        void cullSceneObjects();
+        void drawSceneObjects(graphics::Material& material) const;
         void buildMeshes();
     };
 
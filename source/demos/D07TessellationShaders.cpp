@@ -128,12 +128,16 @@ namespace demos
                 {  LineSpacingOddShaderName,      { ParamsVertexPath, ParamsLineControlPath, ParamsLineSpacingOddEvalPath, PointsGeometryPath, Fill3DFragmentPath }},
             };
 
+            // submit every shader first so the driver can build them in parallel
             for (size_t i = 0; i < Materials::Count; ++i)
             {
                 const auto& setup = shader_setup[i];
                 const auto  paths = std::span{ setup.ShaderFilePaths };
                 assetReloader.SetAndAutoReloadShader(shaders[i], setup.ShaderName, paths);
-                materials[i]                 = graphics::Material(&shaders[i], setup.ShaderName + " Material"s);
+            }
+            for (size_t i = 0; i < Materials::Count; ++i)
+            {
+                materials[i]                 = graphics::Material(&shaders[i], shader_setup[i].ShaderName + " Material"s);
                 materials[i].Culling.Enabled = false;
             }
         }
@@ -180,7 +184,8 @@ namespace demos
         GL::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         GL::Enable(GL_PROGRAM_POINT_SIZE);
         const auto material_index = static_cast<Materials::Type>(int(shape) * int(Tessellation::SpacingCount) + int(spacing));
-        materials[material_index].ForceApplyAllSettings();
+        if (!materials[material_index].ForceApplyAllSettings())
+            return;
         
 #if !defined(OPENGL_ES3_ONLY)
         {
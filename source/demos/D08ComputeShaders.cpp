@@ -109,7 +109,8 @@ namespace demos
         GL::MemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 
 #endif
-        displayTextureMaterial.ForceApplyAllSettings();
+        if (!displayTextureMaterial.ForceApplyAllSettings())
+            return;
         quadMesh.VertexArrayObj.Use();
         GLDrawIndexed(quadMesh.VertexArrayObj);
     }
@@ -8,7 +8,11 @@
 #include "D09ValueNoise.hpp"
 
 #include "environment/Environment.hpp"
+#include "graphics/Color.hpp"
 #include "opengl/GL.hpp"
+#include "opengl/GLPixelUnpackRing.hpp"
+#include <array>
+#include <cmath>
 #include <glm/ext/matrix_clip_space.hpp> // perspective
 #include <imgui.h>
 
@@ -21,8 +25,12 @@ namespace
 
     namespace Uniforms
     {
-        const auto Projection = "uProjection"s;
-        const auto TileScale  = "uTileScale"s;
+        const auto Projection    = "uProjection"s;
+        const auto TileScale     = "uTileScale"s;
+        const auto PhysicalPages = "uPhysicalPages"s;
+        const auto PageTable     = "uPageTable"s;
+        const auto PagesPerSide  = "uPagesPerSide"s;
+        const auto SlotsPerSide  = "uSlotsPerSide"s;
 
     }
 
@@ -30,10 +38,41 @@ namespace
     {
         constexpr auto SimpleVertexPath   = "D09ValueNoise/simple.vert";
         constexpr auto SimpleFragmentPath = "D09ValueNoise/simple.frag";
+        constexpr auto VirtualFragmentPath = "D09ValueNoise/virtual.frag";
 
     }
 
-    GLTexture::RGBA vec4_to_rgba(const glm::vec4& color);
+    // which level and page of a virtual texture, as one number
+    constexpr std::uint64_t make_page_key(int level, int page_x, int page_y) noexcept
+    {
+        return (static_cast<std::uint64_t>(level) << 40) | (static_cast<std::uint64_t>(page_y) << 20) | static_cast<std::uint64_t>(page_x);
+    }
+
+    constexpr int page_key_level(std::uint64_t key) noexcept
+    {
+        return static_cast<int>(key >> 40);
+    }
+
+    constexpr int page_key_x(std::uint64_t key) noexcept
+    {
+        return static_cast<int>(key & 0xFFFFF);
+    }
+
+    constexpr int page_key_y(std::uint64_t key) noexcept
+    {
+        return static_cast<int>((key >> 20) & 0xFFFFF);
+    }
+
+    // page table texels say which cache slot holds the page, alpha marks it as there
+    constexpr GLTexture::RGBA page_table_entry(int slot_x, int slot_y) noexcept
+    {
+        return 0xFF000000u | (static_cast<GLTexture::RGBA>(slot_y) << 8) | static_cast<GLTexture::RGBA>(slot_x);
+    }
+
+    constexpr int wrap(int value, int size) noexcept
+    {
+        return ((value % size) + size) % size;
+    }
 
     bool is_close(float a, float b, float tolerance)
     {
@@ -56,6 +95,7 @@ namespace demos
         GL::ClearColor(0.392f, 0.584f, 0.929f, 1.0f);
 
         assetReloader.SetAndAutoReloadShader(displayTextureShader, "Display Texture Shader", { asset_paths::SimpleVertexPath, asset_paths::SimpleFragmentPath });
+        assetReloader.SetAndAutoReloadShader(virtualTextureShader, "Virtual Texture Shader", { asset_paths::SimpleVertexPath, asset_paths::VirtualFragmentPath });
         const auto texture_size = static_cast<size_t>(textureSize);
         colors.resize(texture_size * texture_size);
 
@@ -69,6 +109,12 @@ namespace demos
         displayTextureMaterial = graphics::Material(&displayTextureShader, "Full Screen Material");
         displayTextureMaterial.SetTextures({ &generatedTexture });
 
+        virtualTextureMaterial = graphics::Material(&virtualTextureShader, "Virtual Texture Material");
+        virtualTextureMaterial.SetTextures({ &virtualPages.physicalPages, &virtualPages.pageTableTexture });
+        // samplers are numbered in the order the driver reports them, so pin them to the order of the textures above
+        virtualTextureMaterial.SetMaterialUniform(Uniforms::PhysicalPages, 0);
+        virtualTextureMaterial.SetMaterialUniform(Uniforms::PageTable, 1);
+
         graphics::Geometry full_screen_geometry = graphics::create_plane(1, 1);
         for (auto& vert : full_screen_geometry.Vertices)
         {
@@ -85,15 +131,21 @@ namespace demos
         switch (generation.state)
         {
             case Generation::Setup:
-                generation.setup(*this);
+                if (useVirtualTexture)
+                {
+                    // pages are made on demand, so all there is to do is mark the ones we have as out of date
+                    generation.frequency = static_cast<float>(noisePeriod) / static_cast<float>(textureSize);
+                    virtualPages.invalidate();
+                    generation.state = Generation::Done;
+                }
+                else
+                {
+                    generation.setup(*this);
+                }
                 break;
             case Generation::Working:
                 generation.update(*this);
                 break;
-            case Generation::UploadNewTexture:
-                generatedTexture.UploadAsRGBA(colors.data());
-                generation.state = Generation::Done;
-                break;
             case Generation::Done:
                 break;
         }
@@ -110,14 +162,71 @@ namespace demos
         }
 
         assetReloader.Update();
-        displayTextureMaterial.SetMaterialUniform(Uniforms::Projection, orthoProjectionMatrix);
-        displayTextureMaterial.SetMaterialUniform(Uniforms::TileScale, tileScale);
+        if (useVirtualTexture)
+        {
+            virtualPages.update(*this);
+            virtualTextureMaterial.SetMaterialUniform(Uniforms::Projection, orthoProjectionMatrix);
+            virtualTextureMaterial.SetMaterialUniform(Uniforms::TileScale, tileScale);
+            virtualTextureMaterial.SetMaterialUniform(Uniforms::PagesPerSide, static_cast<float>(virtualPages.pagesPerSide));
+            virtualTextureMaterial.SetMaterialUniform(Uniforms::SlotsPerSide, static_cast<float>(virtualPages.slotsPerSide));
+        }
+        else
+        {
+            displayTextureMaterial.SetMaterialUniform(Uniforms::Projection, orthoProjectionMatrix);
+            displayTextureMaterial.SetMaterialUniform(Uniforms::TileScale, tileScale);
+        }
+    }
+
+    void D09ValueNoise::Simulate([[maybe_unused]] const SimulationStep& step)
+    {
+        simulation.timer.ResetTimeStamp();
+        simulation.generate_rows();
+        simulation.generate_pages();
+    }
+
+    void D09ValueNoise::PublishSimulation()
+    {
+        if (useVirtualTexture)
+        {
+            if (!colors.empty())
+            {
+                // the dense image isn't needed anymore, and Simulate() has stopped writing to it
+                simulation.start_rows(nullptr, 0, 0);
+                colors = {};
+            }
+            if (simulation.inputsVersion != virtualPages.version)
+            {
+                simulation.inputs        = make_noise_inputs();
+                simulation.inputsVersion = virtualPages.version;
+            }
+            virtualPages.hand_over_requests(simulation.pages);
+        }
+        else if (generation.needsStart)
+        {
+            generation.needsStart     = false;
+            generation.bandsGenerated = 0;
+            colors.resize(static_cast<size_t>(generation.width) * static_cast<size_t>(generation.height));
+            simulation.inputs = make_noise_inputs();
+            simulation.start_rows(colors.data(), generation.width, generation.height);
+        }
+        else if (generation.state == Generation::Working)
+        {
+            const bool is_finished    = simulation.rowsGenerated >= generation.height;
+            generation.bandsGenerated = is_finished ? generation.bandCount : simulation.rowsGenerated / Generation::BandRows;
+        }
+    }
+
+    D09ValueNoise::NoiseInputs D09ValueNoise::make_noise_inputs() const
+    {
+        return NoiseInputs{ noise, generation.frequency, generation.z, generation.noiseDimension, generation.pattern };
     }
 
     void D09ValueNoise::Draw() const
     {
         GL::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        displayTextureMaterial.ForceApplyAllSettings();
+        const auto& material = useVirtualTexture ? virtualTextureMaterial : displayTextureMaterial;
+        if (!material.ForceApplyAllSettings())
+            return;
         quadMesh.VertexArrayObj.Use();
         GLDrawIndexed(quadMesh.VertexArrayObj);
     }
@@ -160,12 +269,33 @@ namespace demos
                 generation.state = Generation::Setup;
             }
 
-            static const auto texture_sizes_info = []
+            if (ImGui::Checkbox("Virtual Texture", &useVirtualTexture))
+            {
+                if (useVirtualTexture)
+                {
+                    // the dense texture isn't needed anymore, PublishSimulation() lets go of the image once Simulate() is done with it
+                    generatedTexture = GLTexture{};
+                    textureSize      = std::max(textureSize, VirtualPages::PageTexels);
+                    virtualPages.create(textureSize);
+                }
+                else
+                {
+                    virtualPages.destroy();
+                    textureSize = std::min(textureSize, environment::opengl::MaxTextureSize);
+                    if (const bool loaded = generatedTexture.LoadAsRGBA(textureSize, textureSize); loaded)
+                    {
+                        generatedTexture.SetFiltering(GLTexture::Linear);
+                    }
+                }
+                generation.state = Generation::Setup;
+            }
+
+            const auto make_texture_sizes_info = [](int largest_size, int smallest_size)
             {
                 std::vector<int> sizes;
                 std::string      names;
-                int              size = environment::opengl::MaxTextureSize;
-                while (size >= 64)
+                int              size = largest_size;
+                while (size >= smallest_size)
                 {
                     sizes.push_back(size);
                     names += std::to_string(size);
@@ -174,15 +304,24 @@ namespace demos
                 }
                 names += '\0';
                 return std::make_tuple(sizes, names);
-            }();
-            const auto& [texture_sizes, texture_sizes_string] = texture_sizes_info;
+            };
+            static const auto texture_sizes_info         = make_texture_sizes_info(environment::opengl::MaxTextureSize, 64);
+            // a virtual texture isn't limited by the GPU
+            static const auto virtual_texture_sizes_info = make_texture_sizes_info(1 << 20, VirtualPages::PageTexels);
+
+            const auto& [texture_sizes, texture_sizes_string] = useVirtualTexture ? virtual_texture_sizes_info : texture_sizes_info;
             {
                 const auto size_itr       = std::find(std::begin(texture_sizes), std::end(texture_sizes), textureSize);
                 int        width_location = (size_itr != std::end(texture_sizes)) ? static_cast<int>(std::distance(std::begin(texture_sizes), size_itr)) : 0;
                 if (ImGui::Combo("Texture Dimensions", &width_location, texture_sizes_string.c_str()))
                 {
                     const int new_size = texture_sizes[static_cast<size_t>(width_location)];
-                    if (GLTexture new_one; new_one.LoadAsRGBA(new_size, new_size))
+                    if (useVirtualTexture)
+                    {
+                        textureSize = new_size;
+                        virtualPages.create(textureSize);
+                    }
+                    else if (GLTexture new_one; new_one.LoadAsRGBA(new_size, new_size))
                     {
                         textureSize      = new_size;
                         generatedTexture = std::move(new_one);
@@ -191,6 +330,12 @@ namespace demos
                 }
             }
 
+            if (useVirtualTexture)
+            {
+                ImGui::Text("Level %d, %d pages across", virtualPages.level, virtualPages.pagesPerSide);
+                ImGui::Text("%d of %d cache slots used, %d pages made last frame", static_cast<int>(virtualPages.residentSlots.size()), static_cast<int>(virtualPages.slots.size()), virtualPages.pagesGeneratedLastFrame);
+            }
+
 
             ImGui::SliderFloat("Tiling Scale", &targetTileScale.x, 0.1f, 3.0f);
             switch (generation.noiseDimension)
@@ -208,7 +353,7 @@ namespace demos
             if (ImGui::Combo("Noise Dimension", reinterpret_cast<int*>(&generation.noiseDimension), dimension_type_names))
             {
                 generation.state = Generation::Setup;
-                if (GLTexture new_one; new_one.LoadAsRGBA(textureSize, textureSize))
+                if (GLTexture new_one; !useVirtualTexture && new_one.LoadAsRGBA(textureSize, textureSize))
                 {
                     generatedTexture = std::move(new_one);
                 }
@@ -283,18 +428,7 @@ namespace demos
 
     void D09ValueNoise::Generation::setup(D09ValueNoise& demo)
     {
-        const auto texture_size = static_cast<size_t>(demo.textureSize);
-        demo.colors.resize(texture_size * texture_size);
         frequency = static_cast<float>(demo.noisePeriod) / static_cast<float>(demo.textureSize);
-        xyInputValues.resize(texture_size);
-        for (column = 0; column < demo.textureSize; ++column)
-        {
-            const float x                              = static_cast<float>(column) * frequency;
-            xyInputValues[static_cast<size_t>(column)] = x;
-        }
-        the_colors = demo.colors.data();
-        row = 0, column = 0;
-        y = 0;
         switch (noiseDimension)
         {
             case Dimension::_1D:
@@ -306,68 +440,309 @@ namespace demos
                 width = height = demo.textureSize;
                 break;
         }
-        state = Generation::Working;
-        if constexpr (environment::CanUseThreads)
-        {
-            jobSystem.DoJobs(width * height, [this, &demo](int index)
-                             {
-                                 const int   r     = index / width;
-                                 const int   c     = index % width;
-                                 const float the_x = xyInputValues[static_cast<size_t>(c)];
-                                 const float the_y = xyInputValues[static_cast<size_t>(r)];
-                                 the_colors[index] = get_color(demo.noise, the_x, the_y, z);
-                                 //
-                             });
+        bandCount      = (height + BandRows - 1) / BandRows;
+        bandsGenerated = 0;
+        bandsUploaded  = 0;
+        needsStart     = true;
+        state          = Generation::Working;
+    }
+
+    void D09ValueNoise::Generation::update(D09ValueNoise& demo)
+    {
+        if (needsStart)
+            return;
+
+        // about one lap of the texture's upload ring per frame, so the frame never waits long on the GPU
+        constexpr size_t MAX_BYTES_PER_FRAME = GLPixelUnpackRing::SlotCount * static_cast<size_t>(GLPixelUnpackRing::SlotSizeBytes);
+        const size_t     band_bytes          = static_cast<size_t>(width) * BandRows * sizeof(GLTexture::RGBA);
+        size_t           bytes_uploaded      = 0;
+        // Simulate() is still writing the rows after bandsGenerated, never the ones before
+        for (; bandsUploaded < bandsGenerated && bytes_uploaded < MAX_BYTES_PER_FRAME; ++bandsUploaded)
+        {
+            const int first_row = bandsUploaded * BandRows;
+            const int rows      = std::min(BandRows, height - first_row);
+            demo.generatedTexture.UploadRegion(0, first_row, width, rows, demo.colors.data() + static_cast<size_t>(first_row) * static_cast<size_t>(width));
+            bytes_uploaded += band_bytes;
+        }
+        if (bandsUploaded == bandCount)
+        {
+            state = Generation::Done;
+        }
+    }
+
+    void D09ValueNoise::NoiseSimulation::start_rows(GLTexture::RGBA* the_pixels, int the_width, int the_height)
+    {
+        pixels        = the_pixels;
+        width         = the_width;
+        height        = the_height;
+        rowsGenerated = 0;
+        xyInputValues.resize(static_cast<size_t>(std::max(width, height)));
+        for (size_t i = 0; i < xyInputValues.size(); ++i)
+        {
+            xyInputValues[i] = static_cast<float>(i) * inputs.frequency;
+        }
+    }
+
+    void D09ValueNoise::NoiseSimulation::generate_rows()
+    {
+        while (rowsGenerated < height && timer.GetElapsedSeconds() < TimeBudget)
+        {
+            const int first_row = rowsGenerated;
+            const int rows      = std::min(RowsPerBatch, height - first_row);
+            jobSystem.DoJobsAndWait(rows,
+                                    [this, first_row](int index)
+                                    {
+                                        const int        row        = first_row + index;
+                                        const float      the_y      = xyInputValues[static_cast<size_t>(row)];
+                                        GLTexture::RGBA* row_pixels = pixels + static_cast<size_t>(row) * static_cast<size_t>(width);
+                                        for (int column = 0; column < width; ++column)
+                                        {
+                                            row_pixels[column] = inputs.get_color(xyInputValues[static_cast<size_t>(column)], the_y, inputs.z);
+                                        }
+                                    });
+            rowsGenerated += rows;
         }
     }
 
-    void D09ValueNoise::Generation::update([[maybe_unused]] const D09ValueNoise& demo)
+    void D09ValueNoise::VirtualPages::create(int logical_size)
     {
-        if constexpr (environment::CanUseThreads)
+        logicalSize            = logical_size;
+        slotsPerSide           = std::min(MaxSlotsPerSide, environment::opengl::MaxTextureSize / SlotTexels);
+        const int cache_texels = slotsPerSide * SlotTexels;
+        if (physicalPages.GetWidth() != cache_texels)
         {
-            if (jobSystem.IsDone())
+            if (const bool loaded = physicalPages.LoadAsRGBA(cache_texels, cache_texels); !loaded)
             {
-                state = Generation::UploadNewTexture;
+                throw std::runtime_error{ "Failed to create the virtual texture page cache in D09ValueNoise" };
             }
+            physicalPages.SetFiltering(GLTexture::Linear);
+            physicalPages.SetWrapping(GLTexture::ClampToEdge);
         }
-        else
+        slots.assign(static_cast<size_t>(slotsPerSide * slotsPerSide), Slot{});
+        residentSlots.clear();
+        pagesInFlight.clear();
+        finishedPages.generated = 0;
+        level                   = -1;
+        pagesPerSide            = 0;
+        createdVersion          = ++version;
+    }
+
+    void D09ValueNoise::VirtualPages::destroy()
+    {
+        physicalPages    = GLTexture{};
+        pageTableTexture = GLTexture{};
+        slots            = {};
+        residentSlots    = {};
+        pageTable        = {};
+        requests         = {};
+        pagesInFlight    = {};
+        finishedPages    = {};
+        level            = -1;
+        pagesPerSide     = 0;
+    }
+
+    void D09ValueNoise::VirtualPages::invalidate() noexcept
+    {
+        ++version;
+    }
+
+    void D09ValueNoise::VirtualPages::update(D09ValueNoise& demo)
+    {
+        ++frame;
+        pagesGeneratedLastFrame = 0;
+        if (slots.empty())
+            return;
+
+        // the quad is a square as tall as the shorter side of the window, so every pixel covers the same number of texels
+        // and one level is right for all of them
+        const int   quad_pixels      = std::max(1, std::min(environment::DisplayWidth, environment::DisplayHeight));
+        const float texels_per_pixel = static_cast<float>(logicalSize) * std::max(demo.tileScale.x, 1e-3f) / static_cast<float>(quad_pixels);
+        int         max_level        = 0;
+        while (((logicalSize / PageTexels) >> max_level) > 1)
+            ++max_level;
+        const int wanted_level = std::clamp(static_cast<int>(std::ceil(std::log2(texels_per_pixel))), 0, max_level);
+        if (wanted_level != level)
+        {
+            set_level(wanted_level);
+        }
+
+        // the quad shows texture coordinates 0 to tileScale, wrapping around past 1
+        const int pages_x = std::min(pagesPerSide, static_cast<int>(demo.tileScale.x * static_cast<float>(pagesPerSide)) + 1);
+        const int pages_y = std::min(pagesPerSide, static_cast<int>(demo.tileScale.y * static_cast<float>(pagesPerSide)) + 1);
+        place_finished_pages();
+
+        // pages Simulate() is still working on aren't asked for again
+        const auto is_in_flight = [this](std::uint64_t key) { return std::find(std::begin(pagesInFlight), std::end(pagesInFlight), key) != std::end(pagesInFlight); };
+        requests.clear();
+        for (int page_y = 0; page_y < pages_y; ++page_y)
+        {
+            for (int page_x = 0; page_x < pages_x; ++page_x)
+            {
+                const auto key = make_page_key(level, page_x, page_y);
+                if (const auto found = residentSlots.find(key); found != residentSlots.end())
+                    slots[static_cast<size_t>(found->second)].LastUsedFrame = frame;
+                else if (!is_in_flight(key))
+                    requests.push_back(key);
+            }
+        }
+        // out of date pages are still shown until they are redone, so the missing ones go first
+        for (int page_y = 0; page_y < pages_y; ++page_y)
+        {
+            for (int page_x = 0; page_x < pages_x; ++page_x)
+            {
+                const auto key = make_page_key(level, page_x, page_y);
+                if (const auto found = residentSlots.find(key); found != residentSlots.end() && slots[static_cast<size_t>(found->second)].Version != version && !is_in_flight(key))
+                    requests.push_back(key);
+            }
+        }
+        requests.resize(std::min(requests.size(), static_cast<size_t>(MaxPagesAsked)));
+
+        if (pageTableIsDirty)
+        {
+            pageTableTexture.UploadAsRGBA(pageTable.data());
+            pageTableIsDirty = false;
+        }
+    }
+
+    void D09ValueNoise::VirtualPages::set_level(int new_level)
+    {
+        level        = new_level;
+        pagesPerSide = std::max(1, (logicalSize / PageTexels) >> level);
+        pageTable.assign(static_cast<size_t>(pagesPerSide * pagesPerSide), 0);
+        for (const auto& [key, slot] : residentSlots)
+        {
+            if (page_key_level(key) == level)
+            {
+                pageTable[static_cast<size_t>(page_key_y(key) * pagesPerSide + page_key_x(key))] = page_table_entry(slot % slotsPerSide, slot / slotsPerSide);
+            }
+        }
+        if (const bool loaded = pageTableTexture.LoadFromMemory(pagesPerSide, pagesPerSide, pageTable.data()); !loaded)
+        {
+            throw std::runtime_error{ "Failed to create the virtual texture page table in D09ValueNoise" };
+        }
+        pageTableIsDirty = false;
+    }
+
+    int D09ValueNoise::VirtualPages::find_slot_to_use() const
+    {
+        // an empty slot, otherwise the one that has gone unseen the longest
+        int oldest = -1;
+        for (int i = 0; i < static_cast<int>(slots.size()); ++i)
         {
-            timer.ResetTimeStamp();
-            while (timer.GetElapsedSeconds() < 1.0 / 32.0)
+            const auto& slot = slots[static_cast<size_t>(i)];
+            if (!slot.HoldsPage)
+                return i;
+            if (slot.LastUsedFrame != frame && (oldest < 0 || slot.LastUsedFrame < slots[static_cast<size_t>(oldest)].LastUsedFrame))
+                oldest = i;
+        }
+        return oldest;
+    }
+
+    void D09ValueNoise::VirtualPages::place_finished_pages()
+    {
+        if (finishedPages.version < createdVersion)
+        {
+            // made for a cache that has since been recreated
+            finishedPages.generated = 0;
+        }
+        for (int page = 0; page < finishedPages.generated; ++page)
+        {
+            const auto key        = finishedPages.keys[static_cast<size_t>(page)];
+            int        slot_index = -1;
+            if (const auto found = residentSlots.find(key); found != residentSlots.end())
             {
-                const float x = xyInputValues[static_cast<size_t>(column)];
-                *the_colors   = get_color(demo.noise, x, y, z);
-                ++the_colors;
-                ++column;
-                if (column >= width)
+                slot_index = found->second;
+            }
+            else
+            {
+                slot_index = find_slot_to_use();
+                if (slot_index < 0)
+                    break; // every slot holds a visible page
+                auto& slot = slots[static_cast<size_t>(slot_index)];
+                if (slot.HoldsPage)
                 {
-                    ++row;
-                    column = 0;
-                    if (row >= height)
+                    residentSlots.erase(slot.Key);
+                    if (page_key_level(slot.Key) == level)
                     {
-                        state = Generation::UploadNewTexture;
-                        break;
+                        pageTable[static_cast<size_t>(page_key_y(slot.Key) * pagesPerSide + page_key_x(slot.Key))] = 0;
+                        pageTableIsDirty = true;
                     }
+                }
+                residentSlots[key] = slot_index;
+            }
+            slots[static_cast<size_t>(slot_index)] = Slot{ key, finishedPages.version, frame, true };
 
-                    y = xyInputValues[static_cast<size_t>(row)];
+            const int slot_x = slot_index % slotsPerSide;
+            const int slot_y = slot_index / slotsPerSide;
+            physicalPages.UploadRegion(slot_x * SlotTexels, slot_y * SlotTexels, SlotTexels, SlotTexels, finishedPages.texels.data() + page * SlotTexels * SlotTexels);
+            if (page_key_level(key) == level)
+            {
+                pageTable[static_cast<size_t>(page_key_y(key) * pagesPerSide + page_key_x(key))] = page_table_entry(slot_x, slot_y);
+                pageTableIsDirty                                                               = true;
+            }
+            ++pagesGeneratedLastFrame;
+        }
+        finishedPages.generated = 0;
+    }
 
-                }
+    void D09ValueNoise::VirtualPages::hand_over_requests(Batch& simulated_pages)
+    {
+        // the pages Simulate() made come back to be placed by the next update(), this frame's requests go out
+        std::swap(finishedPages, simulated_pages);
+        simulated_pages.keys        = requests;
+        simulated_pages.texels.resize(requests.size() * static_cast<size_t>(SlotTexels * SlotTexels));
+        simulated_pages.version     = version;
+        simulated_pages.logicalSize = logicalSize;
+        simulated_pages.generated   = 0;
+        pagesInFlight               = requests;
+        requests.clear();
+    }
+
+    void D09ValueNoise::NoiseSimulation::generate_pages()
+    {
+        // one job per row of a page, border included
+        const auto generate_row = [this](int index)
+        {
+            const int        page       = index / VirtualPages::SlotTexels;
+            const int        row        = index % VirtualPages::SlotTexels;
+            const auto       key        = pages.keys[static_cast<size_t>(page)];
+            const int        page_level = page_key_level(key);
+            const int        level_size = std::max(1, (pages.logicalSize / VirtualPages::PageTexels) >> page_level) * VirtualPages::PageTexels;
+            const int        step       = 1 << page_level;
+            GLTexture::RGBA* row_pixels = pages.texels.data() + (page * VirtualPages::SlotTexels + row) * VirtualPages::SlotTexels;
+            // the border texels come from the neighbouring pages, wrapping around the edges like the texture does
+            const int   texel_y = wrap(page_key_y(key) * VirtualPages::PageTexels + row - 1, level_size);
+            const float the_y   = static_cast<float>(texel_y * step) * inputs.frequency;
+            for (int column = 0; column < VirtualPages::SlotTexels; ++column)
+            {
+                const int   texel_x = wrap(page_key_x(key) * VirtualPages::PageTexels + column - 1, level_size);
+                const float the_x   = static_cast<float>(texel_x * step) * inputs.frequency;
+                row_pixels[column]  = inputs.get_color(the_x, the_y, inputs.z);
             }
+        };
+
+        const int page_count = static_cast<int>(pages.keys.size());
+        while (pages.generated < page_count && timer.GetElapsedSeconds() < TimeBudget)
+        {
+            const int first_page = pages.generated;
+            const int count      = std::min(VirtualPages::PagesPerBatch, page_count - first_page);
+            jobSystem.DoJobsAndWait(count * VirtualPages::SlotTexels, [&](int index) { generate_row(first_page * VirtualPages::SlotTexels + index); });
+            pages.generated += count;
         }
     }
 
-    GLTexture::RGBA D09ValueNoise::Generation::get_color(const graphics::noise::ValueNoise<glm::vec4>& the_noise, float the_x, float the_y, float the_z) const
+    GLTexture::RGBA D09ValueNoise::NoiseInputs::get_color(float the_x, float the_y, float the_z) const
     {
         const auto eval = [&]()
         {
             switch (noiseDimension)
             {
                 case Dimension::_1D:
-                    return the_noise.Evaluate(the_x);
+                    return noise.Evaluate(the_x);
                 case Dimension::_2D:
-                    return the_noise.Evaluate(the_x, the_y);
+                    return noise.Evaluate(the_x, the_y);
                 default:
-                    return the_noise.Evaluate(the_x, the_y, the_z);
+                    return noise.Evaluate(the_x, the_y, the_z);
             }
         };
 
@@ -391,7 +766,7 @@ namespace demos
                         amplitude *= gain;
                     }
                 }
-                return vec4_to_rgba(noise_result);
+                return graphics::vec4_to_rgba(noise_result);
             case Pattern::Turbulence:
                 {
                     float amplitude = 0.5f;
@@ -405,7 +780,7 @@ namespace demos
                         amplitude *= gain;
                     }
                 }
-                return vec4_to_rgba(noise_result);
+                return graphics::vec4_to_rgba(noise_result);
             case Pattern::Marble:
                 {
                     float       amplitude  = 0.5f;
@@ -422,29 +797,16 @@ namespace demos
                     constexpr float MY_PI = 3.1415926535897932384626433832795028f;
                     noise_result          = (glm::sin((the_column + noise_result * 100.f) * 2.f * MY_PI / 200.f) + 1.f) / 2.f;
                 }
-                return vec4_to_rgba(noise_result);
+                return graphics::vec4_to_rgba(noise_result);
             case Pattern::Wood:
                 {
                     noise_result = 10.f * eval();
                     noise_result -= glm::floor(noise_result);
                 }
-                return vec4_to_rgba(noise_result);
+                return graphics::vec4_to_rgba(noise_result);
             case Pattern::PlainValue:
             default:
-                return vec4_to_rgba(eval());
+                return graphics::vec4_to_rgba(eval());
         }
     }
 }
-
-namespace
-{
-    GLTexture::RGBA vec4_to_rgba(const glm::vec4& color)
-    {
-        const auto            r    = static_cast<unsigned int>(std::clamp(color.r, 0.0f, 1.0f) * 255.0f);
-        const auto            g    = static_cast<unsigned int>(std::clamp(color.g, 0.0f, 1.0f) * 255.0f);
-        const auto            b    = static_cast<unsigned int>(std::clamp(color.b, 0.0f, 1.0f) * 255.0f);
-        const auto            a    = static_cast<unsigned int>(std::clamp(color.a, 0.0f, 1.0f) * 255.0f);
-        const GLTexture::RGBA rgba = (a << 24) | (b << 16) | (g << 8) | r;
-        return rgba;
-    }
-}
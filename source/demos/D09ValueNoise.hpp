@@ -13,6 +13,8 @@
 #include "graphics/noise/ValueNoise.hpp"
 #include "opengl/GLShader.hpp"
 #include "opengl/GLTexture.hpp"
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 #include "util/JobSystem.hpp"
@@ -26,6 +28,8 @@ namespace demos
         D09ValueNoise();
 
         void Update() override;
+        void Simulate(const SimulationStep& step) override;
+        void PublishSimulation() override;
 
         void Draw() const override;
         void ImGuiDraw() override;
@@ -37,6 +41,9 @@ namespace demos
         glm::mat4                              orthoProjectionMatrix{};
         GLShader                               displayTextureShader;
         graphics::Material                     displayTextureMaterial;
+        GLShader                               virtualTextureShader;
+        graphics::Material                     virtualTextureMaterial;
+        bool                                   useVirtualTexture = false;
         graphics::SubMesh                      quadMesh;
         int                                    textureSize = 2048;
         GLTexture                              generatedTexture;
@@ -82,35 +89,126 @@ namespace demos
             };
         };
 
+        // Everything a texel's color depends on. Simulate() works from its own copy, so the ImGui can keep changing the demo's
+        struct NoiseInputs
+        {
+            graphics::noise::ValueNoise<glm::vec4> noise{ graphics::noise::PeriodDimension::_64 };
+            float                                  frequency      = 1;
+            float                                  z              = 0;
+            Dimension::Type                        noiseDimension = Dimension::_2D;
+            Pattern::Type                          pattern        = Pattern::PlainValue;
+
+            GLTexture::RGBA get_color(float the_x, float the_y, float the_z) const;
+        };
+
         struct Generation
         {
             enum State
             {
                 Setup,
-                Working,
-                UploadNewTexture,
+                Working, // Simulate() generates bands of rows, the finished ones get uploaded
                 Done
             } state = Done;
 
-            std::vector<float> xyInputValues;
-            float              frequency      = 1;
-            int                column         = 0;
-            int                row            = 0;
-            int                width          = 0;
-            int                height         = 0;
-            float              z              = 0;
-            float              y              = 0;
-            Dimension::Type    noiseDimension = Dimension::_2D;
-            Pattern::Type      pattern        = Pattern::PlainValue;
-            GLTexture::RGBA*   the_colors     = nullptr;
-            util::Timer        timer;
-            util::JobSystem    jobSystem;
-
-
-            void            setup(D09ValueNoise& demo);
-            void            update(const D09ValueNoise& demo);
-            GLTexture::RGBA get_color(const graphics::noise::ValueNoise<glm::vec4>& the_noise, float the_x, float the_y, float the_z) const;
+            // rows are generated and uploaded in bands, so the texture fills in while the rest is still being worked on
+            static constexpr int BandRows = 64;
+
+            float           frequency      = 1;
+            int             width          = 0;
+            int             height         = 0;
+            float           z              = 0;
+            Dimension::Type noiseDimension = Dimension::_2D;
+            Pattern::Type   pattern        = Pattern::PlainValue;
+            int             bandCount      = 0;
+            int             bandsGenerated = 0; // as of the last PublishSimulation()
+            int             bandsUploaded  = 0;
+            bool            needsStart     = false; // the next PublishSimulation() hands the job to Simulate()
+
+
+            void setup(D09ValueNoise& demo);
+            void update(D09ValueNoise& demo);
         } generation;
+
+        // Virtual texture mode: textureSize is only a logical size. The visible part of the texture is generated a page at a time,
+        // at the one mip level that matches the screen, into a fixed size cache texture. A page table texture tells the shader
+        // which cache slot holds which page, so memory stays the same whatever the logical size is.
+        struct VirtualPages
+        {
+            static constexpr int PageTexels      = 128;
+            static constexpr int SlotTexels      = PageTexels + 2; // one texel border on each side so linear filtering stays inside the slot
+            static constexpr int MaxSlotsPerSide = 24;
+            static constexpr int PagesPerBatch   = 16;
+            static constexpr int MaxPagesAsked   = 4 * PagesPerBatch; // per frame
+
+            struct Slot
+            {
+                std::uint64_t Key           = 0;
+                unsigned      Version       = 0; // pages generated before the noise settings last changed get redone
+                unsigned      LastUsedFrame = 0;
+                bool          HoldsPage     = false;
+            };
+
+            // Pages for Simulate() to make, and the texels it made for them
+            struct Batch
+            {
+                std::vector<std::uint64_t>   keys;
+                std::vector<GLTexture::RGBA> texels; // SlotTexels * SlotTexels for each key, border included
+                unsigned                     version     = 0;
+                int                          logicalSize = 0;
+                int                          generated   = 0; // how many of the keys, from the front, have their texels
+            };
+
+            GLTexture                              physicalPages;
+            GLTexture                              pageTableTexture;
+            std::vector<Slot>                      slots;
+            std::unordered_map<std::uint64_t, int> residentSlots;
+            std::vector<GLTexture::RGBA>           pageTable; // entries for the current level
+            std::vector<std::uint64_t>             requests;
+            std::vector<std::uint64_t>             pagesInFlight; // handed to Simulate() and not back yet
+            Batch                                  finishedPages;
+            int                                    slotsPerSide            = 0;
+            int                                    logicalSize             = 0;
+            int                                    level                   = -1;
+            int                                    pagesPerSide            = 0;
+            unsigned                               version                 = 1;
+            unsigned                               createdVersion          = 1; // pages made for an older cache are thrown away
+            unsigned                               frame                   = 0;
+            int                                    pagesGeneratedLastFrame = 0;
+            bool                                   pageTableIsDirty        = false;
+
+            void create(int logical_size);
+            void destroy();
+            void invalidate() noexcept;
+            void update(D09ValueNoise& demo);
+            void set_level(int new_level);
+            int  find_slot_to_use() const;
+            void place_finished_pages();
+            void hand_over_requests(Batch& simulated_pages);
+        } virtualPages;
+
+        // Only Simulate() touches this between PublishSimulation() calls, which is when jobs and results change hands
+        struct NoiseSimulation
+        {
+            static constexpr double TimeBudget   = 1.0 / 240.0; // per step
+            static constexpr int    RowsPerBatch = 16;
+
+            NoiseInputs           inputs;
+            unsigned              inputsVersion = 0;
+            GLTexture::RGBA*      pixels        = nullptr; // the dense texture's rows go straight into the demo's colors
+            std::vector<float>    xyInputValues;
+            int                   width         = 0;
+            int                   height        = 0;
+            int                   rowsGenerated = 0;
+            VirtualPages::Batch   pages;
+            util::Timer           timer;
+            util::JobSystem       jobSystem;
+
+            void start_rows(GLTexture::RGBA* the_pixels, int the_width, int the_height);
+            void generate_rows();
+            void generate_pages();
+        } simulation;
+
+        [[nodiscard]] NoiseInputs make_noise_inputs() const;
     };
 
 
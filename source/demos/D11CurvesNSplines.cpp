@@ -46,29 +46,16 @@ namespace demos
         controlPoints = initialControlPoints;
         tangents      = initialTangents;
 
-        UpdateCurves();
+        // the first curves are built right away, later ones by Simulate()
+        CurveGeometry curves;
+        BuildCurves(CurveInputs{ controlPoints, tangents, samples, tangentLength }, curves);
+        UploadCurves(curves);
 
         GLAttributeLayout posAttr;
         GLAttributeLayout colAttr;
         GLAttributeLayout uvAttr;
         graphics::describe_meshvertex_layout(posAttr, colAttr, uvAttr);
 
-        hermiteMesh.SetPrimitivePattern(GLPrimitive::Lines);
-        hermiteMesh.AddVertexBuffer(GLVertexBuffer(std::span{ hermiteVertices }), { posAttr, colAttr, uvAttr });
-        hermiteMesh.SetIndexBuffer(GLIndexBuffer(std::span{ hermiteIndices }));
-
-        catmullMesh.SetPrimitivePattern(GLPrimitive::Lines);
-        catmullMesh.AddVertexBuffer(GLVertexBuffer(std::span{ catmullVertices }), { posAttr, colAttr, uvAttr });
-        catmullMesh.SetIndexBuffer(GLIndexBuffer(std::span{ catmullIndices }));
-
-        tangentMesh.SetPrimitivePattern(GLPrimitive::Lines);
-        tangentMesh.AddVertexBuffer(GLVertexBuffer(std::span{ tangentVertices }), { posAttr, colAttr, uvAttr });
-        tangentMesh.SetIndexBuffer(GLIndexBuffer(std::span{ tangentIndices }));
-
-        assert(shader.IsValidWithVertexArrayObject(hermiteMesh.GetHandle()));
-        assert(shader.IsValidWithVertexArrayObject(catmullMesh.GetHandle()));
-        assert(shader.IsValidWithVertexArrayObject(tangentMesh.GetHandle()));
-
         auto circleGeometry = graphics::create_circle(32);
         circleMesh.SetPrimitivePattern(GLPrimitive::Triangles);
         circleMesh.AddVertexBuffer(GLVertexBuffer(std::span{ circleGeometry.Vertices }), { posAttr, colAttr, uvAttr });
@@ -79,6 +66,36 @@ namespace demos
     {
         assetReloader.Update();
         HandleInput();
+        if (hasPublishedCurves)
+        {
+            UploadCurves(publishedCurves);
+            hasPublishedCurves = false;
+        }
+    }
+
+    void D11CurvesNSplines::Simulate([[maybe_unused]] const SimulationStep& step)
+    {
+        if (!hasSimulationInputs)
+            return;
+        BuildCurves(simulationInputs, simulatedCurves);
+        hasSimulationInputs = false;
+        hasSimulatedCurves  = true;
+    }
+
+    void D11CurvesNSplines::PublishSimulation()
+    {
+        if (hasSimulatedCurves)
+        {
+            std::swap(publishedCurves, simulatedCurves);
+            hasSimulatedCurves = false;
+            hasPublishedCurves = true;
+        }
+        if (curvesChanged)
+        {
+            simulationInputs    = CurveInputs{ controlPoints, tangents, samples, tangentLength };
+            hasSimulationInputs = true;
+            curvesChanged       = false;
+        }
     }
 
     void D11CurvesNSplines::HandleInput()
@@ -94,22 +111,24 @@ namespace demos
             if (std::find(PressedKeyboardButtons.begin(), PressedKeyboardButtons.end(), KeyboardButtons::W) != PressedKeyboardButtons.end())
             {
                 controlPoints[index].y += moveSpeed;
+                curvesChanged = true;
             }
             if (std::find(PressedKeyboardButtons.begin(), PressedKeyboardButtons.end(), KeyboardButtons::S) != PressedKeyboardButtons.end())
             {
                 controlPoints[index].y -= moveSpeed;
+                curvesChanged = true;
             }
             if (std::find(PressedKeyboardButtons.begin(), PressedKeyboardButtons.end(), KeyboardButtons::A) != PressedKeyboardButtons.end())
             {
                 controlPoints[index].x -= moveSpeed;
+                curvesChanged = true;
             }
             if (std::find(PressedKeyboardButtons.begin(), PressedKeyboardButtons.end(), KeyboardButtons::D) != PressedKeyboardButtons.end())
             {
                 controlPoints[index].x += moveSpeed;
+                curvesChanged = true;
             }
         }
-
-        UpdateCurves();
     }
 
     void D11CurvesNSplines::Draw() const
@@ -196,8 +215,7 @@ namespace demos
         {
             controlPoints.emplace_back(0.0f, 0.0f, 0.0f);
             tangents.emplace_back(1.0f, 0.0f, 0.0f);
-
-            UpdateCurves();
+            curvesChanged = true;
         }
 
         if (ImGui::Button("Reset Points"))
@@ -205,73 +223,80 @@ namespace demos
             controlPoints      = initialControlPoints;
             tangents           = initialTangents;
             selectedPointIndex = -1;
-            UpdateCurves();
+            curvesChanged      = true;
         }
 
-        ImGui::SliderInt("Samples", &samples, 0, 100);
+        if (ImGui::SliderInt("Samples", &samples, 0, 100))
+        {
+            curvesChanged = true;
+        }
 
         // Add zoom slider
         ImGui::SliderFloat("Zoom", &zoomLevel, 1.0f, 90.0f, "%.1f");
-
-        UpdateCurves();
     }
 
-    void D11CurvesNSplines::UpdateCurves()
+    void D11CurvesNSplines::BuildCurves(const CurveInputs& inputs, CurveGeometry& geometry)
     {
-        auto hermiteCurve     = graphics::generateHermiteCurve(controlPoints, tangents, samples);
-        auto catmullRomSpline = graphics::generateCatmullRomSpline(controlPoints, samples);
+        const auto hermiteCurve     = graphics::generateHermiteCurve(inputs.ControlPoints, inputs.Tangents, inputs.Samples);
+        const auto catmullRomSpline = graphics::generateCatmullRomSpline(inputs.ControlPoints, inputs.Samples);
 
-        hermiteVertices.clear();
-        hermiteIndices.clear();
+        auto& hermite = geometry.Hermite;
+        hermite.Vertices.clear();
+        hermite.Indices.clear();
         for (unsigned i = 0; i < hermiteCurve.size(); ++i)
         {
-            hermiteVertices.push_back({ hermiteCurve[i], glm::vec3(1.0f, 0.0f, 0.0f), glm::vec2(0.0f) });
+            hermite.Vertices.push_back({ hermiteCurve[i], glm::vec3(1.0f, 0.0f, 0.0f), glm::vec2(0.0f) });
             if (i > 0)
             {
-                hermiteIndices.push_back(i - 1);
-                hermiteIndices.push_back(i);
+                hermite.Indices.push_back(i - 1);
+                hermite.Indices.push_back(i);
             }
         }
 
-        catmullVertices.clear();
-        catmullIndices.clear();
+        auto& catmull = geometry.Catmull;
+        catmull.Vertices.clear();
+        catmull.Indices.clear();
         for (unsigned i = 0; i < catmullRomSpline.size(); ++i)
         {
-            catmullVertices.push_back({ catmullRomSpline[i], glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f) });
+            catmull.Vertices.push_back({ catmullRomSpline[i], glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f) });
             if (i > 0)
             {
-                catmullIndices.push_back(i - 1);
-                catmullIndices.push_back(i);
+                catmull.Indices.push_back(i - 1);
+                catmull.Indices.push_back(i);
             }
         }
 
-        tangentVertices.clear();
-        tangentIndices.clear();
-        for (size_t i = 0; i < controlPoints.size(); ++i)
+        auto& tangent = geometry.Tangents;
+        tangent.Vertices.clear();
+        tangent.Indices.clear();
+        for (size_t i = 0; i < inputs.ControlPoints.size(); ++i)
         {
-            tangentVertices.push_back({ controlPoints[i], glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f) });
-            tangentVertices.push_back({ controlPoints[i] + tangents[i] * tangentLength, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f) });
+            tangent.Vertices.push_back({ inputs.ControlPoints[i], glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f) });
+            tangent.Vertices.push_back({ inputs.ControlPoints[i] + inputs.Tangents[i] * inputs.TangentLength, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f) });
 
-            tangentIndices.push_back(static_cast<unsigned>(i * 2));
-            tangentIndices.push_back(static_cast<unsigned>(i * 2 + 1));
+            tangent.Indices.push_back(static_cast<unsigned>(i * 2));
+            tangent.Indices.push_back(static_cast<unsigned>(i * 2 + 1));
         }
+    }
 
+    void D11CurvesNSplines::UploadCurves(const CurveGeometry& geometry)
+    {
         GLAttributeLayout posAttr;
         GLAttributeLayout colAttr;
         GLAttributeLayout uvAttr;
         graphics::describe_meshvertex_layout(posAttr, colAttr, uvAttr);
 
         hermiteMesh = GLVertexArray(GLPrimitive::Lines);
-        hermiteMesh.AddVertexBuffer(GLVertexBuffer(std::span{ hermiteVertices }), { posAttr, colAttr, uvAttr });
-        hermiteMesh.SetIndexBuffer(GLIndexBuffer(std::span{ hermiteIndices }));
+        hermiteMesh.AddVertexBuffer(GLVertexBuffer(std::span{ geometry.Hermite.Vertices }), { posAttr, colAttr, uvAttr });
+        hermiteMesh.SetIndexBuffer(GLIndexBuffer(std::span{ geometry.Hermite.Indices }));
 
         catmullMesh = GLVertexArray(GLPrimitive::Lines);
-        catmullMesh.AddVertexBuffer(GLVertexBuffer(std::span{ catmullVertices }), { posAttr, colAttr, uvAttr });
-        catmullMesh.SetIndexBuffer(GLIndexBuffer(std::span{ catmullIndices }));
+        catmullMesh.AddVertexBuffer(GLVertexBuffer(std::span{ geometry.Catmull.Vertices }), { posAttr, colAttr, uvAttr });
+        catmullMesh.SetIndexBuffer(GLIndexBuffer(std::span{ geometry.Catmull.Indices }));
 
         tangentMesh = GLVertexArray(GLPrimitive::Lines);
-        tangentMesh.AddVertexBuffer(GLVertexBuffer(std::span{ tangentVertices }), { posAttr, colAttr, uvAttr });
-        tangentMesh.SetIndexBuffer(GLIndexBuffer(std::span{ tangentIndices }));
+        tangentMesh.AddVertexBuffer(GLVertexBuffer(std::span{ geometry.Tangents.Vertices }), { posAttr, colAttr, uvAttr });
+        tangentMesh.SetIndexBuffer(GLIndexBuffer(std::span{ geometry.Tangents.Indices }));
 
         assert(shader.IsValidWithVertexArrayObject(hermiteMesh.GetHandle()));
         assert(shader.IsValidWithVertexArrayObject(catmullMesh.GetHandle()));
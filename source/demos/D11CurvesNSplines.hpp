@@ -34,6 +34,8 @@ namespace demos
         D11CurvesNSplines();
 
         void Update() override;
+        void Simulate(const SimulationStep& step) override;
+        void PublishSimulation() override;
         void Draw() const override;
         void ImGuiDraw() override;
 
@@ -42,8 +44,31 @@ namespace demos
         }
 
     private:
-        void UpdateCurves();
-        void HandleInput();
+        // What the curves are built from, copied for Simulate() whenever it changes
+        struct CurveInputs
+        {
+            std::vector<glm::vec3> ControlPoints;
+            std::vector<glm::vec3> Tangents;
+            int                    Samples       = 0;
+            float                  TangentLength = 0;
+        };
+
+        struct CurveLines
+        {
+            std::vector<graphics::MeshVertex> Vertices;
+            std::vector<unsigned>             Indices;
+        };
+
+        struct CurveGeometry
+        {
+            CurveLines Hermite;
+            CurveLines Catmull;
+            CurveLines Tangents;
+        };
+
+        static void BuildCurves(const CurveInputs& inputs, CurveGeometry& geometry);
+        void        UploadCurves(const CurveGeometry& geometry);
+        void        HandleInput();
 
         GLShader      shader;
         GLVertexArray hermiteMesh;
@@ -58,14 +83,15 @@ namespace demos
         std::vector<glm::vec3> initialControlPoints;
         std::vector<glm::vec3> initialTangents;
 
-        std::vector<graphics::MeshVertex> hermiteVertices;
-        std::vector<unsigned>             hermiteIndices;
-
-        std::vector<graphics::MeshVertex> catmullVertices;
-        std::vector<unsigned>             catmullIndices;
-
-        std::vector<graphics::MeshVertex> tangentVertices;
-        std::vector<unsigned>             tangentIndices;
+        // the render thread sets curvesChanged, PublishSimulation() hands the inputs over and brings the built curves back
+        bool          curvesChanged = false;
+        CurveGeometry publishedCurves;
+        bool          hasPublishedCurves = false;
+        // only Simulate() touches these between PublishSimulation() calls
+        CurveInputs   simulationInputs;
+        bool          hasSimulationInputs = false;
+        CurveGeometry simulatedCurves;
+        bool          hasSimulatedCurves = false;
 
         GLAttributeLayout position;
         GLAttributeLayout color;
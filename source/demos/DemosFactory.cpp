@@ -82,4 +82,24 @@ namespace demos
             return Demos::HelloQuad;
         }
     }
+
+    std::string_view demo_to_string(Demos the_demo) noexcept
+    {
+        switch (the_demo)
+        {
+            case Demos::HelloQuad:           return "hello";
+            case Demos::ProceduralMeshes:    return "meshes";
+            case Demos::Fog:                 return "fog";
+            case Demos::ToonShading:         return "toon";
+            case Demos::ShadowMapping:       return "shadow";
+            case Demos::GeometryShaders:     return "geom";
+            case Demos::TessellationShaders: return "tess";
+            case Demos::ComputeShaders:      return "comp";
+            case Demos::ValueNoise:          return "value";
+            case Demos::GradientNoise:       return "gradient";
+            case Demos::CurvesNSplines:      return "curves";
+            case Demos::None:
+            default: return "none";
+        }
+    }
 }
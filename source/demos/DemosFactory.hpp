@@ -33,4 +33,6 @@ namespace demos
     gsl::owner<IDemo*> create_demo(Demos the_demo);
 
     [[nodiscard]] Demos string_to_demo(std::string_view str) noexcept;
+    // The short name string_to_demo() understands, "none" for Demos::None
+    [[nodiscard]] std::string_view demo_to_string(Demos the_demo) noexcept;
 }
@@ -9,6 +9,12 @@
 
 namespace demos
 {
+    struct SimulationStep
+    {
+        double             Seconds = 0; // always the same length, so a simulation plays out the same however fast frames are
+        unsigned long long Index   = 0; // how many steps came before this one
+    };
+
     class IDemo
     {
     public:
@@ -24,5 +30,17 @@ namespace demos
         constexpr virtual void Update()                              = 0;
         constexpr virtual void Draw() const                          = 0;
         constexpr virtual void ImGuiDraw()                           = 0;
+
+        // Optional fixed timestep simulation. With pipelined updates Simulate() runs on a worker thread while the frame
+        // before it is drawn, so it may not make OpenGL calls, read environment::input or touch anything Update(), Draw()
+        // or ImGuiDraw() use. PublishSimulation() runs on the render thread once those steps are done and before Update(),
+        // that is where the results get handed over.
+        constexpr virtual void Simulate([[maybe_unused]] const SimulationStep& step)
+        {
+        }
+
+        constexpr virtual void PublishSimulation()
+        {
+        }
     };
 }
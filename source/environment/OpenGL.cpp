@@ -0,0 +1,49 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "OpenGL.hpp"
+
+#include "opengl/GL.hpp"
+#include <GL/glew.h>
+#include <string_view>
+
+namespace environment::opengl
+{
+    void query_current_context()
+    {
+        GL::GetIntegerv(GL_MAJOR_VERSION, &MajorVersion);
+        GL::GetIntegerv(GL_MINOR_VERSION, &MinorVersion);
+        GL::GetIntegerv(GL_MAX_ELEMENTS_VERTICES, &MaxElementVertices);
+        GL::GetIntegerv(GL_MAX_ELEMENTS_INDICES, &MaxElementIndices);
+        GL::GetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &MaxTextureImageUnits);
+        GL::GetIntegerv(GL_MAX_TEXTURE_SIZE, &MaxTextureSize);
+#if !defined(OPENGL_ES3_ONLY)
+        HasParallelShaderCompile = GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+        if (HasParallelShaderCompile)
+        {
+            // let the driver pick how many background compiler threads to use
+            constexpr GLuint IMPLEMENTATION_DEFINED_COUNT = 0xFFFFFFFFu;
+            GL::MaxShaderCompilerThreads(IMPLEMENTATION_DEFINED_COUNT);
+        }
+#endif
+#if !defined(OPENGL_ES3_ONLY)
+        HasS3TCCompression = GLEW_EXT_texture_compression_s3tc;
+#else
+        // WebGL calls it WEBGL_compressed_texture_s3tc
+        GLint extension_count = 0;
+        GL::GetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+        for (GLuint i = 0; i < static_cast<GLuint>(extension_count); ++i)
+        {
+            const std::string_view extension = reinterpret_cast<const char*>(GL::GetStringi(GL_EXTENSIONS, i));
+            if (extension.ends_with("texture_compression_s3tc") || extension.ends_with("compressed_texture_s3tc"))
+            {
+                HasS3TCCompression = true;
+            }
+        }
+#endif
+    }
+}
@@ -9,13 +9,15 @@
 
 namespace environment::opengl
 {
-    inline int  MajorVersion         = 0;
-    inline int  MinorVersion         = 0;
-    inline bool IsOpenGL_ES          = false;
-    inline int  MaxElementVertices   = 0;
-    inline int  MaxElementIndices    = 0;
-    inline int  MaxTextureImageUnits = 2;
-    inline int  MaxTextureSize       = 64;
+    inline int  MajorVersion             = 0;
+    inline int  MinorVersion             = 0;
+    inline bool IsOpenGL_ES              = false;
+    inline int  MaxElementVertices       = 0;
+    inline int  MaxElementIndices        = 0;
+    inline int  MaxTextureImageUnits     = 2;
+    inline int  MaxTextureSize           = 64;
+    inline bool HasParallelShaderCompile = false;
+    inline bool HasS3TCCompression       = false;
 
     constexpr int version(int major, int minor) noexcept
     {
@@ -26,6 +28,9 @@ namespace environment::opengl
     {
         return version(MajorVersion, MinorVersion);
     }
+
+    // Fills in the values above from the context that is current on this thread
+    void query_current_context();
 }
 
 #if !defined(OPENGL_ES3_ONLY)
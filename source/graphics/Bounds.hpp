@@ -0,0 +1,53 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+namespace graphics
+{
+    struct AABB
+    {
+        glm::vec3 Min{ 0.0f };
+        glm::vec3 Max{ 0.0f };
+    };
+
+    struct BoundingSphere
+    {
+        glm::vec3 Center{ 0.0f };
+        float     Radius = 0;
+    };
+
+    // The box that holds the transformed corners of the box, without transforming all eight of them (Arvo, Graphics Gems 1990)
+    inline AABB transform_bounds(const AABB& box, const glm::mat4& model_matrix)
+    {
+        AABB result{ glm::vec3(model_matrix[3]), glm::vec3(model_matrix[3]) };
+        for (int column = 0; column < 3; ++column)
+        {
+            const glm::vec3 axis = glm::vec3(model_matrix[column]);
+            const glm::vec3 a    = axis * box.Min[column];
+            const glm::vec3 b    = axis * box.Max[column];
+            result.Min += glm::min(a, b);
+            result.Max += glm::max(a, b);
+        }
+        return result;
+    }
+
+    // Non uniform scales grow the radius by the largest one, so the result may be a bit loose but never too small
+    inline BoundingSphere transform_bounds(const BoundingSphere& sphere, const glm::mat4& model_matrix)
+    {
+        const float largest_scale = std::sqrt(std::max({ glm::dot(glm::vec3(model_matrix[0]), glm::vec3(model_matrix[0])), glm::dot(glm::vec3(model_matrix[1]), glm::vec3(model_matrix[1])),
+                                                         glm::dot(glm::vec3(model_matrix[2]), glm::vec3(model_matrix[2])) }));
+        return BoundingSphere{ glm::vec3(model_matrix * glm::vec4(sphere.Center, 1.0f)), sphere.Radius * largest_scale };
+    }
+}
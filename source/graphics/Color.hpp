@@ -0,0 +1,25 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include "opengl/GLTexture.hpp"
+#include <algorithm>
+#include <glm/vec4.hpp>
+
+namespace graphics
+{
+    // Packs a 0 to 1 color into the bytes GLTexture::LoadFromMemory expects, red in the lowest byte
+    constexpr GLTexture::RGBA vec4_to_rgba(const glm::vec4& color) noexcept
+    {
+        const auto r = static_cast<unsigned int>(std::clamp(color.r, 0.0f, 1.0f) * 255.0f);
+        const auto g = static_cast<unsigned int>(std::clamp(color.g, 0.0f, 1.0f) * 255.0f);
+        const auto b = static_cast<unsigned int>(std::clamp(color.b, 0.0f, 1.0f) * 255.0f);
+        const auto a = static_cast<unsigned int>(std::clamp(color.a, 0.0f, 1.0f) * 255.0f);
+        return (a << 24) | (b << 16) | (g << 8) | r;
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "DrawCulling.hpp"
+
+#include "Bounds.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace graphics
+{
+    void cull_draws(std::span<const CullObject> objects, std::span<const glm::mat4> model_matrices, std::span<const Frustum> views, std::uint32_t view_mask,
+                    std::span<GLDrawElementsIndirectCommand> commands, std::span<std::uint32_t> counts)
+    {
+        assert(model_matrices.size() >= objects.size() && commands.size() >= 2 * views.size() * objects.size() && counts.size() >= 2 * views.size());
+        std::fill(counts.begin(), counts.end(), 0u);
+        for (std::size_t object = 0; object < objects.size(); ++object)
+        {
+            const auto&          cull_object = objects[object];
+            const BoundingSphere model_sphere{ glm::vec3(cull_object.Sphere), cull_object.Sphere.w };
+            const BoundingSphere world_sphere = transform_bounds(model_sphere, model_matrices[object]);
+            for (std::size_t view = 0; view < views.size(); ++view)
+            {
+                if ((view_mask & (1u << view)) == 0 || !intersects(views[view], world_sphere))
+                    continue;
+                const std::size_t group = view * 2 + cull_object.DoubleSided;
+                commands[group * objects.size() + counts[group]++] =
+                    GLDrawElementsIndirectCommand{ cull_object.IndexCount, 1, cull_object.FirstIndex, 0, static_cast<GLuint>(object) };
+            }
+        }
+    }
+
+    bool same_draws(std::span<const GLDrawElementsIndirectCommand> a, std::span<const GLDrawElementsIndirectCommand> b)
+    {
+        if (a.size() != b.size())
+            return false;
+        const auto by_instance = [](const GLDrawElementsIndirectCommand& left, const GLDrawElementsIndirectCommand& right)
+        {
+            return left.BaseInstance < right.BaseInstance;
+        };
+        std::vector<GLDrawElementsIndirectCommand> sorted_a(a.begin(), a.end());
+        std::vector<GLDrawElementsIndirectCommand> sorted_b(b.begin(), b.end());
+        std::sort(sorted_a.begin(), sorted_a.end(), by_instance);
+        std::sort(sorted_b.begin(), sorted_b.end(), by_instance);
+        return std::equal(sorted_a.begin(), sorted_a.end(), sorted_b.begin(),
+                          [](const GLDrawElementsIndirectCommand& left, const GLDrawElementsIndirectCommand& right)
+                          {
+                              return left.Count == right.Count && left.InstanceCount == right.InstanceCount && left.FirstIndex == right.FirstIndex &&
+                                     left.BaseVertex == right.BaseVertex && left.BaseInstance == right.BaseInstance;
+                          });
+    }
+}
@@ -0,0 +1,41 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include "Frustum.hpp"
+#include "opengl/GLVertexArray.hpp"
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+
+namespace graphics
+{
+    // One object as a culling compute shader reads it, laid out the way std430 packs it.
+    // Frustum's six vec4s already match a std430 vec4[6], so views are uploaded as Frustums.
+    struct CullObject
+    {
+        glm::vec4     Sphere{ 0.0f }; // model space center and radius
+        std::uint32_t IndexCount  = 0;
+        std::uint32_t FirstIndex  = 0;
+        std::uint32_t DoubleSided = 0; // 1 puts its draws in the view's double sided group
+        std::uint32_t Padding     = 0;
+    };
+
+    // CPU version of the culling compute shaders, with the same sphere transform and plane test, so both find the same visible set.
+    // Every view v with bit v of view_mask set gets two groups of objects.size() commands: group 2v for its single sided objects
+    // and 2v + 1 for its double sided ones. counts[group] is how many commands went into it, packed from the front of the group.
+    // Here they come out in object order, the GPU writes them in whatever order its invocations ran.
+    // The command's base instance is the object's index.
+    void cull_draws(std::span<const CullObject> objects, std::span<const glm::mat4> model_matrices, std::span<const Frustum> views, std::uint32_t view_mask,
+                    std::span<GLDrawElementsIndirectCommand> commands, std::span<std::uint32_t> counts);
+
+    // True when both lists draw the same objects with the same ranges, in any order
+    [[nodiscard]] bool same_draws(std::span<const GLDrawElementsIndirectCommand> a, std::span<const GLDrawElementsIndirectCommand> b);
+}
@@ -0,0 +1,142 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "Frustum.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#    define CULL_WITH_SSE
+#    include <xmmintrin.h>
+#endif
+
+namespace
+{
+    glm::vec4 normalize_plane(glm::vec4 plane) noexcept
+    {
+        const float length = glm::length(glm::vec3(plane));
+        return (length > 0.0f) ? plane / length : plane;
+    }
+
+    glm::vec4 row(const glm::mat4& matrix, int which) noexcept
+    {
+        return glm::vec4(matrix[0][which], matrix[1][which], matrix[2][which], matrix[3][which]);
+    }
+
+    std::uint8_t sphere_inside(const graphics::Frustum& frustum, float x, float y, float z, float radius) noexcept
+    {
+        for (const auto& plane : frustum.Planes)
+        {
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w < -radius)
+                return 0;
+        }
+        return 1;
+    }
+}
+
+namespace graphics
+{
+    Frustum extract_frustum(const glm::mat4& view_projection)
+    {
+        const glm::vec4 x = row(view_projection, 0);
+        const glm::vec4 y = row(view_projection, 1);
+        const glm::vec4 z = row(view_projection, 2);
+        const glm::vec4 w = row(view_projection, 3);
+
+        Frustum frustum;
+        frustum.Planes[Frustum::Left]   = normalize_plane(w + x);
+        frustum.Planes[Frustum::Right]  = normalize_plane(w - x);
+        frustum.Planes[Frustum::Bottom] = normalize_plane(w + y);
+        frustum.Planes[Frustum::Top]    = normalize_plane(w - y);
+        frustum.Planes[Frustum::Near]   = normalize_plane(w + z); // OpenGL clip space, z goes from -w to w
+        frustum.Planes[Frustum::Far]    = normalize_plane(w - z);
+        return frustum;
+    }
+
+    bool intersects(const Frustum& frustum, const BoundingSphere& sphere) noexcept
+    {
+        return sphere_inside(frustum, sphere.Center.x, sphere.Center.y, sphere.Center.z, sphere.Radius) != 0;
+    }
+
+    bool intersects(const Frustum& frustum, const AABB& box) noexcept
+    {
+        for (const auto& plane : frustum.Planes)
+        {
+            // the corner furthest along the plane normal
+            const glm::vec3 corner{ (plane.x >= 0.0f) ? box.Max.x : box.Min.x, (plane.y >= 0.0f) ? box.Max.y : box.Min.y, (plane.z >= 0.0f) ? box.Max.z : box.Min.z };
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    void FrustumCuller::Clear() noexcept
+    {
+        centersX.clear();
+        centersY.clear();
+        centersZ.clear();
+        radii.clear();
+    }
+
+    void FrustumCuller::Reserve(std::size_t how_many)
+    {
+        centersX.reserve(how_many);
+        centersY.reserve(how_many);
+        centersZ.reserve(how_many);
+        radii.reserve(how_many);
+    }
+
+    void FrustumCuller::Add(const BoundingSphere& world_sphere)
+    {
+        centersX.push_back(world_sphere.Center.x);
+        centersY.push_back(world_sphere.Center.y);
+        centersZ.push_back(world_sphere.Center.z);
+        radii.push_back(world_sphere.Radius);
+    }
+
+    CullCounts FrustumCuller::Cull(const Frustum& frustum, std::vector<std::uint8_t>& visible) const
+    {
+        const std::size_t count = radii.size();
+        visible.resize(count);
+        std::size_t i = 0;
+#if defined(CULL_WITH_SSE)
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 x            = _mm_loadu_ps(centersX.data() + i);
+            const __m128 y            = _mm_loadu_ps(centersY.data() + i);
+            const __m128 z            = _mm_loadu_ps(centersZ.data() + i);
+            const __m128 minus_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radii.data() + i));
+            __m128       inside       = _mm_cmpeq_ps(minus_radius, minus_radius); // all bits set
+            for (const auto& plane : frustum.Planes)
+            {
+                __m128 distance = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.w));
+                distance        = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(plane.y)));
+                distance        = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane.z)));
+                inside          = _mm_and_ps(inside, _mm_cmpge_ps(distance, minus_radius));
+            }
+            const int mask = _mm_movemask_ps(inside);
+            visible[i + 0] = static_cast<std::uint8_t>(mask & 1);
+            visible[i + 1] = static_cast<std::uint8_t>((mask >> 1) & 1);
+            visible[i + 2] = static_cast<std::uint8_t>((mask >> 2) & 1);
+            visible[i + 3] = static_cast<std::uint8_t>((mask >> 3) & 1);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            visible[i] = sphere_inside(frustum, centersX[i], centersY[i], centersZ[i], radii[i]);
+        }
+
+        CullCounts counts;
+        for (const auto is_visible : visible)
+        {
+            counts.Drawn += is_visible;
+        }
+        counts.Culled = static_cast<int>(count) - counts.Drawn;
+        return counts;
+    }
+}
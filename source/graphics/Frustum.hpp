@@ -0,0 +1,72 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include "Bounds.hpp"
+
+#include <array>
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <vector>
+
+namespace graphics
+{
+    // Six planes facing inwards, a point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0
+    struct Frustum
+    {
+        enum Side
+        {
+            Left,
+            Right,
+            Bottom,
+            Top,
+            Near,
+            Far,
+            Count
+        };
+
+        std::array<glm::vec4, Side::Count> Planes{};
+    };
+
+    // Planes in whatever space the matrix comes from, so projection * view gives world space planes (Gribb & Hartmann)
+    Frustum extract_frustum(const glm::mat4& view_projection);
+
+    [[nodiscard]] bool intersects(const Frustum& frustum, const BoundingSphere& sphere) noexcept;
+    [[nodiscard]] bool intersects(const Frustum& frustum, const AABB& box) noexcept;
+
+    struct CullCounts
+    {
+        int Drawn  = 0;
+        int Culled = 0;
+    };
+
+    // World space spheres kept as separate x, y, z and radius arrays so four of them are tested against a plane at once.
+    // Fill it once per frame and cull it against as many frusta as needed.
+    class FrustumCuller
+    {
+    public:
+        void Clear() noexcept;
+        void Reserve(std::size_t how_many);
+        void Add(const BoundingSphere& world_sphere);
+
+        [[nodiscard]] std::size_t Size() const noexcept
+        {
+            return radii.size();
+        }
+
+        // visible[i] is 1 when sphere i touches the frustum. Spheres that straddle a plane are kept, so a few
+        // objects just outside a corner get drawn, nothing inside ever gets dropped.
+        CullCounts Cull(const Frustum& frustum, std::vector<std::uint8_t>& visible) const;
+
+    private:
+        std::vector<float> centersX;
+        std::vector<float> centersY;
+        std::vector<float> centersZ;
+        std::vector<float> radii;
+    };
+}
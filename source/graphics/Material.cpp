@@ -8,6 +8,7 @@
 #include "Material.hpp"
 
 #include "opengl/GL.hpp"
+#include "opengl/GLProgramReflection.hpp"
 #include "opengl/GLShader.hpp"
 #include "opengl/GLTexture.hpp"
 #include <algorithm>
@@ -18,7 +19,13 @@ namespace
 {
     void                                 apply_culling_settings(const graphics::Material& material);
     void                                 apply_depth_settings(const graphics::Material& material);
-    graphics::Material::UniformValueType set_uniform(GLenum type, const std::string& name, GLuint program_handle, int& sampler_count);
+    graphics::Material::UniformValueType set_uniform(const GLProgramReflection::Uniform& reflected_uniform, int& sampler_count);
+
+    bool has_uniform(const GLShader& shader, std::string_view name)
+    {
+        const auto& uniforms = shader.GetReflection().Uniforms;
+        return std::any_of(std::begin(uniforms), std::end(uniforms), [&](const GLProgramReflection::Uniform& u) { return u.Location >= 0 && u.Name == name; });
+    }
 }
 
 namespace graphics
@@ -31,28 +38,45 @@ namespace graphics
             Name = name;
         else
             Name = shaderPtr->GetName() + "Material"s;
-        findAndAddUniforms();
+        findUniformsIfShaderIsReady();
     }
 
-    void Material::ForceApplyAllSettings() const
+    bool Material::ForceApplyAllSettings() const
     {
         apply_culling_settings(*this);
         apply_depth_settings(*this);
         if (shaderPtr == nullptr)
-            return;
-        const auto& shader = *shaderPtr;
+            return true;
+        // everything may have been set before an async build finished
+        findUniformsIfShaderIsReady();
+        const GLShader* shader_ptr = GetActiveShader();
+        if (shader_ptr == nullptr)
+            return false;
+        const auto& shader      = *shader_ptr;
+        const bool  is_fallback = shader_ptr != shaderPtr;
         shader.Use();
         for (const auto& uniform : uniformValues)
         {
+            // the fallback only gets the uniforms it shares with the real shader
+            if (is_fallback && !has_uniform(shader, uniform.Name))
+                continue;
             std::visit([&](auto&& value)
                        { shader.SendUniform(uniform.Name, value); },
                        uniform.Value);
         }
         for (unsigned slot = 0; slot < textures.size(); ++slot)
         {
-            const auto tex_ptr = textures[slot];
-            tex_ptr->UseForSlot(slot);
+            if (const auto tex_ptr = textures[slot]; tex_ptr != nullptr)
+                tex_ptr->UseForSlot(slot);
         }
+        return true;
+    }
+
+    const GLShader* Material::GetActiveShader() const noexcept
+    {
+        if (shaderPtr == nullptr)
+            return nullptr;
+        return shaderPtr->IsReady() ? shaderPtr : fallbackShaderPtr;
     }
 
     void Material::SetMaterialUniform(std::string_view name, float value)
@@ -183,6 +207,9 @@ namespace graphics
     void Material::SetTextures(std::span<const GLTexture* const> the_textures)
     {
         using namespace std::string_literals;
+        findUniformsIfShaderIsReady();
+        if (!foundUniforms)
+            textures.resize(the_textures.size());
         if (textures.size() != the_textures.size())
             throw std::runtime_error{ "Material "s + Name + " requires "s + std::to_string(textures.size()) + " textures but tried to set "s + std::to_string(the_textures.size()) };
         std::copy(std::begin(the_textures), std::end(the_textures), std::begin(textures));
@@ -193,32 +220,41 @@ namespace graphics
         SetTextures(std::span{ the_textures.begin(), the_textures.end() });
     }
 
-    void Material::findAndAddUniforms()
+    void Material::findAndAddUniforms() const
     {
-        // https://docs.gl/es3/glGetActiveUniform - reference
-        GLint      max_name_length = 0;
-        const auto program_handle  = shaderPtr->GetHandle();
-        GL::GetProgramiv(program_handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
-        GLint num_uniforms = 0;
-        GL::GetProgramiv(program_handle, GL_ACTIVE_UNIFORMS, &num_uniforms);
-        const GLuint uniform_count = gsl::narrow<GLuint>(num_uniforms);
-        std::string  name;
-        int          sampler_count = 0;
-        for (GLuint i = 0; i < uniform_count; ++i)
+        // reflection is shared by every material using this shader, so this doesn't talk to OpenGL again
+        const auto&          reflection    = shaderPtr->GetReflection();
+        int                  sampler_count = 0;
+        std::vector<Uniform> found_uniforms;
+        for (const auto& reflected_uniform : reflection.Uniforms)
         {
-            GLsizei written;
-            GLint   size;
-            GLenum  type;
-            name.clear();
-            name.resize(static_cast<unsigned>(max_name_length) + 1);
-            GL::GetActiveUniform(program_handle, i, max_name_length, &written, &size, &type, name.data());
-            name.resize(static_cast<std::string::size_type>(written));
-            // skip failures, skip built in uniforms that start with gl_, skip arrays (for now)
-            if (name.empty() || (name.size() > 3 && name[0] == 'g' && name[1] == 'l' && name[2] == '_') || size != 1)
+            const auto& name = reflected_uniform.Name;
+            // skip failures, skip built in uniforms that start with gl_, skip uniform block members, skip arrays (for now)
+            if (name.empty() || (name.size() > 3 && name[0] == 'g' && name[1] == 'l' && name[2] == '_') || reflected_uniform.Location < 0 || reflected_uniform.ArraySize != 1)
                 continue;
-            uniformValues.push_back({ name, set_uniform(type, name, program_handle, sampler_count) });
+            found_uniforms.push_back({ name, set_uniform(reflected_uniform, sampler_count) });
+        }
+        // keep any values that were set while the shader was still being built
+        for (auto& uniform : found_uniforms)
+        {
+            const auto set_earlier = std::find_if(std::begin(uniformValues), std::end(uniformValues), [&](const Uniform& u) { return u.Name == uniform.Name; });
+            if (set_earlier != std::end(uniformValues) && set_earlier->Value.index() == uniform.Value.index())
+                uniform.Value = set_earlier->Value;
+        }
+        uniformValues = std::move(found_uniforms);
+        // SetTextures() couldn't check the count before the shader was built
+        if (!textures.empty() && textures.size() != static_cast<size_t>(sampler_count))
+        {
+            std::cerr << "Material " << Name << " requires " << sampler_count << " textures but " << textures.size() << " were set\n";
         }
         textures.resize(static_cast<size_t>(sampler_count));
+        foundUniforms = true;
+    }
+
+    void Material::findUniformsIfShaderIsReady() const
+    {
+        if (!foundUniforms && shaderPtr != nullptr && shaderPtr->IsReady())
+            findAndAddUniforms();
     }
 }
 
@@ -257,92 +293,67 @@ namespace
     }
 
 #if !defined(OPENGL_ES3_ONLY)
-    graphics::Material::UniformValueType set_uniform(GLenum type, const std::string& name, GLuint program_handle, int& sampler_count)
+    graphics::Material::UniformValueType set_uniform(const GLProgramReflection::Uniform& reflected_uniform, int& sampler_count)
     {
         graphics::Material::UniformValueType uniform;
 
-        union
-        {
-            float    matrix_values[16];
-            int      int_values[4];
-            unsigned uint_values[4];
-            float    float_values[4];
-
-        } values = {};
-
-        const GLint uniform_location = GL::GetUniformLocation(program_handle, name.c_str());
+        // default values were read when the program was reflected
+        const auto& values = reflected_uniform.DefaultValue;
 
-        switch (type)
+        switch (reflected_uniform.Type)
         {
             case GL_FLOAT:
-                GL::GetUniformfv(program_handle, uniform_location, values.float_values);
-                uniform = values.float_values[0];
+                uniform = values.Floats[0];
                 break;
             case GL_FLOAT_VEC2:
-                GL::GetUniformfv(program_handle, uniform_location, values.float_values);
-                uniform = glm::vec2(values.float_values[0], values.float_values[1]);
+                uniform = glm::vec2(values.Floats[0], values.Floats[1]);
                 break;
             case GL_FLOAT_VEC3:
-                GL::GetUniformfv(program_handle, uniform_location, values.float_values);
-                uniform = glm::vec3(values.float_values[0], values.float_values[1], values.float_values[2]);
+                uniform = glm::vec3(values.Floats[0], values.Floats[1], values.Floats[2]);
                 break;
             case GL_FLOAT_VEC4:
-                GL::GetUniformfv(program_handle, uniform_location, values.float_values);
-                uniform = glm::vec4(values.float_values[0], values.float_values[1], values.float_values[2], values.float_values[3]);
+                uniform = glm::vec4(values.Floats[0], values.Floats[1], values.Floats[2], values.Floats[3]);
                 break;
             case GL_INT:
-                GL::GetUniformiv(program_handle, uniform_location, values.int_values);
-                uniform = values.int_values[0];
+                uniform = values.Ints[0];
                 break;
             case GL_INT_VEC2:
-                GL::GetUniformiv(program_handle, uniform_location, values.int_values);
-                uniform = glm::ivec2(values.int_values[0], values.int_values[1]);
+                uniform = glm::ivec2(values.Ints[0], values.Ints[1]);
                 break;
             case GL_INT_VEC3:
-                GL::GetUniformiv(program_handle, uniform_location, values.int_values);
-                uniform = glm::ivec3(values.int_values[0], values.int_values[1], values.int_values[2]);
+                uniform = glm::ivec3(values.Ints[0], values.Ints[1], values.Ints[2]);
                 break;
             case GL_INT_VEC4:
-                GL::GetUniformiv(program_handle, uniform_location, values.int_values);
-                uniform = glm::ivec4(values.int_values[0], values.int_values[1], values.int_values[2], values.int_values[3]);
+                uniform = glm::ivec4(values.Ints[0], values.Ints[1], values.Ints[2], values.Ints[3]);
                 break;
             case GL_UNSIGNED_INT:
-                GL::GetUniformuiv(program_handle, uniform_location, values.uint_values);
-                uniform = values.uint_values[0];
+                uniform = values.Uints[0];
                 break;
             case GL_UNSIGNED_INT_VEC2:
-                GL::GetUniformuiv(program_handle, uniform_location, values.uint_values);
-                uniform = glm::uvec2(values.uint_values[0], values.uint_values[1]);
+                uniform = glm::uvec2(values.Uints[0], values.Uints[1]);
                 break;
             case GL_UNSIGNED_INT_VEC3:
-                GL::GetUniformuiv(program_handle, uniform_location, values.uint_values);
-                uniform = glm::uvec3(values.uint_values[0], values.uint_values[1], values.uint_values[2]);
+                uniform = glm::uvec3(values.Uints[0], values.Uints[1], values.Uints[2]);
                 break;
             case GL_UNSIGNED_INT_VEC4:
-                GL::GetUniformuiv(program_handle, uniform_location, values.uint_values);
-                uniform = glm::uvec4(values.uint_values[0], values.uint_values[1], values.uint_values[2], values.uint_values[3]);
+                uniform = glm::uvec4(values.Uints[0], values.Uints[1], values.Uints[2], values.Uints[3]);
                 break;
             case GL_BOOL:
-                GL::GetUniformiv(program_handle, uniform_location, values.int_values);
-                uniform = static_cast<bool>(values.int_values[0]);
+                uniform = static_cast<bool>(values.Ints[0]);
                 break;
             case GL_BOOL_VEC2:
-                GL::GetUniformiv(program_handle, uniform_location, values.int_values);
-                uniform = glm::bvec2(values.int_values[0], values.int_values[1]);
+                uniform = glm::bvec2(values.Ints[0], values.Ints[1]);
                 break;
             case GL_BOOL_VEC3:
-                GL::GetUniformiv(program_handle, uniform_location, values.int_values);
-                uniform = glm::bvec3(values.int_values[0], values.int_values[1], values.int_values[2]);
+                uniform = glm::bvec3(values.Ints[0], values.Ints[1], values.Ints[2]);
                 break;
             case GL_BOOL_VEC4:
-                GL::GetUniformiv(program_handle, uniform_location, values.int_values);
-                uniform = glm::bvec4(values.int_values[0], values.int_values[1], values.int_values[2], values.int_values[3]);
+                uniform = glm::bvec4(values.Ints[0], values.Ints[1], values.Ints[2], values.Ints[3]);
                 break;
             case GL_FLOAT_MAT2:
                 {
-                    GL::GetUniformfv(program_handle, uniform_location, values.matrix_values);
-                    auto the_matrix = glm::mat2(glm::vec2(values.matrix_values[0], values.matrix_values[1]),  // col 1
-                                                glm::vec2(values.matrix_values[2], values.matrix_values[3])); // col 2
+                    auto the_matrix = glm::mat2(glm::vec2(values.Floats[0], values.Floats[1]),  // col 1
+                                                glm::vec2(values.Floats[2], values.Floats[3])); // col 2
                     if (the_matrix == glm::mat2(0.0f))
                         the_matrix = glm::mat2(1.0f);
                     uniform = the_matrix;
@@ -350,10 +361,9 @@ namespace
                 break;
             case GL_FLOAT_MAT3:
                 {
-                    GL::GetUniformfv(program_handle, uniform_location, values.matrix_values);
-                    auto the_matrix = glm::mat3(glm::vec3(values.matrix_values[0], values.matrix_values[1], values.matrix_values[2]),  // col 1
-                                                glm::vec3(values.matrix_values[3], values.matrix_values[4], values.matrix_values[5]),  // col2
-                                                glm::vec3(values.matrix_values[6], values.matrix_values[7], values.matrix_values[8])); // col 3
+                    auto the_matrix = glm::mat3(glm::vec3(values.Floats[0], values.Floats[1], values.Floats[2]),  // col 1
+                                                glm::vec3(values.Floats[3], values.Floats[4], values.Floats[5]),  // col2
+                                                glm::vec3(values.Floats[6], values.Floats[7], values.Floats[8])); // col 3
                     if (the_matrix == glm::mat3(0.0f))
                         the_matrix = glm::mat3(1.0f);
                     uniform = the_matrix;
@@ -361,11 +371,10 @@ namespace
                 break;
             case GL_FLOAT_MAT4:
                 {
-                    GL::GetUniformfv(program_handle, uniform_location, values.matrix_values);
-                    auto the_matrix = glm::mat4(glm::vec4(values.matrix_values[0], values.matrix_values[1], values.matrix_values[2], values.matrix_values[3]),      // col 1
-                                                glm::vec4(values.matrix_values[4], values.matrix_values[5], values.matrix_values[6], values.matrix_values[7]),      // col 2
-                                                glm::vec4(values.matrix_values[8], values.matrix_values[9], values.matrix_values[10], values.matrix_values[11]),    // col 3
-                                                glm::vec4(values.matrix_values[12], values.matrix_values[13], values.matrix_values[14], values.matrix_values[15])); // col 4
+                    auto the_matrix = glm::mat4(glm::vec4(values.Floats[0], values.Floats[1], values.Floats[2], values.Floats[3]),      // col 1
+                                                glm::vec4(values.Floats[4], values.Floats[5], values.Floats[6], values.Floats[7]),      // col 2
+                                                glm::vec4(values.Floats[8], values.Floats[9], values.Floats[10], values.Floats[11]),    // col 3
+                                                glm::vec4(values.Floats[12], values.Floats[13], values.Floats[14], values.Floats[15])); // col 4
                     if (the_matrix == glm::mat4(0.0f))
                         the_matrix = glm::mat4(1.0f);
                     uniform = the_matrix;
@@ -373,9 +382,8 @@ namespace
                 break;
             case GL_FLOAT_MAT2x3:
                 {
-                    GL::GetUniformfv(program_handle, uniform_location, values.matrix_values);
-                    auto the_matrix = glm::mat2x3(glm::vec3(values.matrix_values[0], values.matrix_values[1], values.matrix_values[2]),  // col 1
-                                                  glm::vec3(values.matrix_values[3], values.matrix_values[4], values.matrix_values[5])); // col 2
+                    auto the_matrix = glm::mat2x3(glm::vec3(values.Floats[0], values.Floats[1], values.Floats[2]),  // col 1
+                                                  glm::vec3(values.Floats[3], values.Floats[4], values.Floats[5])); // col 2
                     if (the_matrix == glm::mat2x3(0.0f))
                         the_matrix = glm::mat2x3(1.0f);
                     uniform = the_matrix;
@@ -383,9 +391,8 @@ namespace
                 break;
             case GL_FLOAT_MAT2x4:
                 {
-                    GL::GetUniformfv(program_handle, uniform_location, values.matrix_values);
-                    auto the_matrix = glm::mat2x4(glm::vec4(values.matrix_values[0], values.matrix_values[1], values.matrix_values[2], values.matrix_values[3]),  // col 1
-                                                  glm::vec4(values.matrix_values[4], values.matrix_values[5], values.matrix_values[6], values.matrix_values[7])); // col 2
+                    auto the_matrix = glm::mat2x4(glm::vec4(values.Floats[0], values.Floats[1], values.Floats[2], values.Floats[3]),  // col 1
+                                                  glm::vec4(values.Floats[4], values.Floats[5], values.Floats[6], values.Floats[7])); // col 2
                     if (the_matrix == glm::mat2x4(0.0f))
                         the_matrix = glm::mat2x4(1.0f);
                     uniform = the_matrix;
@@ -393,10 +400,9 @@ namespace
                 break;
             case GL_FLOAT_MAT3x2:
                 {
-                    GL::GetUniformfv(program_handle, uniform_location, values.matrix_values);
-                    auto the_matrix = glm::mat3x2(glm::vec2(values.matrix_values[0], values.matrix_values[1]),  // col 1
-                                                  glm::vec2(values.matrix_values[2], values.matrix_values[3]),  // col 2
-                                                  glm::vec2(values.matrix_values[4], values.matrix_values[5])); // col 3
+                    auto the_matrix = glm::mat3x2(glm::vec2(values.Floats[0], values.Floats[1]),  // col 1
+                                                  glm::vec2(values.Floats[2], values.Floats[3]),  // col 2
+                                                  glm::vec2(values.Floats[4], values.Floats[5])); // col 3
                     if (the_matrix == glm::mat3x2(0.0f))
                         the_matrix = glm::mat3x2(1.0f);
                     uniform = the_matrix;
@@ -404,10 +410,9 @@ namespace
                 break;
             case GL_FLOAT_MAT3x4:
                 {
-                    GL::GetUniformfv(program_handle, uniform_location, values.matrix_values);
-                    auto the_matrix = glm::mat3x4(glm::vec4(values.matrix_values[0], values.matrix_values[1], values.matrix_values[2], values.matrix_values[3]),    // col 1
-                                                  glm::vec4(values.matrix_values[4], values.matrix_values[5], values.matrix_values[6], values.matrix_values[7]),    // col 2
-                                                  glm::vec4(values.matrix_values[8], values.matrix_values[9], values.matrix_values[10], values.matrix_values[11])); // col 3
+                    auto the_matrix = glm::mat3x4(glm::vec4(values.Floats[0], values.Floats[1], values.Floats[2], values.Floats[3]),    // col 1
+                                                  glm::vec4(values.Floats[4], values.Floats[5], values.Floats[6], values.Floats[7]),    // col 2
+                                                  glm::vec4(values.Floats[8], values.Floats[9], values.Floats[10], values.Floats[11])); // col 3
                     if (the_matrix == glm::mat3x4(0.0f))
                         the_matrix = glm::mat3x4(1.0f);
                     uniform = the_matrix;
@@ -415,11 +420,10 @@ namespace
                 break;
             case GL_FLOAT_MAT4x2:
                 {
-                    GL::GetUniformfv(program_handle, uniform_location, values.matrix_values);
-                    auto the_matrix = glm::mat4x2(glm::vec2(values.matrix_values[0], values.matrix_values[1]),  // col 1
-                                                  glm::vec2(values.matrix_values[2], values.matrix_values[3]),  // col 2
-                                                  glm::vec2(values.matrix_values[4], values.matrix_values[5]),  // col 3
-                                                  glm::vec2(values.matrix_values[6], values.matrix_values[7])); // col 4
+                    auto the_matrix = glm::mat4x2(glm::vec2(values.Floats[0], values.Floats[1]),  // col 1
+                                                  glm::vec2(values.Floats[2], values.Floats[3]),  // col 2
+                                                  glm::vec2(values.Floats[4], values.Floats[5]),  // col 3
+                                                  glm::vec2(values.Floats[6], values.Floats[7])); // col 4
                     if (the_matrix == glm::mat4x2(0.0f))
                         the_matrix = glm::mat4x2(1.0f);
                     uniform = the_matrix;
@@ -427,11 +431,10 @@ namespace
                 break;
             case GL_FLOAT_MAT4x3:
                 {
-                    GL::GetUniformfv(program_handle, uniform_location, values.matrix_values);
-                    auto the_matrix = glm::mat4x3(glm::vec3(values.matrix_values[0], values.matrix_values[1], values.matrix_values[2]),    // col 1
-                                                  glm::vec3(values.matrix_values[3], values.matrix_values[4], values.matrix_values[5]),    // col 2
-                                                  glm::vec3(values.matrix_values[6], values.matrix_values[7], values.matrix_values[8]),    // col 3
-                                                  glm::vec3(values.matrix_values[9], values.matrix_values[10], values.matrix_values[11])); // col 4
+                    auto the_matrix = glm::mat4x3(glm::vec3(values.Floats[0], values.Floats[1], values.Floats[2]),    // col 1
+                                                  glm::vec3(values.Floats[3], values.Floats[4], values.Floats[5]),    // col 2
+                                                  glm::vec3(values.Floats[6], values.Floats[7], values.Floats[8]),    // col 3
+                                                  glm::vec3(values.Floats[9], values.Floats[10], values.Floats[11])); // col 4
                     if (the_matrix == glm::mat4x3(0.0f))
                         the_matrix = glm::mat4x3(1.0f);
                     uniform = the_matrix;
@@ -461,7 +464,7 @@ namespace
 
             default:
                 // Handle other cases or throw an exception for unsupported types
-                std::cerr << "Unsupported GLenum: " << type << std::endl;
+                std::cerr << "Unsupported GLenum: " << reflected_uniform.Type << std::endl;
                 assert(false);
                 break;
         }
@@ -473,10 +476,10 @@ namespace
     //  In WebGL it is an object type and in regular OpenGL it's an int
     //  Emscripten must me failing at converting it to the WenGL equivalent
     //  We will just use zero and identity defaults for Web platform
-    graphics::Material::UniformValueType set_uniform(GLenum type, [[maybe_unused]] const std::string& name, [[maybe_unused]] GLuint program_handle, int& sampler_count)
+    graphics::Material::UniformValueType set_uniform(const GLProgramReflection::Uniform& reflected_uniform, int& sampler_count)
     {
         graphics::Material::UniformValueType uniform;
-        switch (type)
+        switch (reflected_uniform.Type)
         {
             case GL_FLOAT:
                 uniform = 0.0f;
@@ -595,7 +598,7 @@ namespace
 
             default:
                 // Handle other cases or throw an exception for unsupported types
-                std::cerr << "Unsupported GLenum: " << type << std::endl;
+                std::cerr << "Unsupported GLenum: " << reflected_uniform.Type << std::endl;
                 assert(false);
                 break;
         }
@@ -52,7 +52,9 @@ namespace graphics
             glm::mat2, glm::mat3, glm::mat4,                                             // matrices
             glm::mat2x3, glm::mat2x4, glm::mat3x2, glm::mat3x4, glm::mat4x2, glm::mat4x3 // non-square matrices
             >;
-        void ForceApplyAllSettings() const;
+        // Uses the shader and sends the uniforms and textures. Returns false when neither the shader nor the fallback
+        // is ready, nothing is bound then so skip the draw.
+        bool ForceApplyAllSettings() const;
 
         void SetMaterialUniform(std::string_view name, float value);
         void SetMaterialUniform(std::string_view name, glm::vec2 value);
@@ -83,20 +85,36 @@ namespace graphics
         void SetTextures(std::span<const GLTexture* const> the_textures);
         void SetTextures(const std::initializer_list<const GLTexture*>& the_textures);
 
+        // The shader ForceApplyAllSettings() would use right now, null when neither it nor the fallback is ready
+        [[nodiscard]] const GLShader* GetActiveShader() const noexcept;
+
+        // Drawn with instead while the material's shader is still being built asynchronously
+        void SetFallbackShader(const GLShader* fallback_shader) noexcept
+        {
+            fallbackShaderPtr = fallback_shader;
+        }
+
     private:
-        void findAndAddUniforms();
+        void findAndAddUniforms() const;
+        void findUniformsIfShaderIsReady() const;
 
         template <typename ValueType>
         void setMaterialUniform(std::string_view name, const ValueType& value)
         {
+            findUniformsIfShaderIsReady();
             for (auto& uniform : uniformValues)
             {
                 if (uniform.Name == name)
                 {
                     std::get<ValueType>(uniform.Value) = value;
-                    break;
+                    return;
                 }
             }
+            // Can't know the uniforms until the shader is linked, so keep the value around until then
+            if (!foundUniforms)
+            {
+                uniformValues.push_back({ std::string(name), value });
+            }
         }
 
     public:
@@ -122,9 +140,12 @@ namespace graphics
             UniformValueType Value;
         };
 
-        GLShader*                     shaderPtr{ nullptr };
-        std::vector<Uniform>          uniformValues{};
-        std::vector<const GLTexture*> textures{};
+        // the uniforms are found the first time the shader is seen ready, which can be while drawing
+        GLShader*                             shaderPtr{ nullptr };
+        const GLShader*                       fallbackShaderPtr{ nullptr };
+        mutable bool                          foundUniforms{ false };
+        mutable std::vector<Uniform>          uniformValues{};
+        mutable std::vector<const GLTexture*> textures{};
     };
 
     static inline const Material DEFAULT_MATERIAL{};
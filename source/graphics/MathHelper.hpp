@@ -7,8 +7,10 @@
  */
 #pragma once
 
+#include <glm/common.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/trigonometric.hpp>
+#include <glm/vec3.hpp>
 
 namespace graphics
 {
@@ -40,4 +42,14 @@ namespace graphics
         Result[3][3] = 1.0f;
         return Result;
     }
+
+    // The angles that make euler_angle_xyz_matrix rebuild a pure rotation. Exact while |rotation[2][0]| < 1,
+    // at the poles the x and z angles blend into one and only their combination is recovered.
+    inline glm::vec3 euler_angles_xyz(const glm::mat4& rotation)
+    {
+        const float y_angle = glm::asin(glm::clamp(rotation[2][0], -1.0f, 1.0f));
+        const float x_angle = glm::atan(-rotation[2][1], rotation[2][2]);
+        const float z_angle = glm::atan(-rotation[1][0], rotation[0][0]);
+        return { x_angle, y_angle, z_angle };
+    }
 }
@@ -15,8 +15,7 @@
 namespace
 {
     std::vector<graphics::MeshVertex> create_plane_vertices(int stacks, int slices);
-    std::vector<unsigned>             build_index_buffer(int stacks, int slices);
-    std::vector<unsigned>             convert_to_lines_pattern(const std::vector<unsigned>& indices);
+    graphics::Geometry                with_bounds(graphics::Geometry geometry);
 }
 
 namespace graphics
@@ -25,7 +24,7 @@ namespace graphics
     {
         auto vertices = create_plane_vertices(stacks, slices);
         auto indices  = build_index_buffer(stacks, slices);
-        return Geometry{ std::move(vertices), std::move(indices) };
+        return with_bounds(Geometry{ std::move(vertices), std::move(indices) });
     }
 
     Geometry create_cube(int stacks, int slices)
@@ -90,7 +89,7 @@ namespace graphics
                 indices.push_back(plane_index + static_cast<unsigned>(plane_vertices.size()) * i);
             }
         }
-        return Geometry{ std::move(vertices), std::move(indices) };
+        return with_bounds(Geometry{ std::move(vertices), std::move(indices) });
     }
 
     Geometry create_sphere(int stacks, int slices)
@@ -115,7 +114,7 @@ namespace graphics
         }
 
         std::vector<unsigned> indices = build_index_buffer(stacks, slices);
-        return Geometry{ std::move(vertices), std::move(indices) };
+        return with_bounds(Geometry{ std::move(vertices), std::move(indices) });
     }
 
     Geometry create_torus(int stacks, int slices, float start_angle, float end_angle)
@@ -146,7 +145,7 @@ namespace graphics
         }
 
         std::vector<unsigned> indices = build_index_buffer(stacks, slices);
-        return Geometry{ std::move(vertices), std::move(indices) };
+        return with_bounds(Geometry{ std::move(vertices), std::move(indices) });
     }
 
     void add_cap(std::vector<MeshVertex>& vertices, std::vector<unsigned>& indices, float center_y, int slices)
@@ -230,7 +229,7 @@ namespace graphics
         add_cap(vertices, indices, 0.5f, slices);
         add_cap(vertices, indices, -0.5f, slices);
 
-        return Geometry(vertices, indices);
+        return with_bounds(Geometry{ std::move(vertices), std::move(indices) });
     }
 
     Geometry create_cone(int stacks, int slices)
@@ -280,7 +279,7 @@ namespace graphics
         std::vector<unsigned> indices = build_index_buffer(stacks, slices);
         add_cap(vertices, indices, -0.5f, slices);
 
-        return Geometry{ std::move(vertices), std::move(indices) };
+        return with_bounds(Geometry{ std::move(vertices), std::move(indices) });
     }
 
     // https://prideout.net/blog/old/blog/index.html@p=22.html
@@ -365,7 +364,7 @@ namespace graphics
             v.position /= scale;
         }
         auto indices = build_index_buffer(stacks, slices);
-        return Geometry{ std::move(vertices), std::move(indices) };
+        return with_bounds(Geometry{ std::move(vertices), std::move(indices) });
     }
 
     Geometry create_line(const std::vector<glm::vec3>& points)
@@ -391,7 +390,7 @@ namespace graphics
             indices.push_back(i + 1);
         }
 
-        return Geometry{ std::move(vertices), std::move(indices) };
+        return with_bounds(Geometry{ std::move(vertices), std::move(indices) });
     }
 
     Geometry create_line()
@@ -403,7 +402,7 @@ namespace graphics
 
         std::vector<unsigned> indices = { 0, 1 };
 
-        return Geometry{ std::move(vertices), std::move(indices) };
+        return with_bounds(Geometry{ std::move(vertices), std::move(indices) });
     }
 
     Geometry create_circle(int segments)
@@ -436,7 +435,7 @@ namespace graphics
             indices.push_back(i + 1);
         }
 
-        return Geometry{ std::move(vertices), std::move(indices) };
+        return with_bounds(Geometry{ std::move(vertices), std::move(indices) });
     }
 
     void describe_meshvertex_layout(GLAttributeLayout& position, GLAttributeLayout& normal, GLAttributeLayout& uv)
@@ -480,6 +479,32 @@ namespace graphics
         return sub_mesh;
     }
 
+    PackedMeshes pack_as_triangles(std::span<const Geometry> geometries)
+    {
+        std::vector<MeshVertex> vertices;
+        std::vector<unsigned>   indices;
+        PackedMeshes            packed;
+        for (const auto& geometry : geometries)
+        {
+            const auto first_vertex = static_cast<unsigned>(vertices.size());
+            packed.Ranges.push_back(MeshRange{ gsl::narrow<GLsizei>(geometry.Indicies.size()), gsl::narrow<GLsizei>(indices.size()) });
+            vertices.insert(vertices.end(), geometry.Vertices.begin(), geometry.Vertices.end());
+            for (const unsigned index : geometry.Indicies)
+            {
+                indices.push_back(first_vertex + index);
+            }
+        }
+
+        GLAttributeLayout position;
+        GLAttributeLayout normal;
+        GLAttributeLayout uv;
+        describe_meshvertex_layout(position, normal, uv);
+        packed.VertexArrayObj.SetPrimitivePattern(GLPrimitive::Triangles);
+        packed.VertexArrayObj.AddVertexBuffer(GLVertexBuffer(std::span{ vertices }), { position, normal, uv });
+        packed.VertexArrayObj.SetIndexBuffer(GLIndexBuffer(std::span{ indices }));
+        return packed;
+    }
+
     SubMesh to_submesh_as_lines(const Geometry& geometry, Material* material)
     {
         GLAttributeLayout position;
@@ -524,6 +549,40 @@ namespace
         return { vertices };
     }
 
+    graphics::Geometry with_bounds(graphics::Geometry geometry)
+    {
+        graphics::compute_bounds(geometry);
+        return geometry;
+    }
+}
+
+namespace graphics
+{
+    void compute_bounds(Geometry& geometry)
+    {
+        if (geometry.Vertices.empty())
+        {
+            geometry.Box    = AABB{};
+            geometry.Sphere = BoundingSphere{};
+            return;
+        }
+        geometry.Box = AABB{ geometry.Vertices.front().position, geometry.Vertices.front().position };
+        for (const auto& vertex : geometry.Vertices)
+        {
+            geometry.Box.Min = glm::min(geometry.Box.Min, vertex.position);
+            geometry.Box.Max = glm::max(geometry.Box.Max, vertex.position);
+        }
+        // the box center isn't the smallest sphere but is within a few percent of it for these shapes
+        const glm::vec3 center         = (geometry.Box.Min + geometry.Box.Max) * 0.5f;
+        float           radius_squared  = 0;
+        for (const auto& vertex : geometry.Vertices)
+        {
+            const glm::vec3 offset = vertex.position - center;
+            radius_squared         = std::max(radius_squared, glm::dot(offset, offset));
+        }
+        geometry.Sphere = BoundingSphere{ center, std::sqrt(radius_squared) };
+    }
+
     std::vector<unsigned> build_index_buffer(int stacks, int slices)
     {
         unsigned p0 = 0, p1 = 0, p2 = 0, p3 = 0, p4 = 0, p5 = 0;
@@ -7,9 +7,11 @@
  */
 #pragma once
 
+#include "Bounds.hpp"
 #include "Material.hpp"
 
 #include <numbers>
+#include <span>
 #include <opengl/GLVertexArray.hpp>
 
 namespace graphics
@@ -48,6 +50,8 @@ namespace graphics
     {
         std::vector<MeshVertex> Vertices{};
         std::vector<unsigned>   Indicies{};
+        AABB                    Box{};    // model space, filled in by the create_* functions
+        BoundingSphere          Sphere{}; // centered on Box, just big enough for every vertex
     };
 
     Geometry create_plane(int stacks, int slices);
@@ -67,4 +71,28 @@ namespace graphics
 
     SubMesh  to_submesh_as_triangles(const Geometry& geometry, Material* material = nullptr);
     SubMesh  to_submesh_as_lines(const Geometry& geometry, Material* material = nullptr);
+
+    // Where one geometry's triangles sit in a shared index buffer
+    struct MeshRange
+    {
+        GLsizei IndexCount = 0;
+        GLsizei FirstIndex = 0;
+    };
+
+    // Many geometries in one vertex buffer and one index buffer, so they all draw from the same vertex array.
+    // Indices are rebased onto the shared vertices, every range draws with a base vertex of 0.
+    struct PackedMeshes
+    {
+        GLVertexArray          VertexArrayObj{};
+        std::vector<MeshRange> Ranges{}; // one per geometry, in the order they were given
+    };
+
+    PackedMeshes pack_as_triangles(std::span<const Geometry> geometries);
+
+    void compute_bounds(Geometry& geometry);
+
+    // Two triangles per cell of a (stacks + 1) x (slices + 1) grid of vertices
+    std::vector<unsigned> build_index_buffer(int stacks, int slices);
+    // Turns triangle indices into line indices, quads made by build_index_buffer() lose their diagonal
+    std::vector<unsigned> convert_to_lines_pattern(const std::vector<unsigned>& indices);
 }
@@ -0,0 +1,164 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "RenderQueue.hpp"
+
+#include "opengl/GL.hpp"
+#include "opengl/GLShader.hpp"
+#include "opengl/GLVertexArray.hpp"
+#include <algorithm>
+#include <bit>
+#include <span>
+
+namespace
+{
+    constexpr unsigned PassShift     = 60;
+    constexpr unsigned ShaderShift   = 48;
+    constexpr unsigned MaterialShift = 32;
+    constexpr unsigned CullingShift  = 31;
+    constexpr unsigned MeshShift     = 16;
+
+    constexpr std::uint64_t ShaderMask   = 0xFFF;
+    constexpr std::uint64_t MaterialMask = 0xFFFF;
+    constexpr std::uint64_t MeshMask     = 0x7FFF;
+
+    // The bits of a positive float sort the same way the floats do, the top 16 keep the exponent and 7 bits of mantissa
+    std::uint64_t depth_bits(float view_depth) noexcept
+    {
+        return std::bit_cast<std::uint32_t>(std::max(view_depth, 0.0f)) >> 16;
+    }
+
+    unsigned pass_of(std::uint64_t key) noexcept
+    {
+        return static_cast<unsigned>(key >> PassShift);
+    }
+
+    // Calls visit(previous, packet) for the packets of one pass in the order of entries, previous is null for the first
+    template <typename Entries, typename Visit>
+    void for_each_in_pass(std::span<const graphics::RenderQueue::Packet> packets, const Entries& entries, unsigned pass, Visit&& visit)
+    {
+        const graphics::RenderQueue::Packet* previous = nullptr;
+        for (const auto& entry : entries)
+        {
+            if (pass_of(entry.Key) != pass)
+                continue;
+            const auto& packet = packets[entry.Index];
+            visit(previous, packet);
+            previous = &packet;
+        }
+    }
+
+    // A pass starts from unknown state, so its first packet sets everything
+    template <typename Entries>
+    graphics::RenderQueue::StateChanges count_changes(std::span<const graphics::RenderQueue::Packet> packets, const Entries& entries, std::uint32_t used_passes)
+    {
+        using graphics::RenderQueue;
+        RenderQueue::StateChanges changes;
+        for (unsigned pass = 0; pass < RenderQueue::MaxPasses; ++pass)
+        {
+            if ((used_passes & (1u << pass)) == 0)
+                continue;
+            for_each_in_pass(packets, entries, pass,
+                             [&](const RenderQueue::Packet* previous, const RenderQueue::Packet& packet)
+                             {
+                                 const bool new_shader = previous == nullptr || previous->Shader != packet.Shader;
+                                 changes.Shaders += new_shader;
+                                 changes.Materials += new_shader || previous->Material != packet.Material;
+                                 changes.Meshes += previous == nullptr || previous->Mesh != packet.Mesh;
+                                 changes.Culling += previous == nullptr || ((previous->Flags ^ packet.Flags) & RenderQueue::DoubleSided) != 0;
+                             });
+        }
+        return changes;
+    }
+}
+
+namespace graphics
+{
+    void RenderQueue::Clear() noexcept
+    {
+        packets.clear();
+        submitted.clear();
+        sorted.clear();
+        shaders.clear();
+        meshes.clear();
+        usedPasses = 0;
+    }
+
+    void RenderQueue::Submit(unsigned pass, const Packet& packet)
+    {
+        pass = std::min(pass, MaxPasses - 1);
+        usedPasses |= 1u << pass;
+        const std::uint64_t key = (static_cast<std::uint64_t>(pass) << PassShift) | ((shaderId(packet.Shader) & ShaderMask) << ShaderShift) |
+                                  ((packet.Material & MaterialMask) << MaterialShift) | (static_cast<std::uint64_t>(packet.Flags & DoubleSided) << CullingShift) |
+                                  ((meshId(packet.Mesh) & MeshMask) << MeshShift) | depth_bits(packet.ViewDepth);
+        submitted.push_back(Entry{ key, static_cast<std::uint32_t>(packets.size()) });
+        packets.push_back(packet);
+    }
+
+    void RenderQueue::Sort()
+    {
+        // stable so equal keys keep the order they were submitted in
+        sorted = submitted;
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Entry& a, const Entry& b) { return a.Key < b.Key; });
+        unsortedChanges = count_changes(packets, submitted, usedPasses);
+        sortedChanges   = count_changes(packets, sorted, usedPasses);
+    }
+
+    void RenderQueue::Execute(unsigned pass, const BindMaterial& bind_material, const BindObject& bind_object) const
+    {
+        const auto& entries = (isSorting && sorted.size() == submitted.size()) ? sorted : submitted;
+        for_each_in_pass(packets, entries, pass,
+                         [&](const Packet* previous, const Packet& packet)
+                         {
+                             const bool new_shader = previous == nullptr || previous->Shader != packet.Shader;
+                             if (new_shader)
+                             {
+                                 packet.Shader->Use();
+                             }
+                             if (new_shader || previous->Material != packet.Material)
+                             {
+                                 bind_material(*packet.Shader, packet.Material);
+                             }
+                             // after the material, so the packet has the last word on culling
+                             if (previous == nullptr || ((previous->Flags ^ packet.Flags) & DoubleSided) != 0)
+                             {
+                                 if (packet.Flags & DoubleSided)
+                                     GL::Disable(GL_CULL_FACE);
+                                 else
+                                     GL::Enable(GL_CULL_FACE);
+                             }
+                             if (previous == nullptr || previous->Mesh != packet.Mesh)
+                             {
+                                 packet.Mesh->Use();
+                             }
+                             bind_object(*packet.Shader, packet);
+                             if (packet.IndexCount > 0)
+                                 GLDrawIndexed(*packet.Mesh, packet.IndexCount, packet.FirstIndex);
+                             else
+                                 GLDrawIndexed(*packet.Mesh);
+                         });
+    }
+
+    unsigned RenderQueue::shaderId(const GLShader* shader)
+    {
+        // a frame only uses a handful, a linear search is cheaper than hashing
+        const auto found = std::find(shaders.begin(), shaders.end(), shader);
+        if (found != shaders.end())
+            return static_cast<unsigned>(found - shaders.begin());
+        shaders.push_back(shader);
+        return static_cast<unsigned>(shaders.size() - 1);
+    }
+
+    unsigned RenderQueue::meshId(const GLVertexArray* mesh)
+    {
+        const auto found = std::find(meshes.begin(), meshes.end(), mesh);
+        if (found != meshes.end())
+            return static_cast<unsigned>(found - meshes.begin());
+        meshes.push_back(mesh);
+        return static_cast<unsigned>(meshes.size() - 1);
+    }
+}
@@ -0,0 +1,127 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+class GLShader;
+class GLVertexArray;
+
+namespace graphics
+{
+    // Collects a frame's draws, sorts them so draws that share a shader, material and mesh end up next to each other,
+    // and binds each of those only when it changes.
+    //
+    // The 64 bit sort key, most significant bits first:
+    //   pass 4 | shader 12 | material 16 | double sided 1 | mesh 15 | view depth 16
+    // so passes run in order, and within a pass nearer objects draw first once everything else matches.
+    class RenderQueue
+    {
+    public:
+        enum Flags : std::uint8_t
+        {
+            None        = 0,
+            DoubleSided = 1 << 0 // GL_CULL_FACE is turned off for it
+        };
+
+        struct Packet
+        {
+            const GLShader*      Shader   = nullptr;
+            const GLVertexArray* Mesh     = nullptr;
+            unsigned             Material = 0; // the caller's index, handed back when it has to be bound
+            unsigned             Object   = 0; // the caller's index, handed back with the draw
+            glm::mat4            ModelMatrix{ 1.0f };
+            float                ViewDepth  = 0; // distance from the eye
+            int                  IndexCount = 0; // 0 draws all of Mesh, otherwise this many indices from FirstIndex
+            int                  FirstIndex = 0;
+            std::uint8_t         Flags      = None;
+        };
+
+        // How many times each kind of state was set, the draws themselves are counted by GL::StateCacheCounts
+        struct StateChanges
+        {
+            unsigned Shaders   = 0;
+            unsigned Materials = 0;
+            unsigned Meshes    = 0;
+            unsigned Culling   = 0;
+
+            [[nodiscard]] unsigned Total() const noexcept
+            {
+                return Shaders + Materials + Meshes + Culling;
+            }
+        };
+
+        // Called after the shader is in use: send the material's uniforms, bind its textures.
+        // Culling is set from the packet's flags afterwards, but only when they differ from the previous packet's,
+        // so a material that turns GL_CULL_FACE on or off has to agree with the flags it is submitted with.
+        using BindMaterial = std::function<void(const GLShader& shader, unsigned material)>;
+        // Called right before each draw: send the per object uniforms
+        using BindObject = std::function<void(const GLShader& shader, const Packet& packet)>;
+
+        static constexpr unsigned MaxPasses = 16;
+
+        void Clear() noexcept;
+        void Submit(unsigned pass, const Packet& packet);
+
+        // Sorts and works out the state changes for both the submitted order and the sorted one
+        void Sort();
+
+        // Draws one pass in sorted order, or in submission order when sorting is turned off
+        void Execute(unsigned pass, const BindMaterial& bind_material, const BindObject& bind_object) const;
+
+        void SetSorting(bool enabled) noexcept
+        {
+            isSorting = enabled;
+        }
+
+        [[nodiscard]] bool IsSorting() const noexcept
+        {
+            return isSorting;
+        }
+
+        [[nodiscard]] std::size_t Size() const noexcept
+        {
+            return packets.size();
+        }
+
+        // What drawing in submission order would set
+        [[nodiscard]] const StateChanges& GetUnsortedChanges() const noexcept
+        {
+            return unsortedChanges;
+        }
+
+        // What drawing in key order sets
+        [[nodiscard]] const StateChanges& GetSortedChanges() const noexcept
+        {
+            return sortedChanges;
+        }
+
+    private:
+        struct Entry
+        {
+            std::uint64_t Key   = 0;
+            std::uint32_t Index = 0; // into packets
+        };
+
+        unsigned shaderId(const GLShader* shader);
+        unsigned meshId(const GLVertexArray* mesh);
+
+        std::vector<Packet>               packets;
+        std::vector<Entry>                submitted;
+        std::vector<Entry>                sorted;
+        std::vector<const GLShader*>      shaders;
+        std::vector<const GLVertexArray*> meshes;
+        StateChanges                      unsortedChanges;
+        StateChanges                      sortedChanges;
+        std::uint32_t                     usedPasses = 0; // one bit per pass
+        bool                              isSorting  = true;
+    };
+}
@@ -0,0 +1,265 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "TransformSystem.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#    define TRANSFORM_WITH_SSE
+#    include <xmmintrin.h>
+#endif
+
+namespace
+{
+    constexpr std::size_t Lanes = 4;
+
+    // The inputs of up to four dirty objects side by side, sines and cosines already taken
+    struct LaneInputs
+    {
+        alignas(16) float C1[Lanes], S1[Lanes], C2[Lanes], S2[Lanes], C3[Lanes], S3[Lanes];
+        alignas(16) float PositionX[Lanes], PositionY[Lanes], PositionZ[Lanes];
+        alignas(16) float ScaleX[Lanes], ScaleY[Lanes], ScaleZ[Lanes];
+    };
+
+#if defined(TRANSFORM_WITH_SSE)
+    void store_columns(glm::mat4& first, glm::mat4& second, glm::mat4& third, glm::mat4& fourth, int column, __m128 x, __m128 y, __m128 z, __m128 w) noexcept
+    {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(&first[column][0], x);
+        _mm_storeu_ps(&second[column][0], y);
+        _mm_storeu_ps(&third[column][0], z);
+        _mm_storeu_ps(&fourth[column][0], w);
+    }
+
+    void store_columns(std::span<glm::mat3* const, Lanes> matrices, int column, __m128 x, __m128 y, __m128 z) noexcept
+    {
+        __m128 w = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        const std::array<__m128, Lanes> columns = { x, y, z, w };
+        for (std::size_t lane = 0; lane < Lanes; ++lane)
+        {
+            // a mat3 column is only three floats, so go through memory rather than write past it
+            alignas(16) float values[Lanes];
+            _mm_store_ps(values, columns[lane]);
+            (*matrices[lane])[column] = glm::vec3(values[0], values[1], values[2]);
+        }
+    }
+#endif
+}
+
+namespace graphics
+{
+    void TransformSystem::Clear() noexcept
+    {
+        positionsX.clear();
+        positionsY.clear();
+        positionsZ.clear();
+        anglesX.clear();
+        anglesY.clear();
+        anglesZ.clear();
+        scalesX.clear();
+        scalesY.clear();
+        scalesZ.clear();
+        modelMatrices.clear();
+        normalMatrices.clear();
+        isDirty.clear();
+        dirtyIndices.clear();
+    }
+
+    void TransformSystem::Reserve(std::size_t how_many)
+    {
+        positionsX.reserve(how_many);
+        positionsY.reserve(how_many);
+        positionsZ.reserve(how_many);
+        anglesX.reserve(how_many);
+        anglesY.reserve(how_many);
+        anglesZ.reserve(how_many);
+        scalesX.reserve(how_many);
+        scalesY.reserve(how_many);
+        scalesZ.reserve(how_many);
+        modelMatrices.reserve(how_many);
+        normalMatrices.reserve(how_many);
+        isDirty.reserve(how_many);
+        dirtyIndices.reserve(how_many);
+    }
+
+    std::size_t TransformSystem::Add(glm::vec3 position, glm::vec3 euler_angles, glm::vec3 scale)
+    {
+        const std::size_t index = Size();
+        positionsX.push_back(position.x);
+        positionsY.push_back(position.y);
+        positionsZ.push_back(position.z);
+        anglesX.push_back(euler_angles.x);
+        anglesY.push_back(euler_angles.y);
+        anglesZ.push_back(euler_angles.z);
+        scalesX.push_back(scale.x);
+        scalesY.push_back(scale.y);
+        scalesZ.push_back(scale.z);
+        modelMatrices.emplace_back(1.0f);
+        normalMatrices.emplace_back(1.0f);
+        isDirty.push_back(0);
+        markDirty(index);
+        return index;
+    }
+
+    void TransformSystem::SetPosition(std::size_t index, glm::vec3 position)
+    {
+        if (positionsX[index] == position.x && positionsY[index] == position.y && positionsZ[index] == position.z)
+            return;
+        positionsX[index] = position.x;
+        positionsY[index] = position.y;
+        positionsZ[index] = position.z;
+        markDirty(index);
+    }
+
+    void TransformSystem::SetEulerAngles(std::size_t index, glm::vec3 euler_angles)
+    {
+        if (anglesX[index] == euler_angles.x && anglesY[index] == euler_angles.y && anglesZ[index] == euler_angles.z)
+            return;
+        anglesX[index] = euler_angles.x;
+        anglesY[index] = euler_angles.y;
+        anglesZ[index] = euler_angles.z;
+        markDirty(index);
+    }
+
+    void TransformSystem::SetScale(std::size_t index, glm::vec3 scale)
+    {
+        if (scalesX[index] == scale.x && scalesY[index] == scale.y && scalesZ[index] == scale.z)
+            return;
+        scalesX[index] = scale.x;
+        scalesY[index] = scale.y;
+        scalesZ[index] = scale.z;
+        markDirty(index);
+    }
+
+    glm::vec3 TransformSystem::GetPosition(std::size_t index) const noexcept
+    {
+        return { positionsX[index], positionsY[index], positionsZ[index] };
+    }
+
+    glm::vec3 TransformSystem::GetEulerAngles(std::size_t index) const noexcept
+    {
+        return { anglesX[index], anglesY[index], anglesZ[index] };
+    }
+
+    glm::vec3 TransformSystem::GetScale(std::size_t index) const noexcept
+    {
+        return { scalesX[index], scalesY[index], scalesZ[index] };
+    }
+
+    void TransformSystem::markDirty(std::size_t index)
+    {
+        if (isDirty[index])
+            return;
+        isDirty[index] = 1;
+        dirtyIndices.push_back(static_cast<std::uint32_t>(index));
+    }
+
+    std::size_t TransformSystem::Update()
+    {
+        const std::size_t dirty_count = dirtyIndices.size();
+        for (std::size_t first = 0; first < dirty_count; first += Lanes)
+        {
+            // a short last group repeats its final object, writing the same matrices twice is harmless
+            std::array<std::uint32_t, Lanes> indices{};
+            LaneInputs                       in;
+            for (std::size_t lane = 0; lane < Lanes; ++lane)
+            {
+                const std::uint32_t i = dirtyIndices[std::min(first + lane, dirty_count - 1)];
+                indices[lane]         = i;
+                // same angle convention as graphics::euler_angle_xyz_matrix
+                in.C1[lane]           = std::cos(-anglesX[i]);
+                in.S1[lane]           = std::sin(-anglesX[i]);
+                in.C2[lane]           = std::cos(-anglesY[i]);
+                in.S2[lane]           = std::sin(-anglesY[i]);
+                in.C3[lane]           = std::cos(-anglesZ[i]);
+                in.S3[lane]           = std::sin(-anglesZ[i]);
+                in.PositionX[lane]    = positionsX[i];
+                in.PositionY[lane]    = positionsY[i];
+                in.PositionZ[lane]    = positionsZ[i];
+                in.ScaleX[lane]       = scalesX[i];
+                in.ScaleY[lane]       = scalesY[i];
+                in.ScaleZ[lane]       = scalesZ[i];
+            }
+
+#if defined(TRANSFORM_WITH_SSE)
+            const __m128 c1 = _mm_load_ps(in.C1);
+            const __m128 s1 = _mm_load_ps(in.S1);
+            const __m128 c2 = _mm_load_ps(in.C2);
+            const __m128 s2 = _mm_load_ps(in.S2);
+            const __m128 c3 = _mm_load_ps(in.C3);
+            const __m128 s3 = _mm_load_ps(in.S3);
+
+            const __m128 s1s2 = _mm_mul_ps(s1, s2);
+            const __m128 c1s2 = _mm_mul_ps(c1, s2);
+            // rotation columns, one object per lane
+            const __m128 r00 = _mm_mul_ps(c2, c3);
+            const __m128 r01 = _mm_sub_ps(_mm_mul_ps(s1s2, c3), _mm_mul_ps(c1, s3));
+            const __m128 r02 = _mm_add_ps(_mm_mul_ps(s1, s3), _mm_mul_ps(c1s2, c3));
+            const __m128 r10 = _mm_mul_ps(c2, s3);
+            const __m128 r11 = _mm_add_ps(_mm_mul_ps(c1, c3), _mm_mul_ps(s1s2, s3));
+            const __m128 r12 = _mm_sub_ps(_mm_mul_ps(c1s2, s3), _mm_mul_ps(s1, c3));
+            const __m128 r20 = _mm_sub_ps(_mm_setzero_ps(), s2);
+            const __m128 r21 = _mm_mul_ps(s1, c2);
+            const __m128 r22 = _mm_mul_ps(c1, c2);
+
+            const __m128 sx     = _mm_load_ps(in.ScaleX);
+            const __m128 sy     = _mm_load_ps(in.ScaleY);
+            const __m128 sz     = _mm_load_ps(in.ScaleZ);
+            const __m128 one    = _mm_set1_ps(1.0f);
+            const __m128 zero   = _mm_setzero_ps();
+            const __m128 inv_sx = _mm_div_ps(one, sx);
+            const __m128 inv_sy = _mm_div_ps(one, sy);
+            const __m128 inv_sz = _mm_div_ps(one, sz);
+
+            glm::mat4& m0 = modelMatrices[indices[0]];
+            glm::mat4& m1 = modelMatrices[indices[1]];
+            glm::mat4& m2 = modelMatrices[indices[2]];
+            glm::mat4& m3 = modelMatrices[indices[3]];
+            store_columns(m0, m1, m2, m3, 0, _mm_mul_ps(r00, sx), _mm_mul_ps(r01, sx), _mm_mul_ps(r02, sx), zero);
+            store_columns(m0, m1, m2, m3, 1, _mm_mul_ps(r10, sy), _mm_mul_ps(r11, sy), _mm_mul_ps(r12, sy), zero);
+            store_columns(m0, m1, m2, m3, 2, _mm_mul_ps(r20, sz), _mm_mul_ps(r21, sz), _mm_mul_ps(r22, sz), zero);
+            store_columns(m0, m1, m2, m3, 3, _mm_load_ps(in.PositionX), _mm_load_ps(in.PositionY), _mm_load_ps(in.PositionZ), one);
+
+            const std::array<glm::mat3*, Lanes> normals = { &normalMatrices[indices[0]], &normalMatrices[indices[1]], &normalMatrices[indices[2]], &normalMatrices[indices[3]] };
+            store_columns(normals, 0, _mm_mul_ps(r00, inv_sx), _mm_mul_ps(r01, inv_sx), _mm_mul_ps(r02, inv_sx));
+            store_columns(normals, 1, _mm_mul_ps(r10, inv_sy), _mm_mul_ps(r11, inv_sy), _mm_mul_ps(r12, inv_sy));
+            store_columns(normals, 2, _mm_mul_ps(r20, inv_sz), _mm_mul_ps(r21, inv_sz), _mm_mul_ps(r22, inv_sz));
+#else
+            for (std::size_t lane = 0; lane < Lanes; ++lane)
+            {
+                const float     c1 = in.C1[lane], s1 = in.S1[lane], c2 = in.C2[lane], s2 = in.S2[lane], c3 = in.C3[lane], s3 = in.S3[lane];
+                const glm::vec3 r0{ c2 * c3, -c1 * s3 + s1 * s2 * c3, s1 * s3 + c1 * s2 * c3 };
+                const glm::vec3 r1{ c2 * s3, c1 * c3 + s1 * s2 * s3, -s1 * c3 + c1 * s2 * s3 };
+                const glm::vec3 r2{ -s2, s1 * c2, c1 * c2 };
+                const glm::vec3 scale{ in.ScaleX[lane], in.ScaleY[lane], in.ScaleZ[lane] };
+
+                glm::mat4& model = modelMatrices[indices[lane]];
+                model[0]         = glm::vec4(r0 * scale.x, 0.0f);
+                model[1]         = glm::vec4(r1 * scale.y, 0.0f);
+                model[2]         = glm::vec4(r2 * scale.z, 0.0f);
+                model[3]         = glm::vec4(in.PositionX[lane], in.PositionY[lane], in.PositionZ[lane], 1.0f);
+
+                glm::mat3& normal = normalMatrices[indices[lane]];
+                normal[0]         = r0 / scale.x;
+                normal[1]         = r1 / scale.y;
+                normal[2]         = r2 / scale.z;
+            }
+#endif
+        }
+
+        for (const auto index : dirtyIndices)
+        {
+            isDirty[index] = 0;
+        }
+        dirtyIndices.clear();
+        return dirty_count;
+    }
+}
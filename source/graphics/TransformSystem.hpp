@@ -0,0 +1,84 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+namespace graphics
+{
+    // Positions, Euler angles and scales of many objects kept as separate x, y, z arrays.
+    // Setting any of them to a new value marks the object dirty, Update() then rebuilds the model and normal matrices
+    // of the dirty objects four at a time so every pass of the frame reads the same matrices instead of rebuilding them.
+    // The model matrix is translate * euler_angle_xyz_matrix * scale, the same as the demos used to build by hand.
+    class TransformSystem
+    {
+    public:
+        void Clear() noexcept;
+        void Reserve(std::size_t how_many);
+
+        // Returns the new object's index. Scales must not be zero, the normal matrix divides by them.
+        std::size_t Add(glm::vec3 position, glm::vec3 euler_angles, glm::vec3 scale);
+
+        void SetPosition(std::size_t index, glm::vec3 position);
+        void SetEulerAngles(std::size_t index, glm::vec3 euler_angles);
+        void SetScale(std::size_t index, glm::vec3 scale);
+
+        [[nodiscard]] glm::vec3 GetPosition(std::size_t index) const noexcept;
+        [[nodiscard]] glm::vec3 GetEulerAngles(std::size_t index) const noexcept;
+        [[nodiscard]] glm::vec3 GetScale(std::size_t index) const noexcept;
+
+        // Rebuilds the matrices of everything set since the last call and returns how many objects that was
+        std::size_t Update();
+
+        [[nodiscard]] std::size_t Size() const noexcept
+        {
+            return positionsX.size();
+        }
+
+        [[nodiscard]] const glm::mat4& GetModelMatrix(std::size_t index) const noexcept
+        {
+            return modelMatrices[index];
+        }
+
+        // Inverse transpose of the model matrix's upper 3x3, so normals stay perpendicular under non-uniform scales
+        [[nodiscard]] const glm::mat3& GetNormalMatrix(std::size_t index) const noexcept
+        {
+            return normalMatrices[index];
+        }
+
+        [[nodiscard]] std::span<const glm::mat4> GetModelMatrices() const noexcept
+        {
+            return modelMatrices;
+        }
+
+    private:
+        void markDirty(std::size_t index);
+
+    private:
+        std::vector<float> positionsX;
+        std::vector<float> positionsY;
+        std::vector<float> positionsZ;
+        std::vector<float> anglesX;
+        std::vector<float> anglesY;
+        std::vector<float> anglesZ;
+        std::vector<float> scalesX;
+        std::vector<float> scalesY;
+        std::vector<float> scalesZ;
+
+        std::vector<glm::mat4>     modelMatrices;
+        std::vector<glm::mat3>     normalMatrices;
+        std::vector<std::uint8_t>  isDirty;
+        std::vector<std::uint32_t> dirtyIndices;
+    };
+}
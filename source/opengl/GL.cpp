@@ -8,10 +8,15 @@
 #include "opengl/GL.hpp"
 
 #include <GL/glew.h>
+#include <array>
 #include <cassert>
 #include <iostream>
+#include <map>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 #if defined(_WIN32)
 #    define WIN32_LEAN_AND_MEAN
@@ -153,6 +158,122 @@ namespace
 #    define glCheck(expression)  expression
 #endif
 
+namespace
+{
+    // What GL:: last told OpenGL. An empty optional means we don't know, so the next call always goes through
+    struct StateCache
+    {
+        static constexpr GLuint MAX_TEXTURE_UNITS = 32;
+
+        std::optional<GLuint>                                Program;
+        std::optional<GLuint>                                VertexArray;
+        std::optional<GLuint>                                DrawFramebuffer;
+        std::optional<GLuint>                                ReadFramebuffer;
+        std::optional<GLenum>                                ActiveTexture;
+        std::array<std::map<GLenum, GLuint>, MAX_TEXTURE_UNITS> TextureUnits; // what each target of a unit holds
+        std::map<GLenum, bool>                               Capabilities;
+        std::optional<GLenum>                                CullFace;
+        std::optional<GLenum>                                FrontFace;
+        std::optional<GLboolean>                             DepthMask;
+        std::optional<std::array<GLenum, 2>>                 BlendFunc;
+        std::optional<std::array<GLint, 4>>                  Viewport;
+    };
+
+    StateCache           state_cache;
+    GL::StateCacheCounts state_cache_counts;
+    // a texture never changes its target, so unlike the state cache this survives InvalidateStateCache()
+    std::map<GLuint, GLenum> texture_targets;
+
+    // returns true when the call wouldn't change anything and can be skipped
+    template <typename T>
+    bool is_redundant(std::optional<T>& cached, const T& wanted) noexcept
+    {
+        if (cached == wanted)
+        {
+            ++state_cache_counts.Redundant;
+            return true;
+        }
+        cached = wanted;
+        ++state_cache_counts.Issued;
+        return false;
+    }
+
+    bool is_redundant_capability(GLenum cap, bool enabled)
+    {
+        const auto [cached, inserted] = state_cache.Capabilities.try_emplace(cap, enabled);
+        if (!inserted && cached->second == enabled)
+        {
+            ++state_cache_counts.Redundant;
+            return true;
+        }
+        cached->second = enabled;
+        ++state_cache_counts.Issued;
+        return false;
+    }
+
+    // A unit holds one texture per target, so a bind only replaces what that target had
+    bool is_redundant_texture_binding(GLuint unit, GLenum target, GLuint texture)
+    {
+        if (unit >= StateCache::MAX_TEXTURE_UNITS)
+        {
+            ++state_cache_counts.Issued;
+            return false;
+        }
+        const auto [cached, inserted] = state_cache.TextureUnits[unit].try_emplace(target, texture);
+        if (!inserted && cached->second == texture)
+        {
+            ++state_cache_counts.Redundant;
+            return true;
+        }
+        cached->second = texture;
+        ++state_cache_counts.Issued;
+        return false;
+    }
+
+#if !defined(OPENGL_ES3_ONLY)
+    // glBindTextureUnit takes the target from the texture, and binding 0 resets every target of the unit
+    bool is_redundant_texture_unit_binding(GLuint unit, GLuint texture)
+    {
+        const auto target = texture_targets.find(texture);
+        if (texture != 0 && target != texture_targets.end())
+            return is_redundant_texture_binding(unit, target->second, texture);
+        if (unit < StateCache::MAX_TEXTURE_UNITS)
+            state_cache.TextureUnits[unit].clear();
+        ++state_cache_counts.Issued;
+        return false;
+    }
+
+    constexpr const char* debug_type_name(GLenum type) noexcept
+    {
+        switch (type)
+        {
+            case GL_DEBUG_TYPE_ERROR:
+                return "error";
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+                return "deprecated behavior";
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+                return "undefined behavior";
+            case GL_DEBUG_TYPE_PORTABILITY:
+                return "portability";
+            case GL_DEBUG_TYPE_PERFORMANCE:
+                return "performance";
+            default:
+                return "message";
+        }
+    }
+
+    // may be called from a driver thread
+    void GLAPIENTRY on_debug_message(GLenum, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void*)
+    {
+        if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+            return;
+        std::ostringstream serr;
+        serr << "OpenGL " << debug_type_name(type) << " (" << id << "):\n   " << std::string_view(message, static_cast<std::size_t>(length)) << '\n';
+        std::cerr << serr.str();
+    }
+#endif
+}
+
 
 namespace GL
 {
@@ -188,6 +309,8 @@ namespace GL
 
     void ActiveTexture(GLenum texture SOURCE_LOCATION)
     {
+        if (is_redundant(state_cache.ActiveTexture, texture))
+            return;
         glCheck(glActiveTexture(texture));
     }
 
@@ -203,9 +326,20 @@ namespace GL
 
     void BindTexture(GLenum target, GLuint texture SOURCE_LOCATION)
     {
+        if (texture != 0)
+            texture_targets.try_emplace(texture, target);
+        if (state_cache.ActiveTexture && is_redundant_texture_binding(*state_cache.ActiveTexture - GL_TEXTURE0, target, texture))
+            return;
         glCheck(glBindTexture(target, texture));
     }
 
+    void BlendFunc(GLenum sfactor, GLenum dfactor SOURCE_LOCATION)
+    {
+        if (is_redundant(state_cache.BlendFunc, std::array<GLenum, 2>{ sfactor, dfactor }))
+            return;
+        glCheck(glBlendFunc(sfactor, dfactor));
+    }
+
     void BufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage SOURCE_LOCATION)
     {
         glCheck(glBufferData(target, size, data, usage));
@@ -231,8 +365,15 @@ namespace GL
         glCheck(glCompileShader(shader));
     }
 
+    void CompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data SOURCE_LOCATION)
+    {
+        glCheck(glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data));
+    }
+
     void CullFace(GLenum mode SOURCE_LOCATION)
     {
+        if (is_redundant(state_cache.CullFace, mode))
+            return;
         glCheck(glCullFace(mode));
     }
 
@@ -243,6 +384,8 @@ namespace GL
 
     void DeleteProgram(GLuint program SOURCE_LOCATION)
     {
+        if (state_cache.Program == program)
+            state_cache.Program.reset();
         glCheck(glDeleteProgram(program));
     }
 
@@ -253,21 +396,39 @@ namespace GL
 
     void DeleteTextures(GLsizei n, const GLuint* textures SOURCE_LOCATION)
     {
+        for (const auto texture : std::span(textures, static_cast<std::size_t>(n)))
+        {
+            // deleting a bound texture puts the default one back in its place
+            texture_targets.erase(texture);
+            for (auto& unit : state_cache.TextureUnits)
+            {
+                for (auto& [target, bound] : unit)
+                {
+                    if (bound == texture)
+                        bound = 0u;
+                }
+            }
+        }
         glCheck(glDeleteTextures(n, textures));
     }
 
     void DepthMask(GLboolean flag SOURCE_LOCATION)
     {
+        if (is_redundant(state_cache.DepthMask, flag))
+            return;
         glCheck(glDepthMask(flag));
     }
 
     void Disable(GLenum cap SOURCE_LOCATION)
     {
+        if (is_redundant_capability(cap, false))
+            return;
         glCheck(glDisable(cap));
     }
 
     void DrawArrays(GLenum mode, GLint first, GLsizei count SOURCE_LOCATION)
     {
+        ++state_cache_counts.DrawCalls;
         glCheck(glDrawArrays(mode, first, count));
     }
 
@@ -278,11 +439,14 @@ namespace GL
 
     void DrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices SOURCE_LOCATION)
     {
+        ++state_cache_counts.DrawCalls;
         glCheck(glDrawElements(mode, count, type, indices));
     }
 
     void Enable(GLenum cap SOURCE_LOCATION)
     {
+        if (is_redundant_capability(cap, true))
+            return;
         glCheck(glEnable(cap));
     }
 
@@ -291,8 +455,15 @@ namespace GL
         glCheck(glEnableVertexAttribArray(index));
     }
 
+    void Finish(VOID_SOURCE_LOCATION)
+    {
+        glCheck(glFinish());
+    }
+
     void FrontFace(GLenum mode SOURCE_LOCATION)
     {
+        if (is_redundant(state_cache.FrontFace, mode))
+            return;
         glCheck(glFrontFace(mode));
     }
 
@@ -346,6 +517,11 @@ namespace GL
         glCheck(glGetShaderiv(shader, pname, params));
     }
 
+    void GetShaderSource(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* source SOURCE_LOCATION)
+    {
+        glCheck(glGetShaderSource(shader, bufSize, length, source));
+    }
+
     void GetUniformfv(GLuint program, GLint location, GLfloat* params SOURCE_LOCATION)
     {
         glCheck(glGetUniformfv(program, location, params));
@@ -366,11 +542,21 @@ namespace GL
         glCheck(glLinkProgram(program));
     }
 
+    void PixelStorei(GLenum pname, GLint param SOURCE_LOCATION)
+    {
+        glCheck(glPixelStorei(pname, param));
+    }
+
     void PolygonOffset(GLfloat factor, GLfloat units SOURCE_LOCATION)
     {
         glCheck(glPolygonOffset(factor, units));
     }
 
+    void Scissor(GLint x, GLint y, GLsizei width, GLsizei height SOURCE_LOCATION)
+    {
+        glCheck(glScissor(x, y, width, height));
+    }
+
     void ShaderSource(GLuint shader, GLsizei count, const GLchar** string, const GLint* length SOURCE_LOCATION)
     {
         glCheck(glShaderSource(shader, count, string, length));
@@ -518,6 +704,8 @@ namespace GL
 
     void UseProgram(GLuint program SOURCE_LOCATION)
     {
+        if (is_redundant(state_cache.Program, program))
+            return;
         glCheck(glUseProgram(program));
     }
 
@@ -533,6 +721,8 @@ namespace GL
 
     void Viewport(GLint x, GLint y, GLsizei width, GLsizei height SOURCE_LOCATION)
     {
+        if (is_redundant(state_cache.Viewport, std::array<GLint, 4>{ x, y, width, height }))
+            return;
         glCheck(glViewport(x, y, width, height));
     }
 
@@ -544,21 +734,60 @@ namespace GL
 
     void BindFramebuffer(GLenum target, GLuint framebuffer SOURCE_LOCATION)
     {
+        switch (target)
+        {
+            case GL_DRAW_FRAMEBUFFER:
+                if (is_redundant(state_cache.DrawFramebuffer, framebuffer))
+                    return;
+                break;
+            case GL_READ_FRAMEBUFFER:
+                if (is_redundant(state_cache.ReadFramebuffer, framebuffer))
+                    return;
+                break;
+            default:
+                if (state_cache.DrawFramebuffer == framebuffer && state_cache.ReadFramebuffer == framebuffer)
+                {
+                    ++state_cache_counts.Redundant;
+                    return;
+                }
+                state_cache.DrawFramebuffer = state_cache.ReadFramebuffer = framebuffer;
+                ++state_cache_counts.Issued;
+                break;
+        }
         glCheck(glBindFramebuffer(target, framebuffer));
     }
 
+    void BindBufferBase(GLenum target, GLuint index, GLuint buffer SOURCE_LOCATION)
+    {
+        glCheck(glBindBufferBase(target, index, buffer));
+    }
+
     void BindVertexArray(GLuint array SOURCE_LOCATION)
     {
+        if (is_redundant(state_cache.VertexArray, array))
+            return;
         glCheck(glBindVertexArray(array));
     }
 
     void DeleteFramebuffers(GLsizei n, GLuint* framebuffers SOURCE_LOCATION)
     {
+        for (const auto framebuffer : std::span(framebuffers, static_cast<std::size_t>(n)))
+        {
+            if (state_cache.DrawFramebuffer == framebuffer)
+                state_cache.DrawFramebuffer = 0u;
+            if (state_cache.ReadFramebuffer == framebuffer)
+                state_cache.ReadFramebuffer = 0u;
+        }
         glCheck(glDeleteFramebuffers(n, framebuffers));
     }
 
     void DeleteVertexArrays(GLsizei n, const GLuint* arrays SOURCE_LOCATION)
     {
+        for (const auto array : std::span(arrays, static_cast<std::size_t>(n)))
+        {
+            if (state_cache.VertexArray == array)
+                state_cache.VertexArray = 0u;
+        }
         glCheck(glDeleteVertexArrays(n, arrays));
     }
 
@@ -577,13 +806,98 @@ namespace GL
         glCheck(glGenVertexArrays(n, arrays));
     }
 
+    const GLubyte* GetStringi(GLenum name, GLuint index SOURCE_LOCATION)
+    {
+        glCheck(const auto the_string = glGetStringi(name, index));
+        return the_string;
+    }
+
+    void* MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access SOURCE_LOCATION)
+    {
+        glCheck(const auto mapped = glMapBufferRange(target, offset, length, access));
+        return mapped;
+    }
+
+    GLboolean UnmapBuffer(GLenum target SOURCE_LOCATION)
+    {
+        glCheck(const GLboolean unmapped = glUnmapBuffer(target));
+        return unmapped;
+    }
+
+    GLenum ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout SOURCE_LOCATION)
+    {
+        glCheck(const GLenum result = glClientWaitSync(sync, flags, timeout));
+        return result;
+    }
+
+    void DeleteSync(GLsync sync SOURCE_LOCATION)
+    {
+        glCheck(glDeleteSync(sync));
+    }
+
+    GLsync FenceSync(GLenum condition, GLbitfield flags SOURCE_LOCATION)
+    {
+        glCheck(const GLsync sync = glFenceSync(condition, flags));
+        return sync;
+    }
+
+    void DeleteQueries(GLsizei n, const GLuint* ids SOURCE_LOCATION)
+    {
+        glCheck(glDeleteQueries(n, ids));
+    }
+
+    void GenQueries(GLsizei n, GLuint* ids SOURCE_LOCATION)
+    {
+        glCheck(glGenQueries(n, ids));
+    }
+
+    void GetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params SOURCE_LOCATION)
+    {
+        glCheck(glGetQueryObjectuiv(id, pname, params));
+    }
+
+    void GetActiveUniformBlockiv(GLuint program, GLuint uniformBlockIndex, GLenum pname, GLint* params SOURCE_LOCATION)
+    {
+        glCheck(glGetActiveUniformBlockiv(program, uniformBlockIndex, pname, params));
+    }
+
+    void GetActiveUniformBlockName(GLuint program, GLuint uniformBlockIndex, GLsizei bufSize, GLsizei* length, GLchar* uniformBlockName SOURCE_LOCATION)
+    {
+        glCheck(glGetActiveUniformBlockName(program, uniformBlockIndex, bufSize, length, uniformBlockName));
+    }
+
+    void GetActiveUniformsiv(GLuint program, GLsizei uniformCount, const GLuint* uniformIndices, GLenum pname, GLint* params SOURCE_LOCATION)
+    {
+        glCheck(glGetActiveUniformsiv(program, uniformCount, uniformIndices, pname, params));
+    }
+
     void TexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height SOURCE_LOCATION)
     {
         glCheck(glTexStorage2D(target, levels, internalformat, width, height));
     }
 
+    void VertexAttribDivisor(GLuint index, GLuint divisor SOURCE_LOCATION)
+    {
+        glCheck(glVertexAttribDivisor(index, divisor));
+    }
+
 #if !defined(OPENGL_ES3_ONLY)
 
+    void GetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void* data SOURCE_LOCATION)
+    {
+        glCheck(glGetBufferSubData(target, offset, size, data));
+    }
+
+    void GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params SOURCE_LOCATION)
+    {
+        glCheck(glGetQueryObjectui64v(id, pname, params));
+    }
+
+    void QueryCounter(GLuint id, GLenum target SOURCE_LOCATION)
+    {
+        glCheck(glQueryCounter(id, target));
+    }
+
     void PatchParameteri(GLenum pname, GLint value SOURCE_LOCATION)
     {
         glCheck(glPatchParameteri(pname, value));
@@ -599,11 +913,38 @@ namespace GL
         glCheck(glMemoryBarrier(barriers));
     }
 
+    void ClearBufferData(GLenum target, GLenum internalformat, GLenum format, GLenum type, const void* data SOURCE_LOCATION)
+    {
+        glCheck(glClearBufferData(target, internalformat, format, type, data));
+    }
+
     void DispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z SOURCE_LOCATION)
     {
+        ++state_cache_counts.Dispatches;
         glCheck(glDispatchCompute(num_groups_x, num_groups_y, num_groups_z));
     }
 
+    void GetProgramInterfaceiv(GLuint program, GLenum programInterface, GLenum pname, GLint* params SOURCE_LOCATION)
+    {
+        glCheck(glGetProgramInterfaceiv(program, programInterface, pname, params));
+    }
+
+    void GetProgramResourceiv(GLuint program, GLenum programInterface, GLuint index, GLsizei propCount, const GLenum* props, GLsizei count, GLsizei* length, GLint* params SOURCE_LOCATION)
+    {
+        glCheck(glGetProgramResourceiv(program, programInterface, index, propCount, props, count, length, params));
+    }
+
+    void GetProgramResourceName(GLuint program, GLenum programInterface, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name SOURCE_LOCATION)
+    {
+        glCheck(glGetProgramResourceName(program, programInterface, index, bufSize, length, name));
+    }
+
+    void MultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride SOURCE_LOCATION)
+    {
+        ++state_cache_counts.DrawCalls;
+        glCheck(glMultiDrawElementsIndirect(mode, type, indirect, drawcount, stride));
+    }
+
     GLenum CheckNamedFramebufferStatus(GLuint framebuffer, GLenum target SOURCE_LOCATION)
     {
         glCheck(const GLenum status = glCheckNamedFramebufferStatus(framebuffer, target));
@@ -612,9 +953,16 @@ namespace GL
 
     void BindTextureUnit(GLuint unit, GLuint texture SOURCE_LOCATION)
     {
+        if (is_redundant_texture_unit_binding(unit, texture))
+            return;
         glCheck(glBindTextureUnit(unit, texture));
     }
 
+    void CompressedTextureSubImage2D(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void* data SOURCE_LOCATION)
+    {
+        glCheck(glCompressedTextureSubImage2D(texture, level, xoffset, yoffset, width, height, format, imageSize, data));
+    }
+
     void CreateBuffers(GLsizei n, GLuint* buffers SOURCE_LOCATION)
     {
         glCheck(glCreateBuffers(n, buffers));
@@ -628,6 +976,8 @@ namespace GL
     void CreateTextures(GLenum target, GLsizei n, GLuint* textures SOURCE_LOCATION)
     {
         glCheck(glCreateTextures(target, n, textures));
+        for (const auto texture : std::span(textures, static_cast<std::size_t>(n)))
+            texture_targets.try_emplace(texture, target);
     }
 
     void CreateVertexArrays(GLsizei n, GLuint* arrays SOURCE_LOCATION)
@@ -690,6 +1040,11 @@ namespace GL
         glCheck(glVertexArrayAttribFormat(vaobj, attribindex, size, type, normalized, relativeoffset));
     }
 
+    void VertexArrayBindingDivisor(GLuint vaobj, GLuint bindingindex, GLuint divisor SOURCE_LOCATION)
+    {
+        glCheck(glVertexArrayBindingDivisor(vaobj, bindingindex, divisor));
+    }
+
     void VertexArrayElementBuffer(GLuint vaobj, GLuint buffer SOURCE_LOCATION)
     {
         glCheck(glVertexArrayElementBuffer(vaobj, buffer));
@@ -700,6 +1055,52 @@ namespace GL
         glCheck(glVertexArrayVertexBuffer(vaobj, bindingindex, buffer, offset, stride));
     }
 
+    void MultiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride SOURCE_LOCATION)
+    {
+        ++state_cache_counts.DrawCalls;
+        glCheck(glMultiDrawElementsIndirectCount(mode, type, indirect, drawcount, maxdrawcount, stride));
+    }
+
+    void MaxShaderCompilerThreads(GLuint count SOURCE_LOCATION)
+    {
+        if (GLEW_KHR_parallel_shader_compile)
+        {
+            glCheck(glMaxShaderCompilerThreadsKHR(count));
+        }
+        else
+        {
+            glCheck(glMaxShaderCompilerThreadsARB(count));
+        }
+    }
+
 #endif
 
+    StateCacheCounts GetStateCacheCounts() noexcept
+    {
+        return state_cache_counts;
+    }
+
+    void ResetStateCacheCounts() noexcept
+    {
+        state_cache_counts = StateCacheCounts{};
+    }
+
+    void InvalidateStateCache() noexcept
+    {
+        state_cache = StateCache{};
+    }
+
+    bool InstallDebugMessageCallback()
+    {
+#if !defined(OPENGL_ES3_ONLY)
+        if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+            return false;
+        // left asynchronous on purpose, so the driver never has to stop and report at the call that caused it
+        Enable(GL_DEBUG_OUTPUT);
+        glDebugMessageCallback(on_debug_message, nullptr);
+        return true;
+#else
+        return false;
+#endif
+    }
 }
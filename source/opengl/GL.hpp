@@ -7,6 +7,7 @@
  */
 #pragma once
 #include <cstddef> // for ptrdiff_t
+#include <cstdint> // for uint64_t
 
 typedef unsigned int   GLenum;
 typedef unsigned int   GLbitfield;
@@ -27,10 +28,31 @@ typedef void           GLvoid;
 typedef char           GLchar;
 typedef ptrdiff_t      GLintptr;
 typedef ptrdiff_t      GLsizeiptr;
+typedef std::uint64_t  GLuint64;
+typedef struct __GLsync* GLsync;
+
+// How GL:: reports OpenGL errors, picked at compile time with the GRAPHICS_FUN_GL_CHECKS cmake option
+//   CS250_GL_CHECKS_NONE     - every wrapper just calls OpenGL, nothing is checked
+//   CS250_GL_CHECKS_POLL     - glGetError after every call, reported with the caller's source location
+//   CS250_GL_CHECKS_CALLBACK - the driver reports errors through a KHR_debug callback, so nothing waits on glGetError
+// Without the option, developer builds poll and release builds don't check
+#if !defined(CS250_GL_CHECKS_NONE) && !defined(CS250_GL_CHECKS_POLL) && !defined(CS250_GL_CHECKS_CALLBACK)
+#    if defined(DEVELOPER_VERSION)
+#        define CS250_GL_CHECKS_POLL 1
+#    else
+#        define CS250_GL_CHECKS_NONE 1
+#    endif
+#endif
+
+// WebGL doesn't have KHR_debug
+#if defined(CS250_GL_CHECKS_CALLBACK) && defined(OPENGL_ES3_ONLY)
+#    undef CS250_GL_CHECKS_CALLBACK
+#    define CS250_GL_CHECKS_POLL 1
+#endif
 
 // https://en.cppreference.com/w/cpp/preprocessor/replace#Predefined_macros
 
-#if __cplusplus >= 202002L && defined(DEVELOPER_VERSION)
+#if __cplusplus >= 202002L && defined(CS250_GL_CHECKS_POLL)
 #    include <version> // for __cpp_lib_source_location
 // https://en.cppreference.com/w/cpp/utility/feature_test
 #    if __cpp_lib_source_location >= 201907L
@@ -50,6 +72,14 @@ typedef ptrdiff_t      GLsizeiptr;
 
 namespace GL
 {
+#if defined(CS250_GL_CHECKS_POLL)
+    inline constexpr const char* ErrorCheckMode = "glGetError polling";
+#elif defined(CS250_GL_CHECKS_CALLBACK)
+    inline constexpr const char* ErrorCheckMode = "KHR_debug callback";
+#else
+    inline constexpr const char* ErrorCheckMode = "none";
+#endif
+
     // Opengl Version 2.0
     const GLubyte* GetString(GLenum name SOURCE_LOCATION);
     GLint          GetAttribLocation(GLuint program, const GLchar* name SOURCE_LOCATION);
@@ -60,11 +90,13 @@ namespace GL
     void           AttachShader(GLuint program, GLuint shader SOURCE_LOCATION);
     void           BindBuffer(GLenum target, GLuint buffer SOURCE_LOCATION);
     void           BindTexture(GLenum target, GLuint texture SOURCE_LOCATION);
+    void           BlendFunc(GLenum sfactor, GLenum dfactor SOURCE_LOCATION);
     void           BufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage SOURCE_LOCATION);
     void           BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data SOURCE_LOCATION);
     void           Clear(GLbitfield mask SOURCE_LOCATION);
     void           ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha SOURCE_LOCATION);
     void           CompileShader(GLuint shader SOURCE_LOCATION);
+    void           CompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data SOURCE_LOCATION);
     void           CullFace(GLenum mode SOURCE_LOCATION);
     void           DeleteBuffers(GLsizei n, const GLuint* buffers SOURCE_LOCATION);
     void           DeleteProgram(GLuint program SOURCE_LOCATION);
@@ -77,6 +109,7 @@ namespace GL
     void           DrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices SOURCE_LOCATION);
     void           Enable(GLenum cap SOURCE_LOCATION);
     void           EnableVertexAttribArray(GLuint index SOURCE_LOCATION);
+    void           Finish(VOID_SOURCE_LOCATION);
     void           FrontFace(GLenum mode SOURCE_LOCATION);
     void           GenBuffers(GLsizei n, GLuint* buffers SOURCE_LOCATION);
     void           GenTextures(GLsizei n, GLuint* textures SOURCE_LOCATION);
@@ -88,11 +121,14 @@ namespace GL
     void           GetProgramiv(GLuint program, GLenum pname, GLint* params SOURCE_LOCATION);
     void           GetShaderInfoLog(GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog SOURCE_LOCATION);
     void           GetShaderiv(GLuint shader, GLenum pname, GLint* params SOURCE_LOCATION);
+    void           GetShaderSource(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* source SOURCE_LOCATION);
     void           GetUniformfv(GLuint program, GLint location, GLfloat* params SOURCE_LOCATION);
     void           GetUniformiv(GLuint program, GLint location, GLint* params SOURCE_LOCATION);
     void           GetUniformuiv(GLuint program, GLint location, GLuint* params SOURCE_LOCATION);
     void           LinkProgram(GLuint program SOURCE_LOCATION);
+    void           PixelStorei(GLenum pname, GLint param SOURCE_LOCATION);
     void           PolygonOffset(GLfloat factor, GLfloat units SOURCE_LOCATION);
+    void           Scissor(GLint x, GLint y, GLsizei width, GLsizei height SOURCE_LOCATION);
     void           ShaderSource(GLuint shader, GLsizei count, const GLchar** string, const GLint* length SOURCE_LOCATION);
     void           TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data SOURCE_LOCATION);
     void           TexParameterfv(GLenum target, GLenum pname, const GLfloat* params SOURCE_LOCATION);
@@ -129,19 +165,48 @@ namespace GL
 
 
     // Opengl Version 3.0
-    GLenum CheckFramebufferStatus(GLenum target SOURCE_LOCATION);
-    void   BindFramebuffer(GLenum target, GLuint framebuffer SOURCE_LOCATION);
-    void   BindVertexArray(GLuint array SOURCE_LOCATION);
-    void   DeleteFramebuffers(GLsizei n, GLuint* framebuffers SOURCE_LOCATION);
-    void   DeleteVertexArrays(GLsizei n, const GLuint* arrays SOURCE_LOCATION);
-    void   FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level SOURCE_LOCATION);
-    void   GenFramebuffers(GLsizei n, GLuint* framebuffers SOURCE_LOCATION);
-    void   GenVertexArrays(GLsizei n, GLuint* arrays SOURCE_LOCATION);
+    const GLubyte* GetStringi(GLenum name, GLuint index SOURCE_LOCATION);
+    GLboolean      UnmapBuffer(GLenum target SOURCE_LOCATION);
+    GLenum         CheckFramebufferStatus(GLenum target SOURCE_LOCATION);
+    void*          MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access SOURCE_LOCATION);
+    void           BindBufferBase(GLenum target, GLuint index, GLuint buffer SOURCE_LOCATION);
+    void           BindFramebuffer(GLenum target, GLuint framebuffer SOURCE_LOCATION);
+    void           BindVertexArray(GLuint array SOURCE_LOCATION);
+    void           DeleteFramebuffers(GLsizei n, GLuint* framebuffers SOURCE_LOCATION);
+    void           DeleteVertexArrays(GLsizei n, const GLuint* arrays SOURCE_LOCATION);
+    void           FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level SOURCE_LOCATION);
+    void           GenFramebuffers(GLsizei n, GLuint* framebuffers SOURCE_LOCATION);
+    void           GenVertexArrays(GLsizei n, GLuint* arrays SOURCE_LOCATION);
+
+
+    // Opengl ES 3.0 or Opengl Version 3.2
+    GLenum ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout SOURCE_LOCATION);
+    GLsync FenceSync(GLenum condition, GLbitfield flags SOURCE_LOCATION);
+    void   DeleteSync(GLsync sync SOURCE_LOCATION);
 
+    // Opengl ES 3.0 or Opengl Version 1.5
+    void DeleteQueries(GLsizei n, const GLuint* ids SOURCE_LOCATION);
+    void GenQueries(GLsizei n, GLuint* ids SOURCE_LOCATION);
+    void GetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params SOURCE_LOCATION);
+
+    // Opengl ES 3.0 or Opengl Version 3.1
+    void GetActiveUniformBlockiv(GLuint program, GLuint uniformBlockIndex, GLenum pname, GLint* params SOURCE_LOCATION);
+    void GetActiveUniformBlockName(GLuint program, GLuint uniformBlockIndex, GLsizei bufSize, GLsizei* length, GLchar* uniformBlockName SOURCE_LOCATION);
+    void GetActiveUniformsiv(GLuint program, GLsizei uniformCount, const GLuint* uniformIndices, GLenum pname, GLint* params SOURCE_LOCATION);
 
     // Opengl ES 3.0 or Opengl Version 4.2
     void TexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height SOURCE_LOCATION);
 
+    // Opengl ES 3.0 or Opengl Version 3.3
+    void VertexAttribDivisor(GLuint index, GLuint divisor SOURCE_LOCATION);
+
+
+    // Opengl Version 1.5, not in Opengl ES
+    void GetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void* data SOURCE_LOCATION);
+
+    // Opengl Version 3.3
+    void GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params SOURCE_LOCATION);
+    void QueryCounter(GLuint id, GLenum target SOURCE_LOCATION);
 
     // Opengl Version 4.0
     void PatchParameteri(GLenum pname, GLint value SOURCE_LOCATION);
@@ -151,11 +216,17 @@ namespace GL
     void MemoryBarrier(GLbitfield barriers SOURCE_LOCATION);
 
     // Opengl 4.3
+    void ClearBufferData(GLenum target, GLenum internalformat, GLenum format, GLenum type, const void* data SOURCE_LOCATION);
     void DispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z SOURCE_LOCATION);
+    void GetProgramInterfaceiv(GLuint program, GLenum programInterface, GLenum pname, GLint* params SOURCE_LOCATION);
+    void GetProgramResourceiv(GLuint program, GLenum programInterface, GLuint index, GLsizei propCount, const GLenum* props, GLsizei count, GLsizei* length, GLint* params SOURCE_LOCATION);
+    void GetProgramResourceName(GLuint program, GLenum programInterface, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name SOURCE_LOCATION);
+    void MultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride SOURCE_LOCATION);
 
     // Opengl Version 4.5
     GLenum CheckNamedFramebufferStatus(GLuint framebuffer, GLenum target SOURCE_LOCATION);
     void   BindTextureUnit(GLuint unit, GLuint texture SOURCE_LOCATION);
+    void   CompressedTextureSubImage2D(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void* data SOURCE_LOCATION);
     void   CreateBuffers(GLsizei n, GLuint* buffers SOURCE_LOCATION);
     void   CreateFramebuffers(GLsizei n, GLuint* ids SOURCE_LOCATION);
     void   CreateTextures(GLenum target, GLsizei n, GLuint* textures SOURCE_LOCATION);
@@ -171,9 +242,35 @@ namespace GL
     void   TextureSubImage2D(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels SOURCE_LOCATION);
     void   VertexArrayAttribBinding(GLuint vaobj, GLuint attribindex, GLuint bindingindex SOURCE_LOCATION);
     void   VertexArrayAttribFormat(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset SOURCE_LOCATION);
+    void   VertexArrayBindingDivisor(GLuint vaobj, GLuint bindingindex, GLuint divisor SOURCE_LOCATION);
     void   VertexArrayElementBuffer(GLuint vaobj, GLuint buffer SOURCE_LOCATION);
     void   VertexArrayVertexBuffer(GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride SOURCE_LOCATION);
 
+    // Opengl Version 4.6
+    void MultiDrawElementsIndirectCount(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride SOURCE_LOCATION);
+
+    // KHR_parallel_shader_compile / ARB_parallel_shader_compile
+    void MaxShaderCompilerThreads(GLuint count SOURCE_LOCATION);
+
+
+    // GL.cpp remembers the bound program, vertex array, textures per unit, framebuffers, viewport and cull/depth/blend state
+    // and drops calls that would set what is already set. Draws and dispatches are counted alongside.
+    struct StateCacheCounts
+    {
+        unsigned Issued     = 0;
+        unsigned Redundant  = 0;
+        unsigned DrawCalls  = 0;
+        unsigned Dispatches = 0;
+    };
+
+    [[nodiscard]] StateCacheCounts GetStateCacheCounts() noexcept;
+    void                           ResetStateCacheCounts() noexcept;
+    // Needed after anything changes OpenGL state without going through GL::, like ImGui's renderer
+    void InvalidateStateCache() noexcept;
+
+    // Turns on KHR_debug output and prints the driver's errors and warnings to std::cerr as they happen.
+    // Returns false if the context doesn't support it
+    [[nodiscard]] bool InstallDebugMessageCallback();
 
 }
 
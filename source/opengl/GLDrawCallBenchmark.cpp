@@ -0,0 +1,92 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "GLDrawCallBenchmark.hpp"
+
+#include "GL.hpp"
+#include "GLFrameBuffer.hpp"
+#include "GLShader.hpp"
+#include "GLVertexArray.hpp"
+#include "environment/OpenGL.hpp"
+#include "util/Timer.hpp"
+#include <array>
+#include <glm/vec2.hpp>
+#include <string>
+
+namespace
+{
+    constexpr auto VertexShaderBody = R"(
+uniform vec2 uOffset;
+
+void main()
+{
+    // one small triangle without any vertex buffers
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1)) * 0.01;
+    gl_Position = vec4(corner + uOffset, 0.0, 1.0);
+}
+)";
+
+    constexpr auto FragmentShaderBody = R"(
+out vec4 fFragmentColor;
+
+void main()
+{
+    fFragmentColor = vec4(1.0);
+}
+)";
+
+    std::string with_version(const char* body)
+    {
+        const std::string version = environment::opengl::IsOpenGL_ES ? "#version 300 es\nprecision highp float;\n" : "#version 330 core\n";
+        return version + body;
+    }
+}
+
+GLDrawCallBenchmarkResult GLBenchmarkDrawCalls(int draw_calls)
+{
+    constexpr int TARGET_SIZE = 64;
+    GLFrameBuffer target;
+    target.LoadWithSpecification({ TARGET_SIZE, TARGET_SIZE, GLTexture::DepthComponentSize::None, GLFrameBuffer::RGBA8 });
+
+    const GLShader shader("draw call benchmark", with_version(VertexShaderBody), with_version(FragmentShaderBody));
+    GLVertexArray  triangle;
+    triangle.SetVertexCount(3);
+
+    std::array<GLint, 4> viewport{};
+    GL::GetIntegerv(GL_VIEWPORT, viewport.data());
+
+    target.Use();
+    GL::Viewport(0, 0, TARGET_SIZE, TARGET_SIZE);
+    GL::Clear(GL_COLOR_BUFFER_BIT);
+
+    // warm up so the first draw's driver work doesn't count
+    shader.Use();
+    triangle.Use();
+    GLDrawVertices(triangle);
+    GL::Finish();
+
+    GLDrawCallBenchmarkResult result;
+    result.DrawCalls = draw_calls;
+    const util::Timer timer;
+    for (int i = 0; i < draw_calls; ++i)
+    {
+        // a realistic draw binds something and changes a uniform, the state cache drops the repeated binds
+        shader.Use();
+        shader.SendUniform("uOffset", glm::vec2{ static_cast<float>(i % 100) * 0.02f - 1.0f, static_cast<float>(i / 100 % 100) * 0.02f - 1.0f });
+        triangle.Use();
+        GLDrawVertices(triangle);
+    }
+    result.SubmitSeconds = timer.GetElapsedSeconds();
+    GL::Finish();
+    result.TotalSeconds = timer.GetElapsedSeconds();
+
+    triangle.Use(false);
+    shader.Use(false);
+    target.Use(false);
+    GL::Viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    return result;
+}
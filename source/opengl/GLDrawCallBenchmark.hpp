@@ -0,0 +1,25 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+struct GLDrawCallBenchmarkResult
+{
+    int    DrawCalls     = 0;
+    double SubmitSeconds = 0; // time spent issuing the draws
+    double TotalSeconds  = 0; // issuing plus waiting for the GPU to finish them
+
+    [[nodiscard]] double DrawCallsPerSecond() const noexcept
+    {
+        return (SubmitSeconds > 0) ? DrawCalls / SubmitSeconds : 0;
+    }
+};
+
+// Draws a tiny triangle draw_calls times into a small offscreen framebuffer, changing a uniform between draws,
+// to measure how much each draw costs the CPU with the current GL:: error check mode.
+// Needs a current OpenGL context and leaves the default framebuffer bound
+[[nodiscard]] GLDrawCallBenchmarkResult GLBenchmarkDrawCalls(int draw_calls);
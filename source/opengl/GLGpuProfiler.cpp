@@ -0,0 +1,157 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "GLGpuProfiler.hpp"
+
+#include "GL.hpp"
+#include "environment/OpenGL.hpp"
+#include <GL/glew.h>
+#include <array>
+#include <vector>
+
+namespace
+{
+#if !defined(OPENGL_ES3_ONLY)
+    // the driver may be a couple of frames behind, so each frame's queries are read back FramesInFlight - 1 frames later
+    constexpr int FramesInFlight = 3;
+    constexpr int ScopesPerFrame = 64;
+
+    struct QueryFrame
+    {
+        std::array<GLuint, ScopesPerFrame * 2>    Queries{}; // begin and end of each scope
+        std::array<const char*, ScopesPerFrame>   Names{};
+        std::array<std::uint16_t, ScopesPerFrame> Depths{};
+        int                                       ScopeCount      = 0;
+        int                                       LastQueryIssued = 0;
+        std::int64_t                              CpuBegin        = 0; // the GPU clock is lined up with the CPU time of the first scope
+        std::uint64_t                             FrameNumber     = 0; // the profiler's frame it was recorded in
+    };
+
+    std::array<QueryFrame, FramesInFlight> query_frames{};
+    int                                    current_frame = 0;
+    std::uint16_t                          gpu_depth     = 0;
+    std::uint16_t                          gpu_track     = 0;
+    bool                                   has_queries   = false;
+
+    bool can_time_gpu()
+    {
+        if (!util::get_profiler().IsEnabled())
+            return false;
+        IF_CAN_DO_OPENGL(3, 3)
+        {
+            if (!has_queries)
+            {
+                for (auto& frame : query_frames)
+                {
+                    GL::GenQueries(static_cast<GLsizei>(frame.Queries.size()), frame.Queries.data());
+                }
+                gpu_track   = util::get_profiler().AddTrack("GPU");
+                has_queries = true;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void read_back(const QueryFrame& frame)
+    {
+        GLuint is_available = GL_FALSE;
+        GL::GetQueryObjectuiv(frame.Queries[static_cast<std::size_t>(frame.LastQueryIssued)], GL_QUERY_RESULT_AVAILABLE, &is_available);
+        if (is_available == GL_FALSE)
+        {
+            // skip this frame rather than wait for it
+            return;
+        }
+        std::vector<util::ProfileEvent> events(static_cast<std::size_t>(frame.ScopeCount));
+        GLuint64                        first_timestamp = 0;
+        for (std::size_t i = 0; i < events.size(); ++i)
+        {
+            GLuint64 begin = 0;
+            GLuint64 end   = 0;
+            GL::GetQueryObjectui64v(frame.Queries[i * 2], GL_QUERY_RESULT, &begin);
+            GL::GetQueryObjectui64v(frame.Queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+            if (i == 0)
+                first_timestamp = begin;
+            events[i] = { frame.Names[i], frame.CpuBegin + static_cast<std::int64_t>(begin - first_timestamp), frame.CpuBegin + static_cast<std::int64_t>(end - first_timestamp),
+                          frame.Depths[i], gpu_track };
+        }
+        util::get_profiler().AddEvents(events, frame.FrameNumber);
+    }
+#endif
+}
+
+GLProfileScope::GLProfileScope(const char* scope_name)
+    : cpu_scope(scope_name)
+{
+#if !defined(OPENGL_ES3_ONLY)
+    if (!can_time_gpu())
+        return;
+    auto& frame = query_frames[static_cast<std::size_t>(current_frame)];
+    if (frame.ScopeCount >= ScopesPerFrame)
+        return;
+    if (frame.ScopeCount == 0)
+    {
+        frame.CpuBegin    = util::get_profiler().Now();
+        frame.FrameNumber = util::get_profiler().GetFrameNumber();
+    }
+    scope_index           = frame.ScopeCount++;
+    const auto index      = static_cast<std::size_t>(scope_index);
+    frame.Names[index]    = scope_name;
+    frame.Depths[index]   = gpu_depth++;
+    frame.LastQueryIssued = scope_index * 2;
+    GL::QueryCounter(frame.Queries[static_cast<std::size_t>(frame.LastQueryIssued)], GL_TIMESTAMP);
+#endif
+}
+
+GLProfileScope::~GLProfileScope()
+{
+#if !defined(OPENGL_ES3_ONLY)
+    if (scope_index < 0)
+        return;
+    auto& frame = query_frames[static_cast<std::size_t>(current_frame)];
+    --gpu_depth;
+    frame.LastQueryIssued = scope_index * 2 + 1;
+    GL::QueryCounter(frame.Queries[static_cast<std::size_t>(frame.LastQueryIssued)], GL_TIMESTAMP);
+#endif
+}
+
+void GLProfilerEndFrame()
+{
+#if !defined(OPENGL_ES3_ONLY)
+    if (!has_queries)
+        return;
+    // the oldest frame gets recorded over next, so read what it has now
+    current_frame = (current_frame + 1) % FramesInFlight;
+    auto& frame   = query_frames[static_cast<std::size_t>(current_frame)];
+    if (frame.ScopeCount > 0)
+        read_back(frame);
+    frame.ScopeCount = 0;
+#endif
+}
+
+int GLProfilerFramesBehind() noexcept
+{
+#if !defined(OPENGL_ES3_ONLY)
+    return FramesInFlight - 1;
+#else
+    return 0;
+#endif
+}
+
+void GLProfilerShutdown()
+{
+#if !defined(OPENGL_ES3_ONLY)
+    if (!has_queries)
+        return;
+    for (auto& frame : query_frames)
+    {
+        GL::DeleteQueries(static_cast<GLsizei>(frame.Queries.size()), frame.Queries.data());
+        frame.ScopeCount = 0;
+    }
+    has_queries = false;
+#endif
+}
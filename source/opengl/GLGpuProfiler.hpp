@@ -0,0 +1,39 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include "util/Profiler.hpp"
+
+// Times a CPU scope like util::ProfileScope and the GPU work issued inside it with a pair of GL_TIMESTAMP queries.
+// The GPU times are read back a few frames later, only once the driver says they are available so profiling never
+// makes the CPU wait for the GPU, and then show up on a "GPU" track of the profiler's frame they were recorded in.
+// On OpenGL ES and before OpenGL 3.3 only the CPU side is timed.
+class [[nodiscard]] GLProfileScope
+{
+public:
+    explicit GLProfileScope(const char* scope_name);
+    ~GLProfileScope();
+
+    GLProfileScope(const GLProfileScope&)            = delete;
+    GLProfileScope& operator=(const GLProfileScope&) = delete;
+    GLProfileScope(GLProfileScope&&)                 = delete;
+    GLProfileScope& operator=(GLProfileScope&&)      = delete;
+
+private:
+    util::ProfileScope cpu_scope;
+    int                scope_index = -1; // -1 when the GPU isn't being timed
+};
+
+// Call once a frame after the last GLProfileScope, before util::get_profiler().EndFrame()
+void GLProfilerEndFrame();
+
+// How many frames old the last profiler frame with its GPU times filled in is
+[[nodiscard]] int GLProfilerFramesBehind() noexcept;
+
+// Deletes the queries, call it while the OpenGL context is still around
+void GLProfilerShutdown();
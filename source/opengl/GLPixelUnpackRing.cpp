@@ -0,0 +1,76 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "GLPixelUnpackRing.hpp"
+
+#include "GL.hpp"
+#include <cassert>
+
+GLPixelUnpackRing::GLPixelUnpackRing()
+{
+    for (auto& slot : slots)
+    {
+        GL::GenBuffers(1, &slot.Buffer);
+        GL::BindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.Buffer);
+        GL::BufferData(GL_PIXEL_UNPACK_BUFFER, SlotSizeBytes, nullptr, GL_STREAM_DRAW);
+    }
+    GL::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+GLPixelUnpackRing::~GLPixelUnpackRing()
+{
+    for (auto& slot : slots)
+    {
+        if (slot.Fence != nullptr)
+        {
+            GL::DeleteSync(slot.Fence);
+        }
+        GL::DeleteBuffers(1, &slot.Buffer);
+    }
+}
+
+std::byte* GLPixelUnpackRing::MapNext(GLsizeiptr size_bytes)
+{
+    assert(mapped_slot < 0 && size_bytes <= SlotSizeBytes);
+    Slot& slot = slots[static_cast<std::size_t>(next_slot)];
+    if (slot.Fence != nullptr)
+    {
+        // poll first so we only count the times we actually had to wait
+        constexpr GLuint64 ONE_SECOND = 1'000'000'000;
+        GLenum             status     = GL::ClientWaitSync(slot.Fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            ++stall_count;
+            do
+            {
+                status = GL::ClientWaitSync(slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, ONE_SECOND);
+            } while (status == GL_TIMEOUT_EXPIRED);
+        }
+        GL::DeleteSync(slot.Fence);
+        slot.Fence = nullptr;
+    }
+
+    mapped_slot = next_slot;
+    next_slot   = (next_slot + 1) % SlotCount;
+    GL::BindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.Buffer);
+    // the fence already told us the GPU is done with this buffer, so there is no need for the driver to synchronize again
+    return static_cast<std::byte*>(GL::MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size_bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+}
+
+bool GLPixelUnpackRing::Unmap()
+{
+    return GL::UnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+}
+
+void GLPixelUnpackRing::Release()
+{
+    if (mapped_slot < 0)
+        return;
+    slots[static_cast<std::size_t>(mapped_slot)].Fence = GL::FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    mapped_slot                                        = -1;
+    GL::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
@@ -0,0 +1,60 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include "GLHandle.hpp"
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+
+// A few GL_PIXEL_UNPACK_BUFFER buffers used round robin to stream pixels into textures.
+// Each buffer gets a fence after the upload that reads from it, so the CPU only waits on the GPU when it laps the ring,
+// and the staging memory never grows past SlotCount * SlotSizeBytes no matter how big the texture is.
+//
+//     std::byte* pixels = ring.MapNext(bytes);   // write the pixels here
+//     ring.Unmap();                              // still bound, so TexSubImage2D(..., nullptr) reads from the buffer
+//     GL::TexSubImage2D(..., nullptr);
+//     ring.Release();                            // fences the upload and unbinds
+class [[nodiscard]] GLPixelUnpackRing
+{
+public:
+    static constexpr int        SlotCount     = 4;
+    static constexpr GLsizeiptr SlotSizeBytes = 4 * 1024 * 1024;
+
+    GLPixelUnpackRing();
+    ~GLPixelUnpackRing();
+
+    GLPixelUnpackRing(const GLPixelUnpackRing&)            = delete;
+    GLPixelUnpackRing& operator=(const GLPixelUnpackRing&) = delete;
+    GLPixelUnpackRing(GLPixelUnpackRing&&)                 = delete;
+    GLPixelUnpackRing& operator=(GLPixelUnpackRing&&)      = delete;
+
+    // size_bytes can't be more than SlotSizeBytes. Returns null if the driver couldn't map the buffer
+    [[nodiscard]] std::byte* MapNext(GLsizeiptr size_bytes);
+    // Returns false if the driver lost the buffer contents while it was mapped and they have to be sent again
+    [[nodiscard]] bool Unmap();
+    void               Release();
+
+    // How many times MapNext had to wait for the GPU to finish with a buffer
+    [[nodiscard]] unsigned GetStallCount() const noexcept
+    {
+        return stall_count;
+    }
+
+private:
+    struct Slot
+    {
+        GLHandle Buffer = 0;
+        GLsync   Fence  = nullptr;
+    };
+
+    std::array<Slot, SlotCount> slots{};
+    int                         next_slot   = 0;
+    int                         mapped_slot = -1;
+    unsigned                    stall_count = 0;
+};
@@ -0,0 +1,283 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "GLProgramReflection.hpp"
+
+#include "GL.hpp"
+#include "environment/OpenGL.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <gsl/gsl>
+#include <map>
+#include <numeric>
+
+namespace
+{
+    // Everything about an interface that doesn't depend on the linker's choices: names, types, sizes, blocks and defaults.
+    // Kept while at least one program linked from the same sources is alive.
+    struct CachedInterface
+    {
+        GLProgramReflection Interface{};
+        unsigned            Programs = 0;
+    };
+
+    std::map<std::uint64_t, CachedInterface> cached_interfaces;
+
+    std::string get_resource_name([[maybe_unused]] GLHandle program_handle, [[maybe_unused]] GLenum program_interface, [[maybe_unused]] GLuint index, GLint name_length)
+    {
+        // the length includes the null terminator
+        std::string name(static_cast<std::string::size_type>(name_length), '\0');
+#if !defined(OPENGL_ES3_ONLY)
+        GLsizei written = 0;
+        GL::GetProgramResourceName(program_handle, program_interface, index, name_length, &written, name.data());
+        name.resize(static_cast<std::string::size_type>(written));
+#endif
+        return name;
+    }
+
+    // https://docs.gl/gl4/glGetProgramResource - reference
+    // One glGetProgramResourceiv per resource returns everything but the name, on OpenGL 4.3 and up
+    void query_with_program_interface([[maybe_unused]] GLHandle program_handle, [[maybe_unused]] GLProgramReflection& reflection)
+    {
+#if !defined(OPENGL_ES3_ONLY)
+        GLint count = 0;
+        GL::GetProgramInterfaceiv(program_handle, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+        reflection.Uniforms.resize(gsl::narrow<std::size_t>(count));
+        for (GLuint i = 0; i < static_cast<GLuint>(count); ++i)
+        {
+            constexpr std::array<GLenum, 5> properties = { GL_NAME_LENGTH, GL_TYPE, GL_ARRAY_SIZE, GL_LOCATION, GL_BLOCK_INDEX };
+            std::array<GLint, properties.size()> values{};
+            GL::GetProgramResourceiv(program_handle, GL_UNIFORM, i, static_cast<GLsizei>(properties.size()), properties.data(), static_cast<GLsizei>(values.size()), nullptr, values.data());
+            auto& uniform      = reflection.Uniforms[i];
+            uniform.Name       = get_resource_name(program_handle, GL_UNIFORM, i, values[0]);
+            uniform.Type       = static_cast<GLenum>(values[1]);
+            uniform.ArraySize  = values[2];
+            uniform.Location   = values[3];
+            uniform.BlockIndex = values[4];
+        }
+
+        GL::GetProgramInterfaceiv(program_handle, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &count);
+        reflection.UniformBlocks.resize(gsl::narrow<std::size_t>(count));
+        for (GLuint i = 0; i < static_cast<GLuint>(count); ++i)
+        {
+            constexpr std::array<GLenum, 4> properties = { GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE, GL_NUM_ACTIVE_VARIABLES };
+            std::array<GLint, properties.size()> values{};
+            GL::GetProgramResourceiv(program_handle, GL_UNIFORM_BLOCK, i, static_cast<GLsizei>(properties.size()), properties.data(), static_cast<GLsizei>(values.size()), nullptr, values.data());
+            auto& block           = reflection.UniformBlocks[i];
+            block.Name            = get_resource_name(program_handle, GL_UNIFORM_BLOCK, i, values[0]);
+            block.Binding         = values[1];
+            block.DataSize        = values[2];
+            block.ActiveVariables = values[3];
+        }
+
+        GL::GetProgramInterfaceiv(program_handle, GL_PROGRAM_INPUT, GL_ACTIVE_RESOURCES, &count);
+        reflection.Attributes.resize(gsl::narrow<std::size_t>(count));
+        for (GLuint i = 0; i < static_cast<GLuint>(count); ++i)
+        {
+            constexpr std::array<GLenum, 4> properties = { GL_NAME_LENGTH, GL_TYPE, GL_ARRAY_SIZE, GL_LOCATION };
+            std::array<GLint, properties.size()> values{};
+            GL::GetProgramResourceiv(program_handle, GL_PROGRAM_INPUT, i, static_cast<GLsizei>(properties.size()), properties.data(), static_cast<GLsizei>(values.size()), nullptr, values.data());
+            auto& attribute     = reflection.Attributes[i];
+            attribute.Name      = get_resource_name(program_handle, GL_PROGRAM_INPUT, i, values[0]);
+            attribute.Type      = static_cast<GLenum>(values[1]);
+            attribute.ArraySize = values[2];
+            attribute.Location  = values[3];
+        }
+#endif
+    }
+
+    // https://docs.gl/es3/glGetActiveUniformsiv - reference
+    // OpenGL ES and contexts before 4.3 get the block indices in one call, everything else a resource at a time
+    void query_with_get_active(GLHandle program_handle, GLProgramReflection& reflection)
+    {
+        GLint max_length = 0;
+        GLint count      = 0;
+        GL::GetProgramiv(program_handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+        GL::GetProgramiv(program_handle, GL_ACTIVE_UNIFORMS, &count);
+        std::string name;
+        if (count > 0)
+        {
+            std::vector<GLuint> indices(gsl::narrow<std::size_t>(count));
+            std::iota(std::begin(indices), std::end(indices), 0u);
+            std::vector<GLint> block_indices(indices.size());
+            GL::GetActiveUniformsiv(program_handle, count, indices.data(), GL_UNIFORM_BLOCK_INDEX, block_indices.data());
+            reflection.Uniforms.resize(indices.size());
+            for (const auto i : indices)
+            {
+                auto&   uniform = reflection.Uniforms[i];
+                GLsizei written = 0;
+                name.resize(static_cast<std::string::size_type>(max_length) + 1);
+                GL::GetActiveUniform(program_handle, i, max_length, &written, &uniform.ArraySize, &uniform.Type, name.data());
+                uniform.Name.assign(name.data(), static_cast<std::string::size_type>(written));
+                uniform.BlockIndex = block_indices[i];
+                // uniform block members don't have a location, no need to ask
+                if (uniform.BlockIndex < 0)
+                    uniform.Location = GL::GetUniformLocation(program_handle, uniform.Name.c_str());
+            }
+        }
+
+        GL::GetProgramiv(program_handle, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &max_length);
+        GL::GetProgramiv(program_handle, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+        reflection.UniformBlocks.resize(gsl::narrow<std::size_t>(std::max(count, 0)));
+        for (GLuint i = 0; i < static_cast<GLuint>(count); ++i)
+        {
+            auto&   block   = reflection.UniformBlocks[i];
+            GLsizei written = 0;
+            name.resize(static_cast<std::string::size_type>(max_length) + 1);
+            GL::GetActiveUniformBlockName(program_handle, i, max_length, &written, name.data());
+            block.Name.assign(name.data(), static_cast<std::string::size_type>(written));
+            GL::GetActiveUniformBlockiv(program_handle, i, GL_UNIFORM_BLOCK_BINDING, &block.Binding);
+            GL::GetActiveUniformBlockiv(program_handle, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.DataSize);
+            GL::GetActiveUniformBlockiv(program_handle, i, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &block.ActiveVariables);
+        }
+
+        // https://docs.gl/es3/glGetActiveAttrib - reference
+        GL::GetProgramiv(program_handle, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_length);
+        GL::GetProgramiv(program_handle, GL_ACTIVE_ATTRIBUTES, &count);
+        for (GLuint i = 0; i < static_cast<GLuint>(count); ++i)
+        {
+            GLsizei written = 0;
+            GLint   size    = 0;
+            GLenum  type    = 0;
+            name.resize(static_cast<std::string::size_type>(max_length) + 1);
+            GL::GetActiveAttrib(program_handle, i, max_length, &written, &size, &type, name.data());
+            name.resize(static_cast<std::string::size_type>(written));
+            const GLint location = GL::GetAttribLocation(program_handle, name.c_str());
+            reflection.Attributes.push_back({ name, type, size, location });
+        }
+    }
+
+    // The linker picks the locations, so another program linked from the same sources can end up with different ones
+    void query_locations(GLHandle program_handle, GLProgramReflection& reflection)
+    {
+        for (auto& uniform : reflection.Uniforms)
+        {
+            if (uniform.BlockIndex < 0)
+                uniform.Location = GL::GetUniformLocation(program_handle, uniform.Name.c_str());
+        }
+        for (auto& attribute : reflection.Attributes)
+        {
+            attribute.Location = GL::GetAttribLocation(program_handle, attribute.Name.c_str());
+        }
+    }
+
+    [[nodiscard]] bool contains_word(std::string_view text, std::string_view word) noexcept
+    {
+        const auto is_identifier = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_'; };
+        for (auto position = text.find(word); position != std::string_view::npos; position = text.find(word, position + 1))
+        {
+            const auto after = position + word.size();
+            if ((position == 0 || !is_identifier(text[position - 1])) && (after == text.size() || !is_identifier(text[after])))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The statements like `uniform float uScale = 2.0;` or `layout(binding = 1) uniform sampler2D uTexture;`
+    // Anything else in the default block is zero after linking, so it doesn't have to be read back
+    [[nodiscard]] std::vector<std::string_view> find_initialized_declarations(std::span<const std::string_view> glsl_texts)
+    {
+        std::vector<std::string_view> declarations;
+        for (const auto glsl_text : glsl_texts)
+        {
+            std::string_view::size_type begin = 0;
+            while (begin < glsl_text.size())
+            {
+                const auto end       = std::min(glsl_text.find(';', begin), glsl_text.size());
+                const auto statement = glsl_text.substr(begin, end - begin);
+                if (statement.find('=') != std::string_view::npos && contains_word(statement, "uniform"))
+                {
+                    declarations.push_back(statement);
+                }
+                begin = end + 1;
+            }
+        }
+        return declarations;
+    }
+
+    // as of 2/20/2024 GetUniformfv is unreliable through Emscripten, so the web build keeps zero defaults
+    void read_default_values([[maybe_unused]] GLHandle program_handle, [[maybe_unused]] GLProgramReflection& reflection, [[maybe_unused]] std::span<const std::string_view> glsl_texts)
+    {
+#if !defined(OPENGL_ES3_ONLY)
+        const auto declarations = find_initialized_declarations(glsl_texts);
+        for (auto& uniform : reflection.Uniforms)
+        {
+            if (uniform.Location < 0)
+                continue;
+            // arrays are reported as name[0] and struct members as name.member
+            const auto variable_name = std::string_view(uniform.Name).substr(0, uniform.Name.find_first_of("[."));
+            if (std::none_of(std::begin(declarations), std::end(declarations), [&](std::string_view declaration) { return contains_word(declaration, variable_name); }))
+                continue;
+            switch (uniform.Type)
+            {
+                case GL_FLOAT:
+                case GL_FLOAT_VEC2:
+                case GL_FLOAT_VEC3:
+                case GL_FLOAT_VEC4:
+                case GL_FLOAT_MAT2:
+                case GL_FLOAT_MAT3:
+                case GL_FLOAT_MAT4:
+                case GL_FLOAT_MAT2x3:
+                case GL_FLOAT_MAT2x4:
+                case GL_FLOAT_MAT3x2:
+                case GL_FLOAT_MAT3x4:
+                case GL_FLOAT_MAT4x2:
+                case GL_FLOAT_MAT4x3:
+                    GL::GetUniformfv(program_handle, uniform.Location, uniform.DefaultValue.Floats);
+                    break;
+                case GL_UNSIGNED_INT:
+                case GL_UNSIGNED_INT_VEC2:
+                case GL_UNSIGNED_INT_VEC3:
+                case GL_UNSIGNED_INT_VEC4:
+                    GL::GetUniformuiv(program_handle, uniform.Location, uniform.DefaultValue.Uints);
+                    break;
+                default:
+                    // ints, bools, samplers and images
+                    GL::GetUniformiv(program_handle, uniform.Location, uniform.DefaultValue.Ints);
+                    break;
+            }
+        }
+#endif
+    }
+}
+
+std::shared_ptr<const GLProgramReflection> reflect_program(GLHandle program_handle, std::uint64_t source_hash, std::span<const std::string_view> glsl_texts)
+{
+    auto& cached = cached_interfaces[source_hash];
+    if (cached.Programs++ == 0)
+    {
+        auto& reflection      = cached.Interface;
+        reflection            = GLProgramReflection{};
+        reflection.SourceHash = source_hash;
+        IF_CAN_DO_OPENGL(4, 3)
+        {
+            query_with_program_interface(program_handle, reflection);
+        }
+        else
+        {
+            query_with_get_active(program_handle, reflection);
+        }
+        read_default_values(program_handle, reflection, glsl_texts);
+        return std::make_shared<const GLProgramReflection>(reflection);
+    }
+
+    auto reflection = std::make_shared<GLProgramReflection>(cached.Interface);
+    query_locations(program_handle, *reflection);
+    return reflection;
+}
+
+void release_program_reflection(std::uint64_t source_hash) noexcept
+{
+    if (const auto found = cached_interfaces.find(source_hash); found != cached_interfaces.end() && --found->second.Programs == 0)
+    {
+        cached_interfaces.erase(found);
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include "GLHandle.hpp"
+#include <GL/glew.h>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct GLProgramReflection
+{
+    union UniformValue
+    {
+        GLfloat Floats[16];
+        GLint   Ints[16];
+        GLuint  Uints[16];
+    };
+
+    struct Uniform
+    {
+        std::string  Name{};
+        GLenum       Type       = 0;
+        GLint        ArraySize  = 1;
+        GLint        Location   = -1; // uniform block members don't have a location
+        GLint        BlockIndex = -1; // into UniformBlocks, -1 for the default block
+        UniformValue DefaultValue{}; // the value right after linking, left as zeros on OpenGL ES
+    };
+
+    struct UniformBlock
+    {
+        std::string Name{};
+        GLint       Binding         = 0;
+        GLint       DataSize        = 0;
+        GLint       ActiveVariables = 0;
+    };
+
+    struct Attribute
+    {
+        std::string Name{};
+        GLenum      Type      = 0;
+        GLint       ArraySize = 1;
+        GLint       Location  = -1;
+    };
+
+    std::uint64_t             SourceHash = 0; // hash of the stage sources the program was linked from
+    std::vector<Uniform>      Uniforms{};
+    std::vector<UniformBlock> UniformBlocks{};
+    std::vector<Attribute>    Attributes{};
+};
+
+// Every active uniform, uniform block and vertex attribute of a program, meant to be called right after it links
+// so the default values are the glsl initializers and not something sent since.
+// On OpenGL 4.3 and up each resource is read with one glGetProgramResourceiv, OpenGL ES and older contexts use the glGetActive* queries.
+// Default block uniforms link as zero unless the glsl gives them an initializer or a binding,
+// so only those are read back, which is why the stage sources are passed in.
+// The names, types, blocks and defaults are cached by source_hash. The linker may place uniforms and attributes differently
+// in every program, so the other programs built from the same sources only look up their own locations.
+[[nodiscard]] std::shared_ptr<const GLProgramReflection> reflect_program(GLHandle program_handle, std::uint64_t source_hash, std::span<const std::string_view> glsl_texts);
+
+// Call once for every reflect_program(), the cached interface is dropped with the last program using it
+void release_program_reflection(std::uint64_t source_hash) noexcept;
@@ -9,10 +9,11 @@
 
 
 #include "GL.hpp"
-#include "assets/Path.hpp"
+#include "assets/ShaderSource.hpp"
 #include "environment/OpenGL.hpp"
+#include "util/ContentHash.hpp"
 #include <algorithm>
-#include <fstream>
+#include <array>
 #include <gsl/gsl>
 #include <iostream>
 #include <span>
@@ -110,7 +111,8 @@ namespace
         }
     }
 
-    [[nodiscard]] bool Compile(GLuint& shader, GLShader::Type type, std::string_view glsl_text, std::string& error_log)
+    // Only hands the source to the driver, it may compile it in the background until the status is queried
+    [[nodiscard]] bool SubmitCompile(GLuint& shader, GLShader::Type type, std::string_view glsl_text, std::string& error_log)
     {
         if (shader <= 0)
         {
@@ -126,7 +128,11 @@ namespace
         GLchar const* source[]{ get_glsl_version_macro(), glsl_text.data() + get_offset_after_version(glsl_text) };
         GL::ShaderSource(shader, 2, source, nullptr);
         GL::CompileShader(shader);
+        return true;
+    }
 
+    [[nodiscard]] bool CheckCompileStatus(GLuint shader, std::string& error_log)
+    {
         GLint is_compiled = 0;
         GL::GetShaderiv(shader, GL_COMPILE_STATUS, &is_compiled);
         if (is_compiled == GL_FALSE)
@@ -135,36 +141,20 @@ namespace
             GL::GetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
             error_log.resize(static_cast<std::string::size_type>(log_length) + 1);
             GL::GetShaderInfoLog(shader, log_length, nullptr, error_log.data());
-            GL::DeleteShader(shader);
-            shader = 0;
+            GLint source_length = 0;
+            GL::GetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &source_length);
+            std::string glsl_text(static_cast<std::string::size_type>(source_length) + 1, '\0');
+            GL::GetShaderSource(shader, source_length, nullptr, glsl_text.data());
+            gsl::czstring source[]{ glsl_text.c_str() };
             print_glsl_text(source);
             return false;
         }
         return true;
     }
 
-    [[nodiscard]] bool Compile(GLuint& shader, GLShader::Type type, std::filesystem::path file_path, std::string& error_log)
+    [[nodiscard]] bool Compile(GLuint& shader, GLShader::Type type, std::string_view glsl_text, std::string& error_log)
     {
-        if (!std::filesystem::exists(file_path))
-        {
-            // try prepending the asset directory path
-            file_path = assets::get_base_path() / file_path;
-            if (!std::filesystem::exists(file_path))
-            {
-                error_log = "Cannot find " + file_path.string() + "\n";
-                return false;
-            }
-        }
-        std::ifstream ifs(file_path, std::ios::in);
-        if (!ifs)
-        {
-            error_log = "Cannot open " + file_path.string() + "\n";
-            return false;
-        }
-        std::string glsl_text;
-        glsl_text.reserve(gsl::narrow<std::size_t>(std::filesystem::file_size(file_path)));
-        std::copy((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>(), std::back_insert_iterator(glsl_text));
-        return Compile(shader, type, std::string_view(glsl_text), error_log);
+        return SubmitCompile(shader, type, glsl_text, error_log) && CheckCompileStatus(shader, error_log);
     }
 
     GLShader::Type shader_type_from_extension(const std::filesystem::path& file_path) noexcept
@@ -187,41 +177,103 @@ namespace
                 return GLShader::VERTEX;
         }
     }
+
+    std::vector<GLShader::Stage> prepare_stages(std::span<const std::filesystem::path> shader_paths)
+    {
+        std::vector<GLShader::Stage> stages;
+        std::string                  error;
+        if (!GLShader::PrepareStages(shader_paths, stages, error))
+        {
+            throw std::runtime_error(error);
+        }
+        return stages;
+    }
 }
 
-GLShader::GLShader(std::string_view the_shader_name, const std::initializer_list<std::filesystem::path>& shader_paths)
-    : GLShader(the_shader_name, std::span(std::begin(shader_paths), std::end(shader_paths)))
+struct GLShader::CompiledStage
+{
+    GLuint      Handle    = 0;
+    Type        StageType = VERTEX;
+    std::string GlslText{};
+
+    CompiledStage() = default;
+    CompiledStage(const CompiledStage&) = delete;
+    CompiledStage& operator=(const CompiledStage&) = delete;
+
+    ~CompiledStage()
+    {
+        if (Handle > 0)
+        {
+            GL::DeleteShader(Handle);
+        }
+    }
+};
+
+GLShader::GLShader(std::string_view the_shader_name, const std::initializer_list<std::filesystem::path>& shader_paths, BuildMode build_mode)
+    : GLShader(the_shader_name, std::span(std::begin(shader_paths), std::end(shader_paths)), build_mode)
 {
 }
 
-GLShader::GLShader(std::string_view the_shader_name, const std::span<const std::filesystem::path>& shader_paths)
+GLShader::GLShader(std::string_view the_shader_name, const std::span<const std::filesystem::path>& shader_paths, BuildMode build_mode)
+    : GLShader(the_shader_name, prepare_stages(shader_paths), build_mode)
+{
+}
+
+GLShader::GLShader(std::string_view the_shader_name, std::string_view vertex_shader_source, std::string_view fragment_shader_source)
+    : GLShader(the_shader_name, std::array{ Stage{ VERTEX, std::string(vertex_shader_source) }, Stage{ FRAGMENT, std::string(fragment_shader_source) } })
+{
+}
+
+GLShader::GLShader(std::string_view the_shader_name, std::span<const Stage> shader_stages, BuildMode build_mode, const GLShader* reuse_stages_from)
     : program_handle(0), shader_name(the_shader_name), uniforms()
 {
+    // the reflection cache key, programs linked from the same sources have the same interface
+    util::ContentHash hash;
+    for (const auto& stage : shader_stages)
+    {
+        hash.Add(std::as_bytes(std::span(&stage.StageType, 1)));
+        hash.Add(std::as_bytes(std::span(stage.GlslText)));
+    }
+    source_hash = hash.GetHash();
     try
     {
-        // Compile all shaders and attach them to the program
-        std::vector<GLuint>::size_type index = 0;
-        std::vector<GLuint>            shader(shader_paths.size());
-        for (const auto& shader_path : shader_paths)
+        // Compile the stages that changed and attach them all to the program
+        std::vector<GLuint> shader;
+        shader.reserve(shader_stages.size());
+        for (const auto& stage : shader_stages)
         {
-            std::string error;
-            const auto  shader_type = shader_type_from_extension(shader_path);
-            const bool  is_compiled = Compile(shader[index], shader_type, std::filesystem::path(shader_path), error);
-            // if any shader is failed to compile -> delete all shaders and program
-            if (!is_compiled)
+            auto compiled = (reuse_stages_from != nullptr) ? reuse_stages_from->find_stage(stage) : nullptr;
+            if (compiled)
+            {
+                ++reused_stage_count;
+            }
+            else
             {
-                for (auto& shdr : shader)
+                auto new_stage       = std::make_shared<CompiledStage>();
+                new_stage->StageType = stage.StageType;
+                new_stage->GlslText  = stage.GlslText;
+                std::string error;
+                const bool  is_compiled = (build_mode == BuildMode::Async) ? SubmitCompile(new_stage->Handle, stage.StageType, new_stage->GlslText, error)
+                                                                           : Compile(new_stage->Handle, stage.StageType, new_stage->GlslText, error);
+                // if any shader is failed to compile -> the compiled stages and the program get deleted
+                if (!is_compiled)
                 {
-                    if (shdr > 0)
-                    {
-                        GL::DeleteShader(shdr);
-                    }
+                    throw std::runtime_error(error);
                 }
-                throw std::runtime_error(error);
+                compiled = std::move(new_stage);
             }
-            index++;
+            shader.push_back(compiled->Handle);
+            stages.push_back(std::move(compiled));
         }
-        link_program(shader);
+        submit_link(shader);
+        if (build_mode == BuildMode::Async)
+        {
+            // the compile and link status is checked by finish_build() once the driver is done
+            is_build_pending = true;
+            return;
+        }
+        check_link_status();
+        reflect_linked_program();
 #if defined(DEVELOPER_VERSION)
         print_active_attributes();
         print_active_uniforms();
@@ -234,34 +286,20 @@ GLShader::GLShader(std::string_view the_shader_name, const std::span<const std::
     }
 }
 
-GLShader::GLShader(std::string_view the_shader_name, std::string_view vertex_shader_source, std::string_view fragment_shader_source)
-    : program_handle(0), shader_name(the_shader_name), uniforms()
+bool GLShader::PrepareStages(std::span<const std::filesystem::path> shader_paths, std::vector<Stage>& shader_stages, std::string& error_log)
 {
-    std::vector<GLuint>  shader(2);
-    const std::array     sources = { vertex_shader_source, fragment_shader_source };
-    constexpr std::array types   = { GLShader::Type::VERTEX, GLShader::Type::FRAGMENT };
-    std::string          error;
-    for (unsigned index = 0; index < 2; ++index)
+    shader_stages.clear();
+    shader_stages.reserve(shader_paths.size());
+    for (const auto& shader_path : shader_paths)
     {
-        const bool is_compiled = Compile(shader[index], types[index], sources[index], error);
-        // if any shader is failed to compile -> delete all shaders and program
-        if (!is_compiled)
+        auto& stage     = shader_stages.emplace_back();
+        stage.StageType = shader_type_from_extension(shader_path);
+        if (!assets::preprocess_shader_file(shader_path, stage.GlslText, error_log))
         {
-            for (auto shdr : shader)
-            {
-                if (shdr > 0)
-                {
-                    GL::DeleteShader(shdr);
-                }
-            }
-            throw std::runtime_error(error);
+            return false;
         }
     }
-    link_program(shader);
-#if defined(_DEBUG) || defined(DEBUG)
-    print_active_attributes();
-    print_active_uniforms();
-#endif
+    return true;
 }
 
 GLShader::~GLShader()
@@ -270,9 +308,12 @@ GLShader::~GLShader()
 }
 
 GLShader::GLShader(GLShader&& temp) noexcept
-    : program_handle{ temp.program_handle }, shader_name{ std::move(temp.shader_name) }, uniforms{ std::move(temp.uniforms) }
+    : program_handle{ temp.program_handle }, shader_name{ std::move(temp.shader_name) }, uniforms{ std::move(temp.uniforms) }, reflection{ std::move(temp.reflection) },
+      source_hash{ temp.source_hash }, stages{ std::move(temp.stages) }, reused_stage_count{ temp.reused_stage_count }, is_build_pending{ temp.is_build_pending }, has_failed{ temp.has_failed }
 {
-    temp.program_handle = 0;
+    temp.program_handle   = 0;
+    temp.is_build_pending = false;
+    temp.has_failed       = false;
 }
 
 GLShader& GLShader::operator=(GLShader&& temp) noexcept
@@ -280,17 +321,53 @@ GLShader& GLShader::operator=(GLShader&& temp) noexcept
     std::swap(program_handle, temp.program_handle);
     std::swap(shader_name, temp.shader_name);
     std::swap(uniforms, temp.uniforms);
+    std::swap(stages, temp.stages);
+    std::swap(reused_stage_count, temp.reused_stage_count);
+    std::swap(is_build_pending, temp.is_build_pending);
+    std::swap(has_failed, temp.has_failed);
+    std::swap(reflection, temp.reflection);
+    std::swap(source_hash, temp.source_hash);
     return *this;
 }
 
 void GLShader::Use(bool bind) const noexcept
 {
-    GL::UseProgram(bind ? program_handle : 0);
+    GL::UseProgram(bind ? GetHandle() : 0);
+}
+
+bool GLShader::IsReady() const noexcept
+{
+    if (is_build_pending)
+    {
+#if !defined(OPENGL_ES3_ONLY)
+        if (environment::opengl::HasParallelShaderCompile)
+        {
+            GLint is_completed = GL_FALSE;
+            GL::GetProgramiv(program_handle, GL_COMPLETION_STATUS_KHR, &is_completed);
+            if (is_completed == GL_FALSE)
+            {
+                return false;
+            }
+        }
+#endif
+        finish_build();
+    }
+    return program_handle != 0 && !has_failed;
+}
+
+const GLProgramReflection& GLShader::GetReflection() const
+{
+    if (GetHandle() == 0 || !reflection)
+    {
+        static const GLProgramReflection EMPTY_REFLECTION{};
+        return EMPTY_REFLECTION;
+    }
+    return *reflection;
 }
 
 bool GLShader::IsValidWithVertexArrayObject(GLHandle vertex_array_object_handle) const
 {
-    if (program_handle == 0)
+    if (GetHandle() == 0)
     {
         return false;
     }
@@ -440,14 +517,13 @@ void GLShader::SendUniform(std::string_view name, const glm::mat4x3& mat) const
     GL::UniformMatrix4x3fv(get_uniform_location(name), 1, (matrixStyle == MatrixStyle::RowOrder) ? GL_TRUE : GL_FALSE, &mat[0][0]);
 }
 
-void GLShader::link_program(const std::vector<unsigned int>& shader)
+void GLShader::submit_link(const std::vector<unsigned int>& shader)
 {
     program_handle = GL::CreateProgram();
     if (program_handle == 0)
     {
         throw std::runtime_error("Unable to create program\n");
     }
-
     for (const auto shader_handle : shader)
     {
         GL::AttachShader(program_handle, shader_handle);
@@ -455,10 +531,10 @@ void GLShader::link_program(const std::vector<unsigned int>& shader)
 
     // Link shaders to the program
     GL::LinkProgram(program_handle);
-    for (auto& shdr : shader)
-    {
-        GL::DeleteShader(shdr);
-    }
+}
+
+void GLShader::check_link_status() const
+{
     GLint is_linked = 0;
     GL::GetProgramiv(program_handle, GL_LINK_STATUS, &is_linked);
     if (is_linked == GL_FALSE)
@@ -472,8 +548,62 @@ void GLShader::link_program(const std::vector<unsigned int>& shader)
     }
 }
 
+void GLShader::reflect_linked_program() const
+{
+    // nothing has been sent to the program yet, so the default values are still the ones from the glsl
+    std::vector<std::string_view> glsl_texts;
+    glsl_texts.reserve(stages.size());
+    for (const auto& stage : stages)
+    {
+        glsl_texts.emplace_back(stage->GlslText);
+    }
+    reflection = reflect_program(program_handle, source_hash, glsl_texts);
+    // the locations are already known so SendUniform won't have to look them up
+    for (const auto& uniform : reflection->Uniforms)
+    {
+        if (uniform.Location >= 0)
+            uniforms.emplace(uniform.Name, uniform.Location);
+    }
+}
+
+void GLShader::finish_build() const noexcept
+{
+    if (!is_build_pending)
+    {
+        return;
+    }
+    is_build_pending = false;
+    try
+    {
+        std::string error;
+        for (const auto& stage : stages)
+        {
+            if (!CheckCompileStatus(stage->Handle, error))
+            {
+                throw std::runtime_error(error);
+            }
+        }
+        check_link_status();
+        reflect_linked_program();
+#if defined(DEVELOPER_VERSION)
+        print_active_attributes();
+        print_active_uniforms();
+#endif
+    }
+    catch (const std::exception& e)
+    {
+        has_failed = true;
+        std::cerr << "Failed to build shader " << shader_name << '\n'
+                  << e.what() << '\n';
+    }
+}
+
 int GLShader::get_uniform_location(std::string_view uniform_name) const noexcept
 {
+    if (GetHandle() == 0)
+    {
+        return -1;
+    }
     const auto iter_location = uniforms.find(uniform_name);
     if (iter_location == uniforms.end())
     {
@@ -489,60 +619,44 @@ int GLShader::get_uniform_location(std::string_view uniform_name) const noexcept
     return iter_location->second;
 }
 
+std::shared_ptr<const GLShader::CompiledStage> GLShader::find_stage(const Stage& stage) const noexcept
+{
+    const auto found = std::find_if(std::begin(stages), std::end(stages),
+                                    [&](const auto& compiled) { return compiled->Handle > 0 && compiled->StageType == stage.StageType && compiled->GlslText == stage.GlslText; });
+    return (found != std::end(stages)) ? *found : nullptr;
+}
+
 void GLShader::delete_program() noexcept
 {
+    if (reflection)
+    {
+        reflection.reset();
+        release_program_reflection(source_hash);
+    }
+    stages.clear();
+    is_build_pending = false;
     GL::DeleteProgram(program_handle);
     program_handle = 0;
 }
 
 void GLShader::print_active_uniforms() const
 {
-    GLint max_length;
-    GL::GetProgramiv(program_handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
-    std::string name;
-    name.resize(static_cast<unsigned>(max_length) + 1);
-    GLint num_uniforms;
-    GL::GetProgramiv(program_handle, GL_ACTIVE_UNIFORMS, &num_uniforms);
     std::cout << "----------------------------------------------------------------------" << '\r' << shader_name << " uniforms\n";
     std::cout << "Location\t|\tName\n";
-    const GLuint uniform_count = gsl::narrow<GLuint>(num_uniforms);
-    for (GLuint i = 0; i < uniform_count; ++i)
+    for (const auto& uniform : GetReflection().Uniforms)
     {
-        GLsizei written;
-        GLint   size;
-        GLenum  type;
-        name.clear();
-        name.resize(static_cast<unsigned>(max_length) + 1);
-        GL::GetActiveUniform(program_handle, i, max_length, &written, &size, &type, name.data());
-        name.resize(static_cast<std::string::size_type>(written));
-        const auto loc = get_uniform_location(name);
-        std::cout << loc << "\t\t" << name << '\n';
+        std::cout << uniform.Location << "\t\t" << uniform.Name << '\n';
     }
     std::cout << "----------------------------------------------------------------------\n";
 }
 
 void GLShader::print_active_attributes() const
 {
-    GLint max_length, num_attribs;
-    GL::GetProgramiv(program_handle, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_length);
-    GL::GetProgramiv(program_handle, GL_ACTIVE_ATTRIBUTES, &num_attribs);
-    std::string name;
-    name.resize(static_cast<unsigned>(max_length) + 1);
     std::cout << "----------------------------------------------------------------------" << '\r' << shader_name << " vertex attributes\n";
     std::cout << "Index\t|\tName\n";
-
-    const GLuint attribs_count = gsl::narrow<GLuint>(num_attribs);
-    for (GLuint i = 0; i < attribs_count; ++i)
+    for (const auto& attribute : GetReflection().Attributes)
     {
-        GLsizei written;
-        GLint   size;
-        GLenum  type;
-        name.clear();
-        name.resize(static_cast<unsigned>(max_length) + 1);
-        GL::GetActiveAttrib(program_handle, i, max_length, &written, &size, &type, name.data());
-        name.resize(static_cast<std::string::size_type>(written));
-        GLint loc = GL::GetAttribLocation(program_handle, name.c_str());
-        std::cout << loc << "\t\t" << name << '\n';
+        std::cout << attribute.Location << "\t\t" << attribute.Name << '\n';
     }
     std::cout << "----------------------------------------------------------------------\n";
 }
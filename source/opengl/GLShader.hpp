@@ -8,10 +8,9 @@
 
 #pragma once
 
-#pragma once
-
 #include "GL.hpp"
 #include "GLHandle.hpp"
+#include "GLProgramReflection.hpp"
 #include <GL/glew.h>
 #include <filesystem>
 #include <glm/mat2x2.hpp> // mat2, dmat2
@@ -22,6 +21,7 @@
 #include <glm/vec4.hpp>   // vec4, bvec4, dvec4, ivec4 and uvec4
 #include <initializer_list>
 #include <map>
+#include <memory>
 #include <span>
 #include <string>
 #include <string_view>
@@ -48,12 +48,30 @@ public:
         COMPUTE                 = GL_COMPUTE_SHADER
     };
 
+    // Blocking compiles and links before the constructor returns and throws on errors.
+    // Async only submits the compiles and the link so the driver can work on them in the background,
+    // errors are reported to std::cerr once the build is finished.
+    enum class BuildMode
+    {
+        Blocking,
+        Async
+    };
+
+    // One stage's glsl text, already read from disk with its #include's pasted in
+    struct Stage
+    {
+        Type        StageType = VERTEX;
+        std::string GlslText{};
+    };
+
 public:
     GLShader() = default;
-    GLShader(std::string_view the_shader_name, const std::initializer_list<std::filesystem::path>& shader_paths);
-    GLShader(std::string_view the_shader_name, const std::span<const std::filesystem::path>& shader_paths);
+    GLShader(std::string_view the_shader_name, const std::initializer_list<std::filesystem::path>& shader_paths, BuildMode build_mode = BuildMode::Blocking);
+    GLShader(std::string_view the_shader_name, const std::span<const std::filesystem::path>& shader_paths, BuildMode build_mode = BuildMode::Blocking);
 
     GLShader(std::string_view shader_name, std::string_view vertex_shader_source, std::string_view fragment_shader_source);
+    // Only makes OpenGL calls, a stage with the same type and text as one in reuse_stages_from shares its compiled shader object
+    GLShader(std::string_view the_shader_name, std::span<const Stage> shader_stages, BuildMode build_mode = BuildMode::Blocking, const GLShader* reuse_stages_from = nullptr);
     ~GLShader();
 
     GLShader(const GLShader&) = delete;
@@ -61,11 +79,27 @@ public:
     GLShader& operator=(const GLShader&) = delete;
     GLShader& operator=(GLShader&&) noexcept;
 
+    // Reads and preprocesses the files, each stage's type comes from its file extension
+    // Makes no OpenGL calls so it can run on a background thread
+    [[nodiscard]] static bool PrepareStages(std::span<const std::filesystem::path> shader_paths, std::vector<Stage>& shader_stages, std::string& error_log);
+
     void Use(bool bind = true) const noexcept;
 
+    // Returns true once the program is linked and usable.
+    // With KHR_parallel_shader_compile this only polls GL_COMPLETION_STATUS_KHR until the driver is done,
+    // without it the first call finishes the build right away and waits on the compile and link.
+    [[nodiscard]] bool IsReady() const noexcept;
+
+    [[nodiscard]] bool HasFailed() const noexcept
+    {
+        return has_failed;
+    }
+
+    // Finishes a pending async build, so this may block
     GLHandle GetHandle() const noexcept
     {
-        return program_handle;
+        finish_build();
+        return has_failed ? 0 : program_handle;
     }
 
     const std::string& GetName() const
@@ -73,6 +107,15 @@ public:
         return shader_name;
     }
 
+    // How many stages were shared with reuse_stages_from instead of being compiled again
+    [[nodiscard]] int GetReusedStageCount() const noexcept
+    {
+        return reused_stage_count;
+    }
+
+    // Queried right after linking and shared with every program built from the same stage sources
+    const GLProgramReflection& GetReflection() const;
+
     void SetMatrixStyle(MatrixStyle style) noexcept
     {
         matrixStyle = style;
@@ -108,15 +151,28 @@ public:
 
 
 private:
-    GLHandle                                        program_handle = 0;
-    std::string                                     shader_name{};
-    mutable std::map<std::string, int, std::less<>> uniforms{};
-    MatrixStyle                                     matrixStyle{ MatrixStyle::OpenGLStyle };
+    // A compiled shader object, kept alive after linking so a rebuild can attach it again
+    struct CompiledStage;
+
+    GLHandle                                           program_handle = 0;
+    std::string                                        shader_name{};
+    mutable std::map<std::string, int, std::less<>>    uniforms{};
+    mutable std::shared_ptr<const GLProgramReflection> reflection{};
+    std::uint64_t                                      source_hash = 0;
+    MatrixStyle                                        matrixStyle{ MatrixStyle::OpenGLStyle };
+    std::vector<std::shared_ptr<const CompiledStage>>  stages{};
+    int                                                reused_stage_count = 0;
+    mutable bool                                       is_build_pending   = false;
+    mutable bool                                       has_failed         = false;
 
 private:
-    void              link_program(const std::vector<unsigned int>& shader);
-    [[nodiscard]] int get_uniform_location(std::string_view uniform_name) const noexcept;
-    void              delete_program() noexcept;
-    void              print_active_uniforms() const;
-    void              print_active_attributes() const;
+    [[nodiscard]] std::shared_ptr<const CompiledStage> find_stage(const Stage& stage) const noexcept;
+    void                                               submit_link(const std::vector<unsigned int>& shader);
+    void                                               check_link_status() const;
+    void                                               reflect_linked_program() const;
+    void                                               finish_build() const noexcept;
+    [[nodiscard]] int                                  get_uniform_location(std::string_view uniform_name) const noexcept;
+    void                                               delete_program() noexcept;
+    void                                               print_active_uniforms() const;
+    void                                               print_active_attributes() const;
 };
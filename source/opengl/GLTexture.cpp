@@ -9,21 +9,29 @@
 #include "GLTexture.hpp"
 
 #include "GL.hpp"
+#include "GLPixelUnpackRing.hpp"
 #include "assets/Path.hpp"
+#include "assets/TextureCache.hpp"
 #include "environment/OpenGL.hpp"
 #include <GL/glew.h>
-#include <stb_image.h>
+#include <algorithm>
+#include <cstring>
+
+GLTexture::GLTexture() noexcept = default;
 
 GLTexture::~GLTexture() noexcept
 {
     delete_texture();
 }
 
-GLTexture::GLTexture(GLTexture&& other) noexcept : texture_handle(other.texture_handle), width(other.width), height(other.height)
+GLTexture::GLTexture(GLTexture&& other) noexcept
+    : texture_handle(other.texture_handle), width(other.width), height(other.height), mip_level_count(other.mip_level_count), filtering(other.filtering), wrapping(other.wrapping),
+      upload_ring(std::move(other.upload_ring))
 {
-    other.texture_handle = 0;
-    other.width          = 0;
-    other.height         = 0;
+    other.texture_handle  = 0;
+    other.width           = 0;
+    other.height          = 0;
+    other.mip_level_count = 1;
 }
 
 GLTexture& GLTexture::operator=(GLTexture&& other) noexcept
@@ -31,6 +39,10 @@ GLTexture& GLTexture::operator=(GLTexture&& other) noexcept
     std::swap(texture_handle, other.texture_handle);
     std::swap(width, other.width);
     std::swap(height, other.height);
+    std::swap(mip_level_count, other.mip_level_count);
+    std::swap(filtering, other.filtering);
+    std::swap(wrapping, other.wrapping);
+    std::swap(upload_ring, other.upload_ring);
     return *this;
 }
 
@@ -107,24 +119,18 @@ bool GLTexture::LoadFromFileImage(std::filesystem::path image_filepath, bool fli
             return false;
         }
     }
-    int           pixel_width;
-    int           pixel_height;
-    int           files_channels_count  = 0;
-    constexpr int desired_channel_count = 4;
-    stbi_set_flip_vertically_on_load(flip_vertical);
-    RGBA* const rgba_pixels = reinterpret_cast<RGBA*>(stbi_load(image_filepath.string().c_str(), &pixel_width, &pixel_height, &files_channels_count, desired_channel_count));
-    if (rgba_pixels == nullptr)
+    assets::PreparedTexture prepared;
+    if (!assets::prepare_texture_file(image_filepath, flip_vertical, assets::TextureCompression::None, prepared))
         return false;
-    const bool result = LoadFromMemory(pixel_width, pixel_height, rgba_pixels);
-    stbi_image_free(rgba_pixels);
-    return result;
+    return LoadFromPreparedTexture(prepared);
 }
 
 bool GLTexture::LoadFromMemory(int image_width, int image_height, const RGBA* colors) noexcept
 {
     delete_texture();
-    width  = image_width;
-    height = image_height;
+    width     = image_width;
+    height    = image_height;
+    filtering = Filtering::Linear;
 
     IF_CAN_DO_OPENGL(4, 5)
     {
@@ -158,6 +164,79 @@ bool GLTexture::LoadFromMemory(int image_width, int image_height, const RGBA* co
     return true;
 }
 
+namespace
+{
+    GLenum to_internal_format(assets::PreparedTexture::PixelFormat format) noexcept
+    {
+        switch (format)
+        {
+            case assets::PreparedTexture::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case assets::PreparedTexture::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            default: return GL_RGBA8;
+        }
+    }
+}
+
+bool GLTexture::LoadFromPreparedTexture(const assets::PreparedTexture& prepared) noexcept
+{
+    if (prepared.Levels.empty())
+        return false;
+
+    delete_texture();
+    width           = prepared.Levels.front().Width;
+    height          = prepared.Levels.front().Height;
+    mip_level_count = static_cast<int>(prepared.Levels.size());
+    filtering       = Filtering::Linear; // what the parameters below set, so SetFiltering() sees the real state
+
+    const bool   is_compressed   = prepared.Format != assets::PreparedTexture::RGBA8;
+    const GLenum internal_format = to_internal_format(prepared.Format);
+    const GLint  min_filter      = (mip_level_count > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+
+    IF_CAN_DO_OPENGL(4, 5)
+    {
+        GL::CreateTextures(GL_TEXTURE_2D, 1, &texture_handle);
+        GL::TextureStorage2D(texture_handle, mip_level_count, internal_format, width, height);
+        for (int level = 0; level < mip_level_count; ++level)
+        {
+            const auto& [level_width, level_height, data] = prepared.Levels[static_cast<std::size_t>(level)];
+            if (is_compressed)
+                GL::CompressedTextureSubImage2D(texture_handle, level, 0, 0, level_width, level_height, internal_format, static_cast<GLsizei>(data.size()), data.data());
+            else
+                GL::TextureSubImage2D(texture_handle, level, 0, 0, level_width, level_height, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+        }
+
+        GL::TextureParameteri(texture_handle, GL_TEXTURE_MAX_LEVEL, mip_level_count - 1);
+        GL::TextureParameteri(texture_handle, GL_TEXTURE_MIN_FILTER, min_filter);
+        GL::TextureParameteri(texture_handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        GL::TextureParameteri(texture_handle, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        GL::TextureParameteri(texture_handle, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    }
+    else
+    {
+        GL::GenTextures(1, &texture_handle);
+        GL::BindTexture(GL_TEXTURE_2D, texture_handle);
+
+        for (int level = 0; level < mip_level_count; ++level)
+        {
+            const auto& [level_width, level_height, data] = prepared.Levels[static_cast<std::size_t>(level)];
+            if (is_compressed)
+                GL::CompressedTexImage2D(GL_TEXTURE_2D, level, internal_format, level_width, level_height, 0, static_cast<GLsizei>(data.size()), data.data());
+            else
+                GL::TexImage2D(GL_TEXTURE_2D, level, GL_RGBA, level_width, level_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+        }
+
+        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mip_level_count - 1);
+        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+        GL::BindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    return true;
+}
+
 bool GLTexture::LoadAsFormat(int image_width, int image_height, ColorFormat format) noexcept
 {
     delete_texture();
@@ -217,17 +296,73 @@ bool GLTexture::LoadAsFormat(int image_width, int image_height, ColorFormat form
 
 
 void GLTexture::UploadAsRGBA(gsl::not_null<const RGBA*> colors) noexcept
+{
+    UploadRegion(0, 0, width, height, colors);
+}
+
+void GLTexture::UploadRegion(int x, int y, int region_width, int region_height, gsl::not_null<const RGBA*> colors, int row_length) noexcept
+{
+    if (texture_handle == 0 || region_width <= 0 || region_height <= 0 || x < 0 || y < 0 || x + region_width > width || y + region_height > height)
+        return;
+    if (row_length == 0)
+        row_length = region_width;
+
+#if !defined(OPENGL_ES3_ONLY)
+    const auto row_bytes = static_cast<std::size_t>(region_width) * sizeof(RGBA);
+    // the driver copies small uploads straight into its command stream, a buffer from the ring would only waste a lap
+    constexpr std::size_t SMALL_UPLOAD_BYTES = 256 * 1024;
+    if (row_bytes * static_cast<std::size_t>(region_height) > SMALL_UPLOAD_BYTES)
+    {
+        if (!upload_ring)
+            upload_ring = std::make_unique<GLPixelUnpackRing>();
+
+        const int rows_per_band = std::max(1, static_cast<int>(static_cast<std::size_t>(GLPixelUnpackRing::SlotSizeBytes) / row_bytes));
+        for (int band_y = 0; band_y < region_height; band_y += rows_per_band)
+        {
+            const int   band_rows   = std::min(rows_per_band, region_height - band_y);
+            const RGBA* band_colors = colors.get() + static_cast<std::ptrdiff_t>(band_y) * row_length;
+            bool        sent        = false;
+            if (std::byte* mapped = upload_ring->MapNext(static_cast<GLsizeiptr>(row_bytes) * band_rows); mapped != nullptr)
+            {
+                for (int row = 0; row < band_rows; ++row)
+                {
+                    std::memcpy(mapped + static_cast<std::size_t>(row) * row_bytes, band_colors + static_cast<std::ptrdiff_t>(row) * row_length, row_bytes);
+                }
+                if (upload_ring->Unmap())
+                {
+                    // pixels is an offset into the bound unpack buffer
+                    sub_image(x, y + band_y, region_width, band_rows, nullptr);
+                    sent = true;
+                }
+            }
+            upload_ring->Release();
+            if (!sent)
+            {
+                GL::PixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+                sub_image(x, y + band_y, region_width, band_rows, band_colors);
+                GL::PixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            }
+        }
+        return;
+    }
+#endif
+    // small regions, and everything on WebGL which can't map buffers, go straight from client memory
+    GL::PixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+    sub_image(x, y, region_width, region_height, colors);
+    GL::PixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void GLTexture::sub_image(int x, int y, int region_width, int region_height, const void* pixels) const noexcept
 {
     constexpr int base_mipmap_level = 0;
-    constexpr int xoffset = 0, yoffset = 0;
     IF_CAN_DO_OPENGL(4, 5)
     {
-        GL::TextureSubImage2D(GetHandle(), base_mipmap_level, xoffset, yoffset, width, height, GL_RGBA, GL_UNSIGNED_BYTE, colors);
+        GL::TextureSubImage2D(texture_handle, base_mipmap_level, x, y, region_width, region_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
     }
     else
     {
-        GL::BindTexture(GL_TEXTURE_2D, GetHandle());
-        GL::TexSubImage2D(GL_TEXTURE_2D, base_mipmap_level, xoffset, yoffset, width, height, GL_RGBA, GL_UNSIGNED_BYTE, colors);
+        GL::BindTexture(GL_TEXTURE_2D, texture_handle);
+        GL::TexSubImage2D(GL_TEXTURE_2D, base_mipmap_level, x, y, region_width, region_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
         GL::BindTexture(GL_TEXTURE_2D, 0);
     }
 }
@@ -252,16 +387,20 @@ void GLTexture::SetFiltering(Filtering how_to_filter) noexcept
 
     filtering = how_to_filter;
 
+    // nearest stays on the top level so pixel art keeps its look, linear blends between mip levels when there are any
+    const GLint mag_filter = (filtering == Filtering::NearestPixel) ? GL_NEAREST : GL_LINEAR;
+    const GLint min_filter = (filtering == Filtering::NearestPixel) ? GL_NEAREST : ((mip_level_count > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+
     IF_CAN_DO_OPENGL(4, 5)
     {
-        GL::TextureParameteri(texture_handle, GL_TEXTURE_MIN_FILTER, (filtering == Filtering::NearestPixel) ? GL_NEAREST : GL_LINEAR);
-        GL::TextureParameteri(texture_handle, GL_TEXTURE_MAG_FILTER, (filtering == Filtering::NearestPixel) ? GL_NEAREST : GL_LINEAR);
+        GL::TextureParameteri(texture_handle, GL_TEXTURE_MIN_FILTER, min_filter);
+        GL::TextureParameteri(texture_handle, GL_TEXTURE_MAG_FILTER, mag_filter);
     }
     else
     {
         GL::BindTexture(GL_TEXTURE_2D, texture_handle);
-        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (filtering == Filtering::NearestPixel) ? GL_NEAREST : GL_LINEAR);
-        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (filtering == Filtering::NearestPixel) ? GL_NEAREST : GL_LINEAR);
+        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+        GL::TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
     }
 }
 
@@ -313,7 +452,8 @@ void GLTexture::SetWrapping(Wrapping how_to_wrap, Coordinate coord) noexcept
 void GLTexture::delete_texture() noexcept
 {
     GL::DeleteTextures(1, &texture_handle);
-    texture_handle = 0;
-    width          = 0;
-    height         = 0;
+    texture_handle  = 0;
+    width           = 0;
+    height          = 0;
+    mip_level_count = 1;
 }
@@ -8,16 +8,24 @@
 #include <array>
 #include <filesystem>
 #include <gsl/gsl>
+#include <memory>
 
 #include "GL/glew.h"
 #include "GLHandle.hpp"
 
 #pragma once
 
+namespace assets
+{
+    struct PreparedTexture;
+}
+
+class GLPixelUnpackRing;
+
 class [[nodiscard]] GLTexture
 {
 public:
-    GLTexture() = default;
+    GLTexture() noexcept;
     ~GLTexture() noexcept;
 
     GLTexture(const GLTexture& other) = delete;
@@ -54,10 +62,18 @@ public:
 
     [[nodiscard]] bool LoadFromMemory(int image_width, int image_height, const RGBA* colors) noexcept;
 
+    // Uploads every mip level, uncompressed or BC1/BC3
+    [[nodiscard]] bool LoadFromPreparedTexture(const assets::PreparedTexture& prepared) noexcept;
+
     void UseForSlot(unsigned int texture_unit) const noexcept;
 
     void UploadAsRGBA(gsl::not_null<const RGBA*> colors) noexcept;
 
+    // Replaces a rectangle of the top mip level. row_length is how many pixels apart the rows of colors are, 0 if they are packed.
+    // On desktop OpenGL regions over 256 KB are copied into a small ring of pixel unpack buffers in bands, so big uploads don't make
+    // the driver stall or keep its own copy of the whole image
+    void UploadRegion(int x, int y, int region_width, int region_height, gsl::not_null<const RGBA*> colors, int row_length = 0) noexcept;
+
     [[nodiscard]] GLHandle GetHandle() const noexcept
     {
         return texture_handle;
@@ -73,6 +89,11 @@ public:
         return height;
     }
 
+    [[nodiscard]] int GetMipLevelCount() const noexcept
+    {
+        return mip_level_count;
+    }
+
     enum Filtering : GLint
     {
         NearestPixel = GL_NEAREST,
@@ -111,11 +132,14 @@ public:
 
 private:
     void delete_texture() noexcept;
+    void sub_image(int x, int y, int region_width, int region_height, const void* pixels) const noexcept;
 
 private:
-    GLHandle                texture_handle = 0;
-    int                     width          = 0;
-    int                     height         = 0;
-    Filtering               filtering      = Filtering::NearestPixel;
-    std::array<Wrapping, 2> wrapping       = { Wrapping::Repeat, Wrapping::Repeat };
+    GLHandle                           texture_handle  = 0;
+    int                                width           = 0;
+    int                                height          = 0;
+    int                                mip_level_count = 1;
+    Filtering                          filtering       = Filtering::NearestPixel;
+    std::array<Wrapping, 2>            wrapping        = { Wrapping::Repeat, Wrapping::Repeat };
+    std::unique_ptr<GLPixelUnpackRing> upload_ring{}; // made the first time UploadRegion is called, kept across reloads
 };
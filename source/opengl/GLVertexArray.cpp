@@ -14,6 +14,21 @@
 #include <GL/glew.h>
 #include <gsl/gsl>
 
+namespace
+{
+    [[nodiscard]] constexpr std::uintptr_t index_size(GLIndexElement::Type type) noexcept
+    {
+        switch (type)
+        {
+            case GLIndexElement::UInt: return sizeof(GLuint);
+            case GLIndexElement::UShort: return sizeof(GLushort);
+            case GLIndexElement::UByte: return sizeof(GLubyte);
+            case GLIndexElement::None: break;
+        }
+        return 0;
+    }
+}
+
 GLVertexArray::GLVertexArray(GLPrimitive::Type the_primitive_pattern)
 {
     primitive_pattern = the_primitive_pattern;
@@ -74,6 +89,8 @@ void GLVertexArray::AddVertexBuffer(GLVertexBuffer&& vertex_buffer, std::initial
             GL::VertexArrayVertexBuffer(vertex_array_handle, attribute.vertex_layout_location, buffer_handle, attribute.offset, attribute.stride);
             GL::VertexArrayAttribFormat(vertex_array_handle, attribute.vertex_layout_location, attribute.component_dimension, attribute.component_type, attribute.normalized, attribute.relative_offset);
             GL::VertexArrayAttribBinding(vertex_array_handle, attribute.vertex_layout_location, attribute.vertex_layout_location);
+            if (attribute.divisor != 0)
+                GL::VertexArrayBindingDivisor(vertex_array_handle, attribute.vertex_layout_location, attribute.divisor);
         }
         else
         {
@@ -84,6 +101,8 @@ void GLVertexArray::AddVertexBuffer(GLVertexBuffer&& vertex_buffer, std::initial
             GL::VertexAttribPointer(
                 attribute.vertex_layout_location, attribute.component_dimension, attribute.component_type, attribute.normalized, attribute.stride,
                 reinterpret_cast<void*>(static_cast<std::uintptr_t>(attribute.relative_offset)));
+            if (attribute.divisor != 0)
+                GL::VertexAttribDivisor(attribute.vertex_layout_location, attribute.divisor);
         }
 
     }
@@ -118,6 +137,32 @@ void GLDrawIndexed(const GLVertexArray& vertex_array) noexcept
     GL::DrawElements((vertex_array.GetPrimitivePattern()), vertex_array.GetIndicesCount(), (vertex_array.GetIndicesType()), nullptr);
 }
 
+void GLDrawIndexed(const GLVertexArray& vertex_array, GLsizei index_count, GLsizei first_index) noexcept
+{
+    const auto first_byte = static_cast<std::uintptr_t>(first_index) * index_size(vertex_array.GetIndicesType());
+    GL::DrawElements((vertex_array.GetPrimitivePattern()), index_count, (vertex_array.GetIndicesType()), reinterpret_cast<const void*>(first_byte));
+}
+
+void GLMultiDrawIndexedIndirect([[maybe_unused]] const GLVertexArray& vertex_array, [[maybe_unused]] GLsizei draw_count, [[maybe_unused]] GLsizei first_command) noexcept
+{
+#if !defined(OPENGL_ES3_ONLY)
+    const auto first_byte = static_cast<std::uintptr_t>(first_command) * sizeof(GLDrawElementsIndirectCommand);
+    GL::MultiDrawElementsIndirect((vertex_array.GetPrimitivePattern()), (vertex_array.GetIndicesType()), reinterpret_cast<const void*>(first_byte), draw_count,
+                                  sizeof(GLDrawElementsIndirectCommand));
+#endif
+}
+
+void GLMultiDrawIndexedIndirectCount([[maybe_unused]] const GLVertexArray& vertex_array, [[maybe_unused]] GLsizei max_draw_count, [[maybe_unused]] GLsizei first_command,
+                                     [[maybe_unused]] GLsizei count_index) noexcept
+{
+#if !defined(OPENGL_ES3_ONLY)
+    const auto first_byte = static_cast<std::uintptr_t>(first_command) * sizeof(GLDrawElementsIndirectCommand);
+    const auto count_byte = static_cast<GLintptr>(count_index) * static_cast<GLintptr>(sizeof(GLuint));
+    GL::MultiDrawElementsIndirectCount((vertex_array.GetPrimitivePattern()), (vertex_array.GetIndicesType()), reinterpret_cast<const void*>(first_byte), count_byte, max_draw_count,
+                                       sizeof(GLDrawElementsIndirectCommand));
+#endif
+}
+
 void GLDrawVertices(const GLVertexArray& vertex_array) noexcept
 {
     GL::DrawArrays((vertex_array.GetPrimitivePattern()), 0, vertex_array.GetVertexCount());
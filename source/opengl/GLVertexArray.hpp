@@ -50,6 +50,8 @@ struct GLAttributeLayout
     GLintptr      offset                 = 0;
     // how many bytes to step to the next attribute
     GLsizei       stride                 = 0;
+    // 0 steps once per vertex, N steps once every N instances
+    GLuint        divisor                = 0;
 };
 
 struct GLPrimitive
@@ -71,6 +73,16 @@ struct GLPrimitive
     };
 };
 
+// The layout glMultiDrawElementsIndirect reads from the GL_DRAW_INDIRECT_BUFFER, one per draw
+struct GLDrawElementsIndirectCommand
+{
+    GLuint Count         = 0; // indices to draw
+    GLuint InstanceCount = 0;
+    GLuint FirstIndex    = 0; // in indices, not bytes
+    GLint  BaseVertex    = 0;
+    GLuint BaseInstance  = 0; // added to the instance number of attributes with a divisor
+};
+
 class [[nodiscard]] GLVertexArray
 {
     GLHandle                    vertex_array_handle = 0;
@@ -142,4 +154,10 @@ public:
 };
 
 void GLDrawIndexed(const GLVertexArray& vertex_array) noexcept;
+// Draws index_count indices starting first_index indices into the index buffer
+void GLDrawIndexed(const GLVertexArray& vertex_array, GLsizei index_count, GLsizei first_index) noexcept;
+// Needs OpenGL 4.3. Draws draw_count GLDrawElementsIndirectCommands from the bound GL_DRAW_INDIRECT_BUFFER, starting at first_command
+void GLMultiDrawIndexedIndirect(const GLVertexArray& vertex_array, GLsizei draw_count, GLsizei first_command = 0) noexcept;
+// Needs OpenGL 4.6. Like GLMultiDrawIndexedIndirect, but draws as many commands as the GLuint at count_index of the bound GL_PARAMETER_BUFFER says, at most max_draw_count
+void GLMultiDrawIndexedIndirectCount(const GLVertexArray& vertex_array, GLsizei max_draw_count, GLsizei first_command, GLsizei count_index) noexcept;
 void GLDrawVertices(const GLVertexArray& vertex_array) noexcept;
@@ -0,0 +1,162 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "ContentHash.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+    // https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md - reference
+    constexpr std::uint64_t PRIME_1 = 11400714785074694791ull;
+    constexpr std::uint64_t PRIME_2 = 14029467366897019727ull;
+    constexpr std::uint64_t PRIME_3 = 1609587929392839161ull;
+    constexpr std::uint64_t PRIME_4 = 9650029242287828579ull;
+    constexpr std::uint64_t PRIME_5 = 2870177450012600261ull;
+
+    // the spec reads little endian words, which is every platform we build for
+    std::uint64_t read_u64(const std::byte* bytes) noexcept
+    {
+        std::uint64_t value = 0;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    std::uint32_t read_u32(const std::byte* bytes) noexcept
+    {
+        std::uint32_t value = 0;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    constexpr std::uint64_t round(std::uint64_t lane, std::uint64_t input) noexcept
+    {
+        lane += input * PRIME_2;
+        lane = std::rotl(lane, 31);
+        return lane * PRIME_1;
+    }
+
+    constexpr std::uint64_t merge_lane(std::uint64_t hash, std::uint64_t lane) noexcept
+    {
+        hash ^= round(0, lane);
+        return hash * PRIME_1 + PRIME_4;
+    }
+
+    void consume_stripe(std::array<std::uint64_t, 4>& lanes, const std::byte* bytes) noexcept
+    {
+        for (std::size_t i = 0; i < lanes.size(); ++i)
+        {
+            lanes[i] = round(lanes[i], read_u64(bytes + i * sizeof(std::uint64_t)));
+        }
+    }
+}
+
+namespace util
+{
+    ContentHash::ContentHash(std::uint64_t the_seed) noexcept
+        : lanes{ the_seed + PRIME_1 + PRIME_2, the_seed + PRIME_2, the_seed, the_seed - PRIME_1 }, seed(the_seed)
+    {
+    }
+
+    void ContentHash::Add(std::span<const std::byte> bytes) noexcept
+    {
+        totalSize += bytes.size();
+        if (stripeSize > 0)
+        {
+            const auto to_copy = std::min(stripe.size() - stripeSize, bytes.size());
+            std::memcpy(stripe.data() + stripeSize, bytes.data(), to_copy);
+            stripeSize += to_copy;
+            bytes = bytes.subspan(to_copy);
+            if (stripeSize < stripe.size())
+                return;
+            consume_stripe(lanes, stripe.data());
+            stripeSize = 0;
+        }
+        while (bytes.size() >= stripe.size())
+        {
+            consume_stripe(lanes, bytes.data());
+            bytes = bytes.subspan(stripe.size());
+        }
+        std::memcpy(stripe.data(), bytes.data(), bytes.size());
+        stripeSize = bytes.size();
+    }
+
+    std::uint64_t ContentHash::GetHash() const noexcept
+    {
+        std::uint64_t hash = 0;
+        if (totalSize >= stripe.size())
+        {
+            hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+            for (const auto lane : lanes)
+            {
+                hash = merge_lane(hash, lane);
+            }
+        }
+        else
+        {
+            hash = seed + PRIME_5;
+        }
+        hash += totalSize;
+
+        const std::byte* remaining = stripe.data();
+        const std::byte* end       = stripe.data() + stripeSize;
+        for (; remaining + sizeof(std::uint64_t) <= end; remaining += sizeof(std::uint64_t))
+        {
+            hash ^= round(0, read_u64(remaining));
+            hash = std::rotl(hash, 27) * PRIME_1 + PRIME_4;
+        }
+        if (remaining + sizeof(std::uint32_t) <= end)
+        {
+            hash ^= read_u32(remaining) * PRIME_1;
+            hash = std::rotl(hash, 23) * PRIME_2 + PRIME_3;
+            remaining += sizeof(std::uint32_t);
+        }
+        for (; remaining < end; ++remaining)
+        {
+            hash ^= std::to_integer<std::uint64_t>(*remaining) * PRIME_5;
+            hash = std::rotl(hash, 11) * PRIME_1;
+        }
+
+        // avalanche
+        hash ^= hash >> 33;
+        hash *= PRIME_2;
+        hash ^= hash >> 29;
+        hash *= PRIME_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    std::uint64_t hash_bytes(std::span<const std::byte> bytes, std::uint64_t seed) noexcept
+    {
+        ContentHash content_hash(seed);
+        content_hash.Add(bytes);
+        return content_hash.GetHash();
+    }
+
+    bool hash_file_contents(const std::filesystem::path& file_path, std::uint64_t& hash)
+    {
+        std::ifstream ifs(file_path, std::ios::in | std::ios::binary);
+        if (!ifs)
+            return false;
+        constexpr std::size_t  ChunkSize = 64 * 1024;
+        std::vector<std::byte> chunk(ChunkSize);
+        ContentHash            content_hash;
+        while (ifs)
+        {
+            ifs.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+            content_hash.Add(std::span(chunk.data(), static_cast<std::size_t>(ifs.gcount())));
+        }
+        if (ifs.bad())
+            return false;
+        hash = content_hash.GetHash();
+        return true;
+    }
+}
@@ -0,0 +1,40 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace util
+{
+    // XXH64, fed a piece at a time. Gives the same value as hashing all of the bytes at once.
+    // Only meant to tell two versions of a file apart, not to be cryptographically secure.
+    class ContentHash
+    {
+    public:
+        explicit ContentHash(std::uint64_t seed = 0) noexcept;
+
+        void                        Add(std::span<const std::byte> bytes) noexcept;
+        [[nodiscard]] std::uint64_t GetHash() const noexcept;
+
+    private:
+        std::array<std::uint64_t, 4> lanes{};
+        std::array<std::byte, 32>    stripe{}; // bytes that don't fill a whole stripe yet
+        std::size_t                  stripeSize = 0;
+        std::uint64_t                totalSize  = 0;
+        std::uint64_t                seed       = 0;
+    };
+
+    [[nodiscard]] std::uint64_t hash_bytes(std::span<const std::byte> bytes, std::uint64_t seed = 0) noexcept;
+
+    // Streams the file through ContentHash, returns false if it can't be read
+    [[nodiscard]] bool hash_file_contents(const std::filesystem::path& file_path, std::uint64_t& hash);
+}
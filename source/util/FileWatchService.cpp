@@ -0,0 +1,138 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "FileWatchService.hpp"
+
+#include <algorithm>
+
+namespace util
+{
+    bool FileChangeQueue::TryPush(const FileChange& change) noexcept
+    {
+        const auto the_tail = tail.load(std::memory_order_relaxed);
+        if (the_tail - head.load(std::memory_order_acquire) == Capacity)
+        {
+            overflowed.store(true, std::memory_order_release);
+            return false;
+        }
+        changes[the_tail % Capacity] = change;
+        tail.store(the_tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool FileChangeQueue::TryPop(FileChange& change) noexcept
+    {
+        const auto the_head = head.load(std::memory_order_relaxed);
+        if (the_head == tail.load(std::memory_order_acquire))
+            return false;
+        change = changes[the_head % Capacity];
+        head.store(the_head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool FileChangeQueue::TakeOverflow() noexcept
+    {
+        return overflowed.exchange(false, std::memory_order_acq_rel);
+    }
+
+    FileWatchService::Subscription::Subscription(FileWatchService* the_service, std::uint64_t the_id) noexcept
+        : service(the_service), id(the_id)
+    {
+    }
+
+    FileWatchService::Subscription::~Subscription()
+    {
+        if (service != nullptr)
+            service->unsubscribe(id);
+    }
+
+    FileWatchService::Subscription::Subscription(Subscription&& other) noexcept
+        : service(other.service), id(other.id)
+    {
+        other.service = nullptr;
+        other.id      = 0;
+    }
+
+    FileWatchService::Subscription& FileWatchService::Subscription::operator=(Subscription&& other) noexcept
+    {
+        std::swap(service, other.service);
+        std::swap(id, other.id);
+        return *this;
+    }
+
+    FileWatchService::Subscription FileWatchService::Subscribe(const std::filesystem::path& file_path, FileChangeQueue& queue, void* context)
+    {
+        const auto    normal_path = file_path.lexically_normal();
+        bool          is_new_path = false;
+        std::uint64_t id          = 0;
+        {
+            std::scoped_lock lock(mutex);
+            id                     = nextId++;
+            auto& path_subscribers = subscribers[normal_path];
+            is_new_path            = path_subscribers.empty();
+            path_subscribers.push_back({ id, &queue, context });
+            subscriptionPaths[id] = normal_path;
+        }
+        if (is_new_path)
+        {
+            watcher.Watch(normal_path, [this, normal_path](FileStatus status) { notify(normal_path, status); });
+        }
+        return Subscription{ this, id };
+    }
+
+    void FileWatchService::Update()
+    {
+        watcher.Update();
+    }
+
+    std::size_t FileWatchService::GetWatchedFileCount() const
+    {
+        std::scoped_lock lock(mutex);
+        return subscribers.size();
+    }
+
+    void FileWatchService::unsubscribe(std::uint64_t id)
+    {
+        std::filesystem::path no_longer_watched;
+        {
+            std::scoped_lock lock(mutex);
+            const auto       path = subscriptionPaths.find(id);
+            if (path == subscriptionPaths.end())
+                return;
+            const auto path_subscribers = subscribers.find(path->second);
+            std::erase_if(path_subscribers->second, [id](const Subscriber& subscriber) { return subscriber.Id == id; });
+            if (path_subscribers->second.empty())
+            {
+                no_longer_watched = path->second;
+                subscribers.erase(path_subscribers);
+            }
+            subscriptionPaths.erase(path);
+        }
+        if (!no_longer_watched.empty())
+        {
+            watcher.Unwatch(no_longer_watched);
+        }
+    }
+
+    void FileWatchService::notify(const std::filesystem::path& file_path, FileStatus status)
+    {
+        std::scoped_lock lock(mutex);
+        if (const auto path_subscribers = subscribers.find(file_path); path_subscribers != subscribers.end())
+        {
+            for (const auto& subscriber : path_subscribers->second)
+            {
+                subscriber.Queue->TryPush({ subscriber.Context, status });
+            }
+        }
+    }
+
+    FileWatchService& get_file_watch_service()
+    {
+        static FileWatchService file_watch_service;
+        return file_watch_service;
+    }
+}
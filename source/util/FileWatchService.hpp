@@ -0,0 +1,109 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include "WatchFiles.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace util
+{
+    struct FileChange
+    {
+        void*      Context = nullptr; // whatever was given to Subscribe
+        FileStatus Status  = FileStatus::Modified;
+    };
+
+    // Fixed size ring with one thread pushing and one thread popping, so neither side ever takes a lock.
+    // The file watcher pushes, the owner drains it once a frame.
+    class FileChangeQueue
+    {
+    public:
+        static constexpr std::size_t Capacity = 256;
+
+        // Returns false and remembers that a change was lost when the queue is full
+        bool               TryPush(const FileChange& change) noexcept;
+        [[nodiscard]] bool TryPop(FileChange& change) noexcept;
+        // True once after changes were dropped, the owner should then assume everything changed
+        [[nodiscard]] bool TakeOverflow() noexcept;
+
+    private:
+        std::array<FileChange, Capacity> changes{};
+        std::atomic<std::size_t>         head{ 0 }; // next one to pop
+        std::atomic<std::size_t>         tail{ 0 }; // next one to push
+        std::atomic_bool                 overflowed{ false };
+    };
+
+    // One file watcher for the whole program. Each path is watched once however many subscribers it has,
+    // so the number of threads and file system calls doesn't grow with the number of demos and materials.
+    class FileWatchService
+    {
+    public:
+        // Keeps the subscription alive, the path stops being watched when its last subscription goes away
+        class [[nodiscard]] Subscription
+        {
+        public:
+            Subscription() = default;
+            ~Subscription();
+
+            Subscription(const Subscription&)            = delete;
+            Subscription& operator=(const Subscription&) = delete;
+            Subscription(Subscription&& other) noexcept;
+            Subscription& operator=(Subscription&& other) noexcept;
+
+        private:
+            friend class FileWatchService;
+            Subscription(FileWatchService* the_service, std::uint64_t the_id) noexcept;
+
+            FileWatchService* service = nullptr;
+            std::uint64_t     id      = 0;
+        };
+
+        FileWatchService() = default;
+
+        FileWatchService(const FileWatchService&)            = delete;
+        FileWatchService& operator=(const FileWatchService&) = delete;
+        FileWatchService(FileWatchService&&)                 = delete;
+        FileWatchService& operator=(FileWatchService&&)      = delete;
+
+        // Changes to the file get pushed onto queue with the given context, from the watcher thread.
+        // The queue has to outlive the subscription
+        Subscription Subscribe(const std::filesystem::path& file_path, FileChangeQueue& queue, void* context);
+
+        // Only does anything on platforms without threads, where the files are polled from here
+        void Update();
+
+        [[nodiscard]] std::size_t GetWatchedFileCount() const;
+
+    private:
+        void unsubscribe(std::uint64_t id);
+        void notify(const std::filesystem::path& file_path, FileStatus status);
+
+        struct Subscriber
+        {
+            std::uint64_t    Id;
+            FileChangeQueue* Queue;
+            void*            Context;
+        };
+
+        // Subscribe and unsubscribe never call into the watcher while holding this, because the watcher holds its own lock while it notifies us
+        mutable std::mutex                                       mutex;
+        std::map<std::filesystem::path, std::vector<Subscriber>> subscribers;
+        std::map<std::uint64_t, std::filesystem::path>           subscriptionPaths;
+        std::uint64_t                                            nextId = 1;
+        WatchFiles                                               watcher{}; // last, so its thread stops before the maps go away
+    };
+
+    [[nodiscard]] FileWatchService& get_file_watch_service();
+}
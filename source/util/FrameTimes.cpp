@@ -0,0 +1,112 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "FrameTimes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+namespace
+{
+    // nearest rank, so p99 of 1024 frames is an actual frame and not a blend of two
+    double percentile(const std::vector<float>& sorted, double fraction) noexcept
+    {
+        const auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+        return static_cast<double>(sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1]);
+    }
+}
+
+namespace util
+{
+    void FrameTimes::Add(double delta_time_seconds) noexcept
+    {
+        const double frame_milliseconds = delta_time_seconds * 1000.0;
+        milliseconds[next]              = static_cast<float>(frame_milliseconds);
+        next                            = (next + 1) % FramesKept;
+        count                           = std::min(count + 1, FramesKept);
+        if (frame_milliseconds > hitchThresholdMilliseconds)
+        {
+            ++hitches;
+        }
+
+        ++framesThisSecond;
+        secondCounter += delta_time_seconds;
+        if (secondCounter > 1.0)
+        {
+            framesPerSecond = static_cast<int>(framesThisSecond / secondCounter);
+            secondCounter -= 1.0;
+            framesThisSecond = 0;
+        }
+    }
+
+    void FrameTimes::Reset() noexcept
+    {
+        next             = 0;
+        count            = 0;
+        hitches          = 0;
+        secondCounter    = 0;
+        framesThisSecond = 0;
+    }
+
+    void FrameTimes::SetHitchThreshold(double threshold_milliseconds) noexcept
+    {
+        hitchThresholdMilliseconds = std::max(threshold_milliseconds, 0.0);
+    }
+
+    FrameTimeStatistics FrameTimes::GetStatistics() const
+    {
+        FrameTimeStatistics statistics;
+        statistics.Frames                     = count;
+        statistics.Hitches                    = hitches;
+        statistics.HitchThresholdMilliseconds = hitchThresholdMilliseconds;
+        if (count == 0)
+            return statistics;
+
+        std::vector<float> sorted(count);
+        double             total = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            sorted[i] = GetMilliseconds(i);
+            total += static_cast<double>(sorted[i]);
+        }
+        std::sort(sorted.begin(), sorted.end());
+        statistics.AverageMilliseconds = total / static_cast<double>(count);
+        statistics.P50Milliseconds     = percentile(sorted, 0.50);
+        statistics.P95Milliseconds     = percentile(sorted, 0.95);
+        statistics.P99Milliseconds     = percentile(sorted, 0.99);
+        statistics.MaxMilliseconds     = static_cast<double>(sorted.back());
+        return statistics;
+    }
+
+    bool FrameTimes::WriteJson(const std::filesystem::path& file_path) const
+    {
+        std::ofstream ofs(file_path, std::ios::out | std::ios::trunc);
+        if (!ofs)
+            return false;
+
+        const auto statistics = GetStatistics();
+        ofs << std::fixed << std::setprecision(3) << "{\n"
+            << "\"frames\":" << statistics.Frames << ",\n"
+            << "\"average_ms\":" << statistics.AverageMilliseconds << ",\n"
+            << "\"p50_ms\":" << statistics.P50Milliseconds << ",\n"
+            << "\"p95_ms\":" << statistics.P95Milliseconds << ",\n"
+            << "\"p99_ms\":" << statistics.P99Milliseconds << ",\n"
+            << "\"max_ms\":" << statistics.MaxMilliseconds << ",\n"
+            << "\"hitches\":" << statistics.Hitches << ",\n"
+            << "\"hitch_threshold_ms\":" << statistics.HitchThresholdMilliseconds << ",\n"
+            << "\"frame_times_ms\":[";
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            ofs << ((i == 0) ? "" : ",") << GetMilliseconds(i);
+        }
+        ofs << "]\n}\n";
+        return ofs.good();
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace util
+{
+    struct FrameTimeStatistics
+    {
+        std::size_t   Frames                     = 0; // how many of the kept frames went into the numbers below
+        double        AverageMilliseconds        = 0;
+        double        P50Milliseconds            = 0;
+        double        P95Milliseconds            = 0;
+        double        P99Milliseconds            = 0;
+        double        MaxMilliseconds            = 0;
+        std::uint64_t Hitches                    = 0; // frames over the hitch threshold since the last Reset()
+        double        HitchThresholdMilliseconds = 0;
+    };
+
+    // Remembers how long the last FramesKept frames took, so a single slow frame shows up instead of disappearing into an average.
+    // Frames slower than the hitch threshold are counted until Reset(), not only while they are kept.
+    class FrameTimes
+    {
+    public:
+        static constexpr std::size_t FramesKept                        = 1024;
+        static constexpr double      DefaultHitchThresholdMilliseconds = 33.3; // two missed vsyncs at 60 Hz
+
+    public:
+        void Add(double delta_time_seconds) noexcept;
+        void Reset() noexcept;
+
+        void                 SetHitchThreshold(double threshold_milliseconds) noexcept;
+        [[nodiscard]] double GetHitchThreshold() const noexcept
+        {
+            return hitchThresholdMilliseconds;
+        }
+
+        // Frames counted over the last whole second, like the old FPS counter
+        [[nodiscard]] int GetFramesPerSecond() const noexcept
+        {
+            return framesPerSecond;
+        }
+
+        [[nodiscard]] std::size_t GetCount() const noexcept
+        {
+            return count;
+        }
+
+        // Oldest first, index 0 is the oldest kept frame
+        [[nodiscard]] float GetMilliseconds(std::size_t index) const noexcept
+        {
+            return milliseconds[(next + FramesKept - count + index) % FramesKept];
+        }
+
+        // Sorts a copy of the kept frames, so call it when the numbers are needed rather than every frame
+        [[nodiscard]] FrameTimeStatistics GetStatistics() const;
+
+        // The statistics and every kept frame time as JSON, for comparing runs outside of the app
+        [[nodiscard]] bool WriteJson(const std::filesystem::path& file_path) const;
+
+    private:
+        std::array<float, FramesKept> milliseconds{};
+        std::size_t                   next                       = 0;
+        std::size_t                   count                      = 0;
+        std::uint64_t                 hitches                    = 0;
+        double                        hitchThresholdMilliseconds = DefaultHitchThresholdMilliseconds;
+        double                        secondCounter              = 0;
+        int                           framesThisSecond           = 0;
+        int                           framesPerSecond            = 0;
+    };
+}
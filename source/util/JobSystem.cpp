@@ -7,6 +7,7 @@
  */
 
 #include "JobSystem.hpp"
+#include <algorithm>
 #include <iostream>
 
 namespace util
@@ -77,6 +78,54 @@ namespace util
         }
     }
 
+    void JobSystem::DoJobsAndWait(int how_many, ComputeAtIndex compute)
+    {
+        const int        num_threads      = std::min(how_many, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+        std::atomic<int> batch_jobs_left  = num_threads;
+        const int        tasks_per_thread = (num_threads > 0) ? how_many / num_threads : 0;
+        const int        remainder        = (num_threads > 0) ? how_many % num_threads : 0;
+
+        for (int i = 0; i < num_threads; ++i)
+        {
+            const int start_index = i * tasks_per_thread;
+            const int end_index   = start_index + tasks_per_thread - 1 + ((i == num_threads - 1) ? remainder : 0);
+            DoJob(
+                [=, &compute, &batch_jobs_left]
+                {
+                    for (int j = start_index; j <= end_index; ++j)
+                    {
+                        compute(j);
+                    }
+                    batch_jobs_left.fetch_sub(1);
+                });
+        }
+
+        while (batch_jobs_left.load() > 0)
+        {
+            if (!tryRunQueuedJob())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool JobSystem::tryRunQueuedJob()
+    {
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (jobQueue.empty())
+            {
+                return false;
+            }
+            job = std::move(jobQueue.front());
+            jobQueue.pop();
+        }
+        job();
+        jobsLeft.fetch_sub(1);
+        return true;
+    }
+
     void JobSystem::WaitUntilDone()
     {
         while (jobsLeft.load() > 0)
@@ -152,6 +201,11 @@ namespace util
         }
     }
 
+    void JobSystem::DoJobsAndWait(int how_many, JobSystem::ComputeAtIndex compute)
+    {
+        DoJobs(how_many, std::move(compute));
+    }
+
     bool JobSystem::IsDone() const
     {
         return true;
@@ -32,6 +32,8 @@ namespace util
 
         void DoJob(Job job);
         void DoJobs(int how_many, ComputeAtIndex compute);
+        // Like DoJobs but only waits for these jobs, running queued jobs while it waits, so it can be called from inside a job
+        void DoJobsAndWait(int how_many, ComputeAtIndex compute);
         void WaitUntilDone();
         bool IsDone() const;
 
@@ -42,6 +44,7 @@ namespace util
 
     private:
         void WorkerThread();
+        bool tryRunQueuedJob();
 
         std::vector<std::thread> workers;
         std::queue<Job>          jobQueue;
@@ -63,6 +66,7 @@ namespace util
 
         void DoJob(Job job);
         void DoJobs(int how_many, ComputeAtIndex compute);
+        void DoJobsAndWait(int how_many, ComputeAtIndex compute);
         void WaitUntilDone();
         bool IsDone() const;
     };
@@ -0,0 +1,297 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <gsl/gsl>
+#include <iomanip>
+
+namespace
+{
+    std::int64_t steady_nanoseconds() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void write_json_string(std::ostream& output, std::string_view text)
+    {
+        output << '"';
+        for (const char c : text)
+        {
+            switch (c)
+            {
+                case '"': output << "\\\""; break;
+                case '\\': output << "\\\\"; break;
+                case '\n': output << "\\n"; break;
+                default:
+                    if (static_cast<unsigned char>(c) >= 0x20)
+                        output << c;
+                    break;
+            }
+        }
+        output << '"';
+    }
+
+    void sort_events(std::vector<util::ProfileEvent>& events)
+    {
+        std::sort(events.begin(), events.end(),
+                  [](const util::ProfileEvent& a, const util::ProfileEvent& b)
+                  {
+                      if (a.Track != b.Track)
+                          return a.Track < b.Track;
+                      if (a.BeginNanoseconds != b.BeginNanoseconds)
+                          return a.BeginNanoseconds < b.BeginNanoseconds;
+                      return a.Depth < b.Depth;
+                  });
+    }
+
+    // the frames are kept in order, with gaps where recording was turned off
+    template <typename Frames>
+    auto* find_frame(Frames& frames, std::uint64_t number) noexcept
+    {
+        const auto found = std::lower_bound(frames.begin(), frames.end(), number, [](const util::Profiler::Frame& frame, std::uint64_t n) { return frame.Number < n; });
+        return (found != frames.end() && found->Number == number) ? &*found : nullptr;
+    }
+}
+
+namespace util
+{
+    // Single producer, single consumer: the owning thread pushes, EndFrame() pops
+    struct Profiler::ThreadEvents
+    {
+        std::array<ProfileEvent, EventsPerThread> Ring{};
+        std::atomic<std::size_t>                   Written{ 0 };
+        std::atomic<std::size_t>                   Read{ 0 };
+        std::atomic<std::uint64_t>                 Dropped{ 0 };
+        std::uint16_t                              Track = 0;
+        std::uint16_t                              Depth = 0; // only touched by the owning thread
+
+        void Push(const ProfileEvent& event) noexcept
+        {
+            const auto written = Written.load(std::memory_order_relaxed);
+            if (written - Read.load(std::memory_order_acquire) >= Ring.size())
+            {
+                Dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            Ring[written % Ring.size()] = event;
+            Written.store(written + 1, std::memory_order_release);
+        }
+    };
+
+    Profiler::Profiler()
+        : startTime{ steady_nanoseconds() }
+    {
+    }
+
+    void Profiler::SetEnabled(bool enabled) noexcept
+    {
+        isEnabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    std::int64_t Profiler::Now() const noexcept
+    {
+        return steady_nanoseconds() - startTime;
+    }
+
+    void Profiler::NameThisThread(std::string name)
+    {
+        const auto            track = GetThreadEvents().Track;
+        const std::lock_guard lock(tracksMutex);
+        trackNames[track] = std::move(name);
+    }
+
+    std::uint16_t Profiler::AddTrack(std::string name)
+    {
+        const std::lock_guard lock(tracksMutex);
+        trackNames.push_back(std::move(name));
+        return gsl::narrow<std::uint16_t>(trackNames.size() - 1);
+    }
+
+    void Profiler::AddEvents(std::span<const ProfileEvent> events, std::uint64_t frame_number)
+    {
+        const std::lock_guard lock(tracksMutex);
+        for (const auto& event : events)
+        {
+            addedEvents.push_back({ frame_number, event });
+        }
+    }
+
+    Profiler::ThreadEvents& Profiler::GetThreadEvents()
+    {
+        // the registry keeps the ring alive after its thread exits so the last events can still be gathered
+        thread_local const std::shared_ptr<ThreadEvents> this_thread_events = [this]
+        {
+            auto                  events = std::make_shared<ThreadEvents>();
+            const std::lock_guard lock(tracksMutex);
+            events->Track = gsl::narrow<std::uint16_t>(trackNames.size());
+            trackNames.push_back("Thread " + std::to_string(threadEvents.size()));
+            threadEvents.push_back(events);
+            return events;
+        }();
+        return *this_thread_events;
+    }
+
+    void Profiler::EndFrame()
+    {
+        std::vector<AddedEvent> added_events;
+        Frame                   frame;
+        frame.Number           = frameNumber++;
+        frame.BeginNanoseconds = frameBegin;
+        frame.EndNanoseconds   = Now();
+        frameBegin             = frame.EndNanoseconds;
+        {
+            const std::lock_guard lock(tracksMutex);
+            for (const auto& thread_events : threadEvents)
+            {
+                const auto read    = thread_events->Read.load(std::memory_order_relaxed);
+                const auto written = thread_events->Written.load(std::memory_order_acquire);
+                for (auto i = read; i != written; ++i)
+                {
+                    frame.Events.push_back(thread_events->Ring[i % thread_events->Ring.size()]);
+                }
+                thread_events->Read.store(written, std::memory_order_release);
+            }
+            added_events.swap(addedEvents);
+        }
+        if (!IsEnabled())
+            return;
+
+        // events that come in late go back to the frame they happened in, the ones too old to be kept are dropped
+        std::vector<Frame*> late_frames;
+        for (const auto& added : added_events)
+        {
+            if (added.FrameNumber == frame.Number)
+            {
+                frame.Events.push_back(added.Event);
+                continue;
+            }
+            auto* const earlier = find_frame(frames, added.FrameNumber);
+            if (earlier == nullptr)
+                continue;
+            earlier->Events.push_back(added.Event);
+            if (std::find(late_frames.begin(), late_frames.end(), earlier) == late_frames.end())
+                late_frames.push_back(earlier);
+        }
+        for (auto* const late_frame : late_frames)
+        {
+            sort_events(late_frame->Events);
+        }
+
+        sort_events(frame.Events);
+        frames.push_back(std::move(frame));
+        if (frames.size() > FramesKept)
+        {
+            frames.pop_front();
+        }
+    }
+
+    const Profiler::Frame* Profiler::GetLastFrame() const noexcept
+    {
+        return frames.empty() ? nullptr : &frames.back();
+    }
+
+    const Profiler::Frame* Profiler::GetFrame(std::uint64_t number) const noexcept
+    {
+        return find_frame(frames, number);
+    }
+
+    std::string Profiler::GetTrackName(std::uint16_t track) const
+    {
+        const std::lock_guard lock(tracksMutex);
+        return (track < trackNames.size()) ? trackNames[track] : std::string{};
+    }
+
+    std::size_t Profiler::GetTrackCount() const
+    {
+        const std::lock_guard lock(tracksMutex);
+        return trackNames.size();
+    }
+
+    std::uint64_t Profiler::GetDroppedEventCount() const
+    {
+        const std::lock_guard lock(tracksMutex);
+        std::uint64_t         dropped = 0;
+        for (const auto& thread_events : threadEvents)
+        {
+            dropped += thread_events->Dropped.load(std::memory_order_relaxed);
+        }
+        return dropped;
+    }
+
+    // https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU - reference
+    bool Profiler::WriteChromeTrace(const std::filesystem::path& file_path) const
+    {
+        std::ofstream ofs(file_path, std::ios::out | std::ios::trunc);
+        if (!ofs)
+            return false;
+
+        constexpr double NanosecondsPerMicrosecond = 1000.0;
+        const auto       track_count               = GetTrackCount();
+        // an extra track with one event per frame makes the frames easy to find
+        const auto frames_track = track_count;
+        ofs << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+        for (std::size_t track = 0; track <= track_count; ++track)
+        {
+            ofs << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track << ",\"args\":{\"name\":";
+            write_json_string(ofs, (track == frames_track) ? std::string("Frames") : GetTrackName(static_cast<std::uint16_t>(track)));
+            ofs << "}},\n";
+        }
+        const auto write_event = [&](std::string_view name, std::size_t track, std::int64_t begin, std::int64_t end)
+        {
+            ofs << "{\"name\":";
+            write_json_string(ofs, name);
+            ofs << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << track << ",\"ts\":" << static_cast<double>(begin) / NanosecondsPerMicrosecond
+                << ",\"dur\":" << static_cast<double>(end - begin) / NanosecondsPerMicrosecond << "}";
+        };
+        bool is_first = true;
+        for (const auto& frame : frames)
+        {
+            if (!is_first)
+                ofs << ",\n";
+            is_first = false;
+            write_event("Frame", frames_track, frame.BeginNanoseconds, frame.EndNanoseconds);
+            for (const auto& event : frame.Events)
+            {
+                ofs << ",\n";
+                write_event(event.Name, event.Track, event.BeginNanoseconds, event.EndNanoseconds);
+            }
+        }
+        ofs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        return ofs.good();
+    }
+
+    Profiler& get_profiler()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    ProfileScope::ProfileScope(const char* scope_name)
+        : name{ scope_name }
+    {
+        auto& profiler = get_profiler();
+        if (!profiler.IsEnabled())
+            return;
+        events = &profiler.GetThreadEvents();
+        ++events->Depth;
+        begin = profiler.Now();
+    }
+
+    ProfileScope::~ProfileScope()
+    {
+        if (events == nullptr)
+            return;
+        const auto end = get_profiler().Now();
+        --events->Depth;
+        events->Push({ name, begin, end, events->Depth, events->Track });
+    }
+}
@@ -0,0 +1,135 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace util
+{
+    struct ProfileEvent
+    {
+        const char*   Name             = nullptr; // a string literal, it is never copied
+        std::int64_t  BeginNanoseconds = 0;       // since the profiler was created
+        std::int64_t  EndNanoseconds   = 0;
+        std::uint16_t Depth            = 0; // how many scopes it is nested in on its track
+        std::uint16_t Track            = 0; // one track per thread, plus any added with AddTrack()
+    };
+
+    // Collects timed scopes from every thread. Each thread writes finished scopes into its own fixed size ring without locking,
+    // the main thread gathers them once a frame with EndFrame() and keeps the last FramesKept frames around.
+    class Profiler
+    {
+    public:
+        static constexpr std::size_t EventsPerThread = 4096; // per frame, more than that are dropped and counted
+        static constexpr std::size_t FramesKept      = 240;
+
+        struct Frame
+        {
+            std::uint64_t             Number           = 0; // counts every EndFrame(), recorded or not
+            std::int64_t              BeginNanoseconds = 0;
+            std::int64_t              EndNanoseconds   = 0;
+            std::vector<ProfileEvent> Events{}; // sorted by track and then start time
+        };
+
+    public:
+        Profiler();
+
+        void               SetEnabled(bool enabled) noexcept;
+        [[nodiscard]] bool IsEnabled() const noexcept
+        {
+            return isEnabled.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::int64_t Now() const noexcept;
+
+        // Names the track of the calling thread, threads are "Thread N" otherwise
+        void NameThisThread(std::string name);
+        // A track for events that don't come from a thread's scopes, like GPU timings
+        [[nodiscard]] std::uint16_t AddTrack(std::string name);
+        // Finished events from another source, like GPU timings read back a few frames later.
+        // frame_number is GetFrameNumber() from when they happened, they go into that frame if it is still kept.
+        void AddEvents(std::span<const ProfileEvent> events, std::uint64_t frame_number);
+
+        // The number the frame being recorded will get
+        [[nodiscard]] std::uint64_t GetFrameNumber() const noexcept
+        {
+            return frameNumber;
+        }
+
+        // Closes the current frame. Call it once a frame from the main thread.
+        void EndFrame();
+
+        [[nodiscard]] const Frame*             GetLastFrame() const noexcept;
+        [[nodiscard]] const Frame*             GetFrame(std::uint64_t number) const noexcept; // null when it isn't kept
+        [[nodiscard]] std::string              GetTrackName(std::uint16_t track) const;
+        [[nodiscard]] std::size_t              GetTrackCount() const;
+        [[nodiscard]] std::uint64_t            GetDroppedEventCount() const;
+        [[nodiscard]] const std::deque<Frame>& GetFrames() const noexcept
+        {
+            return frames;
+        }
+
+        // Writes the kept frames in the Chrome trace event format, open it with chrome://tracing or https://ui.perfetto.dev
+        [[nodiscard]] bool WriteChromeTrace(const std::filesystem::path& file_path) const;
+
+    public:
+        struct ThreadEvents;
+        // the calling thread's ring, registered the first time the thread records something
+        [[nodiscard]] ThreadEvents& GetThreadEvents();
+
+    private:
+        struct AddedEvent
+        {
+            std::uint64_t FrameNumber = 0;
+            ProfileEvent  Event{};
+        };
+
+#if defined(DEVELOPER_VERSION)
+        std::atomic_bool                           isEnabled{ true };
+#else
+        std::atomic_bool                           isEnabled{ false }; // turned on from the Profiler window
+#endif
+        std::int64_t                               startTime;
+        mutable std::mutex                         tracksMutex;
+        std::vector<std::shared_ptr<ThreadEvents>> threadEvents;
+        std::vector<std::string>                   trackNames;
+        std::vector<AddedEvent>                    addedEvents;
+        std::deque<Frame>                          frames;
+        std::int64_t                               frameBegin  = 0;
+        std::uint64_t                              frameNumber = 0;
+    };
+
+    [[nodiscard]] Profiler& get_profiler();
+
+    // Times everything until the end of the C++ scope it is declared in. The name must outlive the profiler, so use a string literal.
+    class [[nodiscard]] ProfileScope
+    {
+    public:
+        explicit ProfileScope(const char* scope_name);
+        ~ProfileScope();
+
+        ProfileScope(const ProfileScope&)            = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+        ProfileScope(ProfileScope&&)                 = delete;
+        ProfileScope& operator=(ProfileScope&&)      = delete;
+
+    private:
+        const char*             name;
+        std::int64_t            begin  = 0;
+        Profiler::ThreadEvents* events = nullptr; // null when the profiler was disabled
+    };
+}
+
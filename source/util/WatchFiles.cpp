@@ -15,9 +15,23 @@
 #    include <condition_variable>
 #    include <mutex>
 #    include <thread>
+#    if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#        define WATCH_FILES_WITH_INOTIFY
+#        include <cerrno>
+#        include <cstring>
+#        include <map>
+#        include <poll.h>
+#        include <stdexcept>
+#        include <sys/eventfd.h>
+#        include <sys/inotify.h>
+#        include <unistd.h>
+#    endif
 #endif
 
+#include "ContentHash.hpp"
 #include "Timer.hpp"
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <vector>
 
@@ -29,8 +43,22 @@ namespace
         util::WatchFiles::Callback      Notify;
         util::FileStatus                Status;
         std::filesystem::file_time_type LastWriteTime;
+        std::uint64_t                   ContentHash    = 0;
+        bool                            HasContentHash = false; // filled in by HashNewFiles() on the watching thread
     };
 
+    // Touching a file or checking out the same contents only changes its write time, so compare what is in it
+    bool has_new_contents(FileToWatch& info)
+    {
+        std::uint64_t hash = 0;
+        if (!util::hash_file_contents(info.FilePath, hash))
+            return true; // let whoever reads it find out what's wrong
+        const bool is_new   = !info.HasContentHash || hash != info.ContentHash;
+        info.ContentHash    = hash;
+        info.HasContentHash = true;
+        return is_new;
+    }
+
     class FilePathCollection
     {
         std::vector<FileToWatch> the_files;
@@ -50,7 +78,33 @@ namespace
             the_files.push_back(info);
         }
 
+        // Remembers the contents of the files added since the last call, so it only reads them on the watching thread
+        void HashNewFiles()
+        {
+            for (auto& info : the_files)
+            {
+                if (info.HasContentHash || info.Status == util::FileStatus::Erased)
+                    continue;
+                std::error_code error;
+                // if it was written since AddFile() leave it without a hash, so the next check reports it
+                if (std::filesystem::last_write_time(info.FilePath, error) != info.LastWriteTime || error)
+                    continue;
+                info.HasContentHash = util::hash_file_contents(info.FilePath, info.ContentHash);
+            }
+        }
+
+        void RemoveFile(const std::filesystem::path& file_path)
+        {
+            std::erase_if(the_files, [&](const FileToWatch& info) { return info.FilePath == file_path; });
+        }
+
         void CheckForFileChanges()
+        {
+            CheckForFileChanges([](const FileToWatch&) { return true; });
+        }
+
+        template <typename ShouldCheck>
+        void CheckForFileChanges(ShouldCheck&& should_check)
         {
             const auto NotifyFileChange = [](const FileToWatch& info)
             {
@@ -65,6 +119,8 @@ namespace
             };
             for (auto& info : the_files)
             {
+                if (!should_check(info))
+                    continue;
                 switch (info.Status)
                 {
                     case util::FileStatus::Created:
@@ -74,9 +130,12 @@ namespace
                             {
                                 if (const auto current_write_time = std::filesystem::last_write_time(info.FilePath); current_write_time != info.LastWriteTime)
                                 {
-                                    info.Status        = util::FileStatus::Modified;
                                     info.LastWriteTime = current_write_time;
-                                    NotifyFileChange(info);
+                                    if (has_new_contents(info))
+                                    {
+                                        info.Status = util::FileStatus::Modified;
+                                        NotifyFileChange(info);
+                                    }
                                 }
                             }
                             else
@@ -91,7 +150,9 @@ namespace
                         {
                             info.Status        = util::FileStatus::Created;
                             info.LastWriteTime = std::filesystem::last_write_time(info.FilePath);
-                            NotifyFileChange(info);
+                            // put back exactly as it was, like a checkout that deletes and rewrites it
+                            if (has_new_contents(info))
+                                NotifyFileChange(info);
                         }
                         break;
                 }
@@ -109,6 +170,7 @@ namespace util
         Implementation() = default;
 
         virtual void Watch(const std::filesystem::path& file_path, const Callback& notify_changed) = 0;
+        virtual void Unwatch(const std::filesystem::path& file_path)                               = 0;
 
         virtual void Update()
         {
@@ -158,6 +220,7 @@ namespace util
                         {
                             {
                                 std::scoped_lock lock(filesMutex);
+                                files.HashNewFiles();
                                 files.CheckForFileChanges();
                             }
                             {
@@ -169,6 +232,12 @@ namespace util
             }
         }
 
+        void Unwatch(const std::filesystem::path& file_path) override
+        {
+            std::scoped_lock lock(filesMutex);
+            files.RemoveFile(file_path);
+        }
+
 
     public:
         WatchFilesThreaded(const WatchFilesThreaded&)                      = delete;
@@ -185,6 +254,228 @@ namespace util
         }
     };
 
+#endif
+
+#if defined(WATCH_FILES_WITH_INOTIFY)
+
+    // Sleeps in poll() until the kernel says something changed in one of the watched directories, so it costs nothing while idle.
+    // Directories are watched rather than files because editors often save by writing a new file and renaming it over the old one.
+    // Events are collected until there has been a short quiet spell, then only the files they named get looked at.
+    class WatchFiles::WatchFilesInotify : public Implementation
+    {
+        static constexpr auto          QuietTime = std::chrono::milliseconds(100);
+        static constexpr std::uint32_t EventMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ATTRIB;
+
+        std::chrono::milliseconds            delay; // how often to poll files whose directory can't be watched
+        int                                  inotifyFd = -1;
+        int                                  wakeUpFd  = -1;
+        std::atomic_bool                     isWatching;
+        FilePathCollection                   files;
+        std::map<int, std::filesystem::path> watchedDirectories;
+        std::vector<std::filesystem::path>   unwatchedDirectories;
+        std::mutex                           filesMutex;
+        std::thread                          watcherThread;
+
+    public:
+        explicit WatchFilesInotify(std::chrono::milliseconds the_delay)
+            : delay(the_delay), isWatching{ false }
+        {
+            inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            wakeUpFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (inotifyFd < 0 || wakeUpFd < 0)
+            {
+                const std::string reason = std::strerror(errno);
+                close_file_descriptors();
+                throw std::runtime_error{ "Failed to start inotify: " + reason };
+            }
+        }
+
+    public:
+        void Watch(const std::filesystem::path& file_path, const Callback& notify_changed) override
+        {
+            // event names are joined onto the directory path, so keep both spelled the same way
+            const auto normal_path = file_path.lexically_normal();
+            {
+                std::scoped_lock lock(filesMutex);
+                files.AddFile(normal_path, notify_changed);
+                watch_directory(normal_path.parent_path());
+            }
+            // the watching thread hashes the new file
+            wake_up();
+            if (!isWatching)
+            {
+                isWatching    = true;
+                watcherThread = std::thread([this]() { watch_for_events(); });
+            }
+        }
+
+        void Unwatch(const std::filesystem::path& file_path) override
+        {
+            // the directory stays watched, it costs nothing until something in it changes
+            std::scoped_lock lock(filesMutex);
+            files.RemoveFile(file_path.lexically_normal());
+        }
+
+    public:
+        WatchFilesInotify(const WatchFilesInotify&)                      = delete;
+        WatchFilesInotify& operator=(const WatchFilesInotify&)           = delete;
+        WatchFilesInotify(WatchFilesInotify&&) noexcept                  = delete;
+        WatchFilesInotify& operator=(const WatchFilesInotify&&) noexcept = delete;
+
+        ~WatchFilesInotify() override
+        {
+            isWatching = false;
+            wake_up();
+            if (watcherThread.joinable())
+                watcherThread.join();
+            close_file_descriptors();
+        }
+
+    private:
+        void wake_up() const noexcept
+        {
+            constexpr std::uint64_t     one     = 1;
+            [[maybe_unused]] const auto written = write(wakeUpFd, &one, sizeof(one));
+        }
+
+        void close_file_descriptors() noexcept
+        {
+            if (inotifyFd >= 0)
+                close(inotifyFd);
+            if (wakeUpFd >= 0)
+                close(wakeUpFd);
+            inotifyFd = wakeUpFd = -1;
+        }
+
+        // expects filesMutex to be locked
+        void watch_directory(const std::filesystem::path& directory)
+        {
+            for (const auto& [descriptor, watched] : watchedDirectories)
+            {
+                if (watched == directory)
+                    return;
+            }
+            if (const int descriptor = inotify_add_watch(inotifyFd, directory.c_str(), EventMask); descriptor >= 0)
+            {
+                watchedDirectories[descriptor] = directory;
+                std::erase(unwatchedDirectories, directory);
+            }
+            else if (std::find(unwatchedDirectories.begin(), unwatchedDirectories.end(), directory) == unwatchedDirectories.end())
+            {
+                // most likely it doesn't exist yet, keep polling it until it does
+                unwatchedDirectories.push_back(directory);
+            }
+        }
+
+        void watch_for_events()
+        {
+            std::vector<std::filesystem::path> changed_files;
+            bool                               check_everything = false;
+            while (isWatching)
+            {
+                int timeout_ms = -1;
+                if (!changed_files.empty() || check_everything)
+                {
+                    timeout_ms = static_cast<int>(QuietTime.count());
+                }
+                else
+                {
+                    std::scoped_lock lock(filesMutex);
+                    if (!unwatchedDirectories.empty())
+                        timeout_ms = static_cast<int>(delay.count());
+                }
+
+                std::array<pollfd, 2> to_poll{
+                    { { inotifyFd, POLLIN, 0 }, { wakeUpFd, POLLIN, 0 } }
+                };
+                const int ready = poll(to_poll.data(), to_poll.size(), timeout_ms);
+                if (!isWatching)
+                    break;
+                if (ready < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    std::cerr << "File watching stopped, poll failed: " << std::strerror(errno) << '\n';
+                    break;
+                }
+                if (ready > 0)
+                {
+                    if ((to_poll[0].revents & POLLIN) != 0)
+                        read_events(changed_files, check_everything);
+                    if ((to_poll[1].revents & POLLIN) != 0)
+                    {
+                        std::uint64_t               wake_ups = 0;
+                        [[maybe_unused]] const auto got      = read(wakeUpFd, &wake_ups, sizeof(wake_ups));
+                        std::scoped_lock            lock(filesMutex);
+                        files.HashNewFiles();
+                    }
+                    continue;
+                }
+
+                // things have gone quiet
+                std::scoped_lock lock(filesMutex);
+                if (check_everything)
+                {
+                    files.CheckForFileChanges();
+                }
+                else if (!changed_files.empty())
+                {
+                    files.CheckForFileChanges([&](const FileToWatch& info) { return std::find(changed_files.begin(), changed_files.end(), info.FilePath) != changed_files.end(); });
+                }
+                else
+                {
+                    const auto polled_directories = unwatchedDirectories;
+                    for (const auto& directory : polled_directories)
+                    {
+                        watch_directory(directory);
+                    }
+                    files.CheckForFileChanges([&](const FileToWatch& info) { return std::find(polled_directories.begin(), polled_directories.end(), info.FilePath.parent_path()) != polled_directories.end(); });
+                }
+                changed_files.clear();
+                check_everything = false;
+            }
+        }
+
+        void read_events(std::vector<std::filesystem::path>& changed_files, bool& check_everything)
+        {
+            alignas(inotify_event) std::array<char, 4096> buffer;
+            while (true)
+            {
+                const auto length = read(inotifyFd, buffer.data(), buffer.size());
+                if (length <= 0)
+                    return;
+                std::scoped_lock lock(filesMutex);
+                for (std::size_t offset = 0; offset < static_cast<std::size_t>(length);)
+                {
+                    const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+                    offset += sizeof(inotify_event) + event->len;
+                    if ((event->mask & IN_Q_OVERFLOW) != 0)
+                    {
+                        // the kernel dropped events, so we can't know which files changed
+                        check_everything = true;
+                        continue;
+                    }
+                    const auto directory = watchedDirectories.find(event->wd);
+                    if (directory == watchedDirectories.end())
+                        continue;
+                    if ((event->mask & IN_IGNORED) != 0)
+                    {
+                        // the directory itself went away
+                        unwatchedDirectories.push_back(directory->second);
+                        watchedDirectories.erase(directory);
+                        check_everything = true;
+                        continue;
+                    }
+                    if (event->len == 0)
+                        continue;
+                    auto file_path = directory->second / event->name;
+                    if (std::find(changed_files.begin(), changed_files.end(), file_path) == changed_files.end())
+                        changed_files.push_back(std::move(file_path));
+                }
+            }
+        }
+    };
+
 #endif
 
     class WatchFiles::WatchFilesNoThreads : public Implementation
@@ -205,10 +496,16 @@ namespace util
             files.AddFile(file_path, notify_changed);
         }
 
+        void Unwatch(const std::filesystem::path& file_path) override
+        {
+            files.RemoveFile(file_path);
+        }
+
         void Update() override
         {
             if (timer.GetElapsedSeconds() > delay)
             {
+                files.HashNewFiles();
                 files.CheckForFileChanges();
                 timer.ResetTimeStamp();
             }
@@ -222,6 +519,17 @@ namespace util
         switch (should_thread)
         {
             case BackgroundThread:
+#    if defined(WATCH_FILES_WITH_INOTIFY)
+                try
+                {
+                    impl = std::make_shared<WatchFilesInotify>(the_delay);
+                    break;
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << e.what() << ", falling back to polling\n";
+                }
+#    endif
                 impl = std::make_shared<WatchFilesThreaded>(the_delay);
                 break;
             case NoThread:
@@ -239,6 +547,11 @@ namespace util
         impl->Watch(file_path, notify_changed);
     }
 
+    void WatchFiles::Unwatch(const std::filesystem::path& file_path)
+    {
+        impl->Unwatch(file_path);
+    }
+
     void WatchFiles::Update()
     {
         impl->Update();
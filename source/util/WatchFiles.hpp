@@ -29,6 +29,7 @@ namespace util
     private:
         struct Implementation;
         class WatchFilesThreaded;
+        class WatchFilesInotify;
         class WatchFilesNoThreads;
         std::shared_ptr<Implementation> impl;
 
@@ -42,7 +43,11 @@ namespace util
         explicit WatchFiles(UseThreads should_thread = BackgroundThread, std::chrono::milliseconds the_delay = std::chrono::milliseconds(500));
 
     public:
+        // Created and Modified are only reported when the contents differ from the last version seen,
+        // a new write time alone doesn't count. The contents are hashed on the watching thread.
         void Watch(const std::filesystem::path& file_path, const Callback& notify_changed);
+        // Stops calling the callbacks given for this path
+        void Unwatch(const std::filesystem::path& file_path);
         void Update();
 
     public:
@@ -0,0 +1,89 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#include "WorkerThread.hpp"
+
+#include "Profiler.hpp"
+
+namespace util
+{
+#if defined(CAN_USE_THREADS)
+
+    WorkerThread::WorkerThread(std::string thread_name)
+    {
+        thread = std::thread([this, name = std::move(thread_name)]() mutable { run(std::move(name)); });
+    }
+
+    WorkerThread::~WorkerThread()
+    {
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this] { return !isBusy; });
+            shouldFinish = true;
+        }
+        condition.notify_all();
+        thread.join();
+    }
+
+    void WorkerThread::Start(Job job)
+    {
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this] { return !isBusy; });
+            pendingJob = std::move(job);
+            isBusy     = true;
+        }
+        condition.notify_all();
+    }
+
+    void WorkerThread::Wait()
+    {
+        std::unique_lock lock(mutex);
+        condition.wait(lock, [this] { return !isBusy; });
+    }
+
+    void WorkerThread::run(std::string thread_name)
+    {
+        get_profiler().NameThisThread(std::move(thread_name));
+        while (true)
+        {
+            Job job;
+            {
+                std::unique_lock lock(mutex);
+                condition.wait(lock, [this] { return isBusy || shouldFinish; });
+                if (!isBusy)
+                    return;
+                job = std::move(pendingJob);
+            }
+            job();
+            {
+                const std::lock_guard lock(mutex);
+                isBusy = false;
+            }
+            condition.notify_all();
+        }
+    }
+
+#else
+
+    WorkerThread::WorkerThread(std::string)
+    {
+    }
+
+    WorkerThread::~WorkerThread() = default;
+
+    void WorkerThread::Start(Job job)
+    {
+        job();
+    }
+
+    void WorkerThread::Wait()
+    {
+    }
+
+#endif
+}
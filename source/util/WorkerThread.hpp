@@ -0,0 +1,52 @@
+/**
+ * \file
+ * \author Rudy Castan
+ * \date 2024 Spring
+ * \par CS250 Computer Graphics II
+ * \copyright DigiPen Institute of Technology
+ */
+#pragma once
+
+#include "environment/Environment.hpp"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace util
+{
+    // One thread that runs one job at a time, for work that has to overlap a specific part of the frame
+    // and can't wait behind whatever else is queued on a JobSystem.
+    // Without threads Start() just runs the job.
+    class WorkerThread
+    {
+    public:
+        using Job = std::function<void(void)>;
+
+        // The name shows up as the thread's track in the profiler
+        explicit WorkerThread(std::string thread_name);
+        ~WorkerThread();
+
+        WorkerThread(const WorkerThread&)            = delete;
+        WorkerThread(WorkerThread&&)                 = delete;
+        WorkerThread& operator=(const WorkerThread&) = delete;
+        WorkerThread& operator=(WorkerThread&&)      = delete;
+
+        // Waits for the previous job first, so there is never more than one in flight
+        void Start(Job job);
+        void Wait();
+
+    private:
+#if defined(CAN_USE_THREADS)
+        void run(std::string thread_name);
+
+        std::mutex              mutex;
+        std::condition_variable condition;
+        Job                     pendingJob;
+        bool                    isBusy       = false;
+        bool                    shouldFinish = false;
+        std::thread             thread;
+#endif
+    };
+}
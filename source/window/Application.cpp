@@ -11,16 +11,21 @@
 #include "ImGuiHelper.hpp"
 #include "Logo.hpp"
 #include "assets/Path.hpp"
+#include "assets/TextureCache.hpp"
 #include "environment/Environment.hpp"
 #include "environment/Input.hpp"
 #include "environment/OpenGL.hpp"
 #include "opengl/GL.hpp"
+#include "opengl/GLGpuProfiler.hpp"
+#include "util/Profiler.hpp"
 #include <GL/glew.h>
 #include <SDL.h>
+#include <algorithm>
 #include <fstream>
 #include <imgui.h>
 #include <iostream>
 #include <sstream>
+#include <string_view>
 
 namespace
 {
@@ -44,6 +49,8 @@ namespace
 
     std::string format_folder_name(const std::string& input);
 
+    ImU32 scope_color(std::string_view scope_name) noexcept;
+
     environment::input::KeyboardButtons sdl_scancode_to_button(SDL_Scancode scancode) noexcept;
 }
 
@@ -55,6 +62,8 @@ namespace window
         if (title == nullptr || title[0] == '\0')
             throw_error_message("App title shouldn't be empty");
         getAndSetWritableDirectory(title);
+        assets::set_texture_cache_directory(writableDirectory / "texture_cache");
+        util::get_profiler().NameThisThread("Main");
         setupSDLWindow(title);
         setupOpenGL();
         setupWindowSizeAndDPI();
@@ -70,7 +79,9 @@ namespace window
 
     Application::~Application()
     {
+        simulationThread.Wait();
         delete ptr_program;
+        GLProfilerShutdown();
         ImGuiHelper::Shutdown();
         SDL_GL_DeleteContext(gl_context);
         SDL_DestroyWindow(ptr_window);
@@ -79,15 +90,36 @@ namespace window
 
     void Application::Update()
     {
-        updateEnvironment();
-        updateWindowEvents();
-        updateDisplayViewport();
-        ptr_program->Update();
-        ptr_program->Draw();
-        currentViewport = ImGuiHelper::Begin();
-        imguiDraw();
-        ImGuiHelper::End(ptr_window, gl_context);
-        SDL_GL_SwapWindow(ptr_window);
+        {
+            const util::ProfileScope profile_scope("Update");
+            updateEnvironment();
+            updateWindowEvents();
+            updateDisplayViewport();
+            updateSimulation();
+            ptr_program->Update();
+        }
+        {
+            const GLProfileScope profile_scope("Draw");
+            ptr_program->Draw();
+        }
+        lastFrameGLStateCounts = GL::GetStateCacheCounts();
+        GL::ResetStateCacheCounts();
+        {
+            const GLProfileScope profile_scope("ImGui");
+            currentViewport = ImGuiHelper::Begin();
+            imguiDraw();
+            ImGuiHelper::End(ptr_window, gl_context);
+        }
+        // ImGui renders with its own gl calls and may switch contexts for its viewports
+        GL::InvalidateStateCache();
+        {
+            const util::ProfileScope profile_scope("Swap");
+            SDL_GL_SwapWindow(ptr_window);
+        }
+        GLProfilerEndFrame();
+        util::get_profiler().EndFrame();
+        if (timeToFirstFrame == 0)
+            timeToFirstFrame = firstFrameTimer.GetElapsedSeconds();
     }
 
     bool Application::IsDone() const noexcept
@@ -113,6 +145,7 @@ namespace window
                 ImGui::MenuItem("Mouse Information", "", &settings.ShowMouseInformation);
                 ImGui::MenuItem("Keyboard Information", "", &settings.ShowKeyboardInformation);
                 ImGui::MenuItem("OpenGL Information", "", &settings.ShowOpenGLInformation);
+                ImGui::MenuItem("Profiler", "", &settings.ShowProfiler);
                 ImGui::EndMenu();
             }
             ImGui::EndMainMenuBar();
@@ -120,9 +153,7 @@ namespace window
 
         if (settings.ShowFPS)
         {
-            ImGui::Begin("FPS", &settings.ShowFPS);
-            ImGui::Text("%d", environment::FPS);
-            ImGui::End();
+            imguiDrawFrameTimes();
         }
 
         if (settings.ShowWindowInformation)
@@ -194,9 +225,27 @@ namespace window
             ImGui::Text("MaxElementIndices %d", environment::opengl::MaxElementIndices);
             ImGui::Text("MaxTextureImageUnits %d", environment::opengl::MaxTextureImageUnits);
             ImGui::Text("MaxTextureSize %d", environment::opengl::MaxTextureSize);
+            ImGui::Text("Parallel Shader Compile %s", environment::opengl::HasParallelShaderCompile ? "true" : "false");
+            ImGui::Text("S3TC Compression %s", environment::opengl::HasS3TCCompression ? "true" : "false");
+            ImGui::Text("Error Checks %s", GL::ErrorCheckMode);
+            if (ImGui::Button("Benchmark Draw Calls"))
+            {
+                constexpr int DRAW_CALLS = 100'000;
+                lastDrawCallBenchmark    = GLBenchmarkDrawCalls(DRAW_CALLS);
+            }
+            if (lastDrawCallBenchmark.DrawCalls > 0)
+            {
+                ImGui::Text("%d draws submitted in %.2f ms, %.0f draws/s", lastDrawCallBenchmark.DrawCalls, lastDrawCallBenchmark.SubmitSeconds * 1000.0, lastDrawCallBenchmark.DrawCallsPerSecond());
+                ImGui::Text("GPU done after %.2f ms", lastDrawCallBenchmark.TotalSeconds * 1000.0);
+            }
             ImGui::End();
         }
 
+        if (settings.ShowProfiler)
+        {
+            imguiDrawProfiler();
+        }
+
         if (settings.ShowDemoSettings)
         {
             ImGui::Begin("Demo Settings", &settings.ShowDemoSettings);
@@ -205,6 +254,141 @@ namespace window
         }
     }
 
+    void Application::imguiDrawFrameTimes()
+    {
+        ImGui::Begin("FPS", &settings.ShowFPS);
+        ImGui::Text("%d", environment::FPS);
+        ImGui::Text("Time to first frame %.1f ms", timeToFirstFrame * 1000.0);
+        ImGui::Text("GL state changes issued %u", lastFrameGLStateCounts.Issued);
+        ImGui::Text("GL state changes skipped %u", lastFrameGLStateCounts.Redundant);
+        ImGui::Text("GL draw calls %u", lastFrameGLStateCounts.DrawCalls);
+        ImGui::Checkbox("Pipelined update", &settings.PipelinedUpdate);
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Simulate the next frame on a worker thread while this one is drawn");
+        }
+        ImGui::SameLine();
+        ImGui::Text("%d simulation steps", lastSimulationSteps);
+
+        constexpr double StatisticsRefreshSeconds = 0.5;
+        if (frameTimeStatisticsAge < 0 || frameTimeStatisticsAge >= StatisticsRefreshSeconds)
+        {
+            frameTimeStatistics    = frameTimes.GetStatistics();
+            frameTimeStatisticsAge = 0;
+        }
+        const auto& statistics = frameTimeStatistics;
+        ImGui::Text("p50 %.2f ms  p95 %.2f ms  p99 %.2f ms  max %.2f ms", statistics.P50Milliseconds, statistics.P95Milliseconds, statistics.P99Milliseconds, statistics.MaxMilliseconds);
+        ImGui::Text("%llu hitches over %.1f ms", static_cast<unsigned long long>(statistics.Hitches), statistics.HitchThresholdMilliseconds);
+
+        const auto get_milliseconds = [](void* data, int index)
+        { return static_cast<const util::FrameTimes*>(data)->GetMilliseconds(static_cast<std::size_t>(index)); };
+        // scaled to the slowest kept frame, the threshold sets the floor so a smooth run doesn't look noisy
+        const float graph_max = static_cast<float>(std::max(statistics.MaxMilliseconds, statistics.HitchThresholdMilliseconds));
+        ImGui::PlotLines("##FrameTimes", get_milliseconds, &frameTimes, static_cast<int>(frameTimes.GetCount()), 0, nullptr, 0.0f, graph_max, ImVec2(0, 80.0f));
+
+        float hitch_threshold = static_cast<float>(frameTimes.GetHitchThreshold());
+        if (ImGui::SliderFloat("Hitch ms", &hitch_threshold, 1.0f, 100.0f, "%.1f"))
+        {
+            frameTimes.SetHitchThreshold(hitch_threshold);
+            frameTimeStatisticsAge = -1;
+        }
+        if (ImGui::Button("Reset"))
+        {
+            frameTimes.Reset();
+            frameTimeStatisticsAge = -1;
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save Frame Times"))
+        {
+            lastFrameTimesPath = writableDirectory / "frame_times.json";
+            if (!frameTimes.WriteJson(lastFrameTimesPath))
+            {
+                std::cerr << "Failed to write " << lastFrameTimesPath << '\n';
+                lastFrameTimesPath.clear();
+            }
+        }
+        if (!lastFrameTimesPath.empty())
+        {
+            ImGui::Text("Saved %s", lastFrameTimesPath.string().c_str());
+        }
+        ImGui::End();
+    }
+
+    void Application::imguiDrawProfiler()
+    {
+        auto& profiler = util::get_profiler();
+        ImGui::Begin("Profiler", &settings.ShowProfiler);
+        bool is_recording = profiler.IsEnabled();
+        if (ImGui::Checkbox("Record", &is_recording))
+        {
+            profiler.SetEnabled(is_recording);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save Chrome Trace"))
+        {
+            lastTracePath = writableDirectory / "profile_trace.json";
+            if (!profiler.WriteChromeTrace(lastTracePath))
+            {
+                std::cerr << "Failed to write " << lastTracePath << '\n';
+                lastTracePath.clear();
+            }
+        }
+        if (!lastTracePath.empty())
+        {
+            ImGui::Text("Saved %s", lastTracePath.string().c_str());
+        }
+
+        // the newest frame whose GPU times have been read back
+        const auto frames_behind = static_cast<std::uint64_t>(GLProfilerFramesBehind()) + 1;
+        const auto* frame        = (profiler.GetFrameNumber() > frames_behind) ? profiler.GetFrame(profiler.GetFrameNumber() - frames_behind) : nullptr;
+        if (frame == nullptr || frame->EndNanoseconds <= frame->BeginNanoseconds)
+        {
+            ImGui::End();
+            return;
+        }
+        constexpr double NanosecondsPerMillisecond = 1'000'000.0;
+        const auto       frame_length              = static_cast<double>(frame->EndNanoseconds - frame->BeginNanoseconds);
+        ImGui::Text("Frame %.2f ms, %llu scopes dropped", frame_length / NanosecondsPerMillisecond, static_cast<unsigned long long>(profiler.GetDroppedEventCount()));
+
+        // one band per track and one row per nesting depth, hover a box to see how long it took
+        ImDrawList* draw_list  = ImGui::GetWindowDrawList();
+        const float row_height = ImGui::GetTextLineHeightWithSpacing();
+        const float width      = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+        const auto& events     = frame->Events;
+        for (std::size_t first = 0; first < events.size();)
+        {
+            const auto    track     = events[first].Track;
+            std::size_t   last      = first;
+            std::uint16_t max_depth = 0;
+            for (; last < events.size() && events[last].Track == track; ++last)
+            {
+                max_depth = std::max(max_depth, events[last].Depth);
+            }
+            const auto to_x = [&, origin_x = ImGui::GetCursorScreenPos().x](std::int64_t time)
+            { return origin_x + width * static_cast<float>(std::clamp(static_cast<double>(time - frame->BeginNanoseconds) / frame_length, 0.0, 1.0)); };
+
+            ImGui::TextUnformatted(profiler.GetTrackName(track).c_str());
+            const float origin_y = ImGui::GetCursorScreenPos().y;
+            ImGui::Dummy(ImVec2(width, row_height * static_cast<float>(max_depth + 1)));
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const auto&  event = events[i];
+                const ImVec2 top_left{ to_x(event.BeginNanoseconds), origin_y + row_height * static_cast<float>(event.Depth) };
+                const ImVec2 bottom_right{ std::max(to_x(event.EndNanoseconds), top_left.x + 1.0f), top_left.y + row_height - 1.0f };
+                draw_list->AddRectFilled(top_left, bottom_right, scope_color(event.Name));
+                draw_list->PushClipRect(top_left, bottom_right, true);
+                draw_list->AddText(ImVec2(top_left.x + 2.0f, top_left.y), IM_COL32(0, 0, 0, 255), event.Name);
+                draw_list->PopClipRect();
+                if (ImGui::IsMouseHoveringRect(top_left, bottom_right))
+                {
+                    ImGui::SetTooltip("%s %.3f ms", event.Name, static_cast<double>(event.EndNanoseconds - event.BeginNanoseconds) / NanosecondsPerMillisecond);
+                }
+            }
+            first = last;
+        }
+        ImGui::End();
+    }
+
     void Application::getAndSetWritableDirectory(gsl::czstring title)
     {
         const auto sdl_path = SDL_GetPrefPath("digipen.student.edu", format_folder_name(title).c_str());
@@ -239,6 +423,9 @@ namespace window
 #else
         hint_gl(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
         environment::opengl::IsOpenGL_ES = false;
+#    if defined(CS250_GL_CHECKS_CALLBACK)
+        hint_gl(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+#    endif
 #endif
         hint_gl(SDL_GL_DOUBLEBUFFER, true);
         hint_gl(SDL_GL_STENCIL_SIZE, 8);
@@ -324,12 +511,13 @@ namespace window
         openglStrings.Renderer    = reinterpret_cast<const char*>(GL::GetString(GL_RENDERER));
         openglStrings.Version     = reinterpret_cast<const char*>(GL::GetString(GL_VERSION));
         openglStrings.GLSLVersion = reinterpret_cast<const char*>(GL::GetString(GL_SHADING_LANGUAGE_VERSION));
-        GL::GetIntegerv(GL_MAJOR_VERSION, &environment::opengl::MajorVersion);
-        GL::GetIntegerv(GL_MINOR_VERSION, &environment::opengl::MinorVersion);
-        GL::GetIntegerv(GL_MAX_ELEMENTS_VERTICES, &environment::opengl::MaxElementVertices);
-        GL::GetIntegerv(GL_MAX_ELEMENTS_INDICES, &environment::opengl::MaxElementIndices);
-        GL::GetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &environment::opengl::MaxTextureImageUnits);
-        GL::GetIntegerv(GL_MAX_TEXTURE_SIZE, &environment::opengl::MaxTextureSize);
+        environment::opengl::query_current_context();
+#if defined(CS250_GL_CHECKS_CALLBACK)
+        if (!GL::InstallDebugMessageCallback())
+        {
+            std::cerr << "KHR_debug isn't supported, OpenGL errors won't be reported\n";
+        }
+#endif
     }
 
     void Application::setupWindowSizeAndDPI() const
@@ -366,8 +554,43 @@ namespace window
         timer.ResetTimeStamp();
         environment::ElapsedTime += environment::DeltaTime;
         ++environment::FrameCount;
-        fps.Update(environment::DeltaTime);
-        environment::FPS = fps;
+        frameTimes.Add(environment::DeltaTime);
+        if (frameTimeStatisticsAge >= 0)
+            frameTimeStatisticsAge += environment::DeltaTime;
+        environment::FPS = frameTimes.GetFramesPerSecond();
+    }
+
+    void Application::updateSimulation()
+    {
+        // the steps started last frame, if any, are the ones this frame draws
+        simulationThread.Wait();
+        ptr_program->PublishSimulation();
+
+        simulationAccumulator += environment::DeltaTime;
+        lastSimulationSteps = std::min(static_cast<int>(simulationAccumulator / SimulationStepSeconds), MaxSimulationSteps);
+        simulationAccumulator -= lastSimulationSteps * SimulationStepSeconds;
+        simulationAccumulator = std::min(simulationAccumulator, SimulationStepSeconds);
+        if (lastSimulationSteps == 0)
+            return;
+
+        const auto simulate = [program = ptr_program, steps = lastSimulationSteps, first_step = simulationStepCount]()
+        {
+            const util::ProfileScope profile_scope("Simulate");
+            for (int i = 0; i < steps; ++i)
+            {
+                program->Simulate(demos::SimulationStep{ SimulationStepSeconds, first_step + static_cast<unsigned long long>(i) });
+            }
+        };
+        simulationStepCount += static_cast<unsigned long long>(lastSimulationSteps);
+        if (settings.PipelinedUpdate && environment::CanUseThreads)
+        {
+            simulationThread.Start(simulate);
+        }
+        else
+        {
+            simulate();
+            ptr_program->PublishSimulation();
+        }
     }
 
     void Application::updateWindowEvents()
@@ -561,8 +784,12 @@ namespace window
         if (selected_demo != settings.CurrentDemo)
         {
             settings.CurrentDemo = selected_demo;
+            firstFrameTimer.ResetTimeStamp();
+            timeToFirstFrame = 0;
+            simulationThread.Wait();
             delete ptr_program;
-            ptr_program = create_demo(selected_demo);
+            ptr_program           = create_demo(selected_demo);
+            simulationAccumulator = 0;
         }
     }
 }
@@ -594,6 +821,19 @@ namespace
         return formatted;
     }
 
+    ImU32 scope_color(std::string_view scope_name) noexcept
+    {
+        // FNV-1a, so a scope keeps its color from frame to frame
+        std::uint32_t hash = 2166136261u;
+        for (const char c : scope_name)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        // light colors so the black names stay readable
+        return IM_COL32(128 + (hash & 0x7F), 128 + ((hash >> 8) & 0x7F), 128 + ((hash >> 16) & 0x7F), 255);
+    }
+
     environment::input::KeyboardButtons sdl_scancode_to_button(SDL_Scancode scancode) noexcept
     {
         switch (scancode)
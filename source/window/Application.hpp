@@ -11,8 +11,11 @@
 #include "ImGuiHelper.hpp"
 #include "Settings.hpp"
 #include "demos/DemosFactory.hpp"
-#include "util/FPS.hpp"
+#include "opengl/GL.hpp"
+#include "opengl/GLDrawCallBenchmark.hpp"
+#include "util/FrameTimes.hpp"
 #include "util/Timer.hpp"
+#include "util/WorkerThread.hpp"
 #include <filesystem>
 #include <gsl/gsl>
 #include <vector>
@@ -31,6 +34,9 @@ namespace window
     class [[nodiscard]] Application
     {
     public:
+        static constexpr double SimulationStepSeconds = 1.0 / 60.0;
+        static constexpr int    MaxSimulationSteps    = 5; // per frame, after a long stall the simulation slows down rather than trying to catch up
+
         Application(gsl::czstring title = "OpenGL App", demos::Demos starting_demo = demos::Demos::HelloQuad);
         ~Application();
 
@@ -46,6 +52,8 @@ namespace window
 
     private:
         void imguiDraw();
+        void imguiDrawFrameTimes();
+        void imguiDrawProfiler();
         void getAndSetWritableDirectory(gsl::czstring title);
         void setupSDLWindow(gsl::czstring title);
         void setStartingWindowPlacement();
@@ -56,17 +64,22 @@ namespace window
         void updateEnvironment();
         void updateWindowEvents();
         void updateDisplayViewport();
+        void updateSimulation();
         void imguiSelectDemo();
 
     private:
         using MouseButton    = environment::input::MouseButtons;
         using KeyboardButton = environment::input::KeyboardButtons;
-        util::FPS                   fps{};
+        util::FrameTimes            frameTimes{};
+        util::FrameTimeStatistics   frameTimeStatistics{}; // sorting the kept frames is redone a few times a second, not every frame
+        double                      frameTimeStatisticsAge = -1; // seconds, negative when they have to be computed again
         util::Timer                 timer{};
-        gsl::owner<demos::IDemo*>   ptr_program = nullptr;
-        gsl::owner<SDL_Window*>     ptr_window  = nullptr;
-        gsl::owner<SDL_GLContext>   gl_context  = nullptr;
-        bool                        is_done     = false;
+        util::Timer                 firstFrameTimer{}; // since startup or since the demo was switched
+        double                      timeToFirstFrame = 0;
+        gsl::owner<demos::IDemo*>   ptr_program      = nullptr;
+        gsl::owner<SDL_Window*>     ptr_window       = nullptr;
+        gsl::owner<SDL_GLContext>   gl_context       = nullptr;
+        bool                        is_done          = false;
         std::filesystem::path       writableDirectory;
         ImGuiHelper::Viewport       lastViewport{ 0, 0, 0, 0 };
         ImGuiHelper::Viewport       currentViewport;
@@ -80,6 +93,14 @@ namespace window
         double                      lastMouseVelocityY = 0;
         double                      lastMouseWheel     = 0;
         window::Settings            settings;
+        GL::StateCacheCounts        lastFrameGLStateCounts;
+        GLDrawCallBenchmarkResult   lastDrawCallBenchmark;
+        std::filesystem::path       lastTracePath;
+        std::filesystem::path       lastFrameTimesPath;
+        util::WorkerThread          simulationThread{ "Simulation" };
+        double                      simulationAccumulator = 0; // seconds that haven't been simulated yet
+        unsigned long long          simulationStepCount   = 0;
+        int                         lastSimulationSteps   = 0;
 
         struct
         {
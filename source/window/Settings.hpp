@@ -19,7 +19,7 @@ namespace window
 {
     struct alignas(8) Settings
     {
-        static constexpr int64_t LAYOUT_VERSION = 4;
+        static constexpr int64_t LAYOUT_VERSION = 6;
         static constexpr auto    FileName       = "window_settings.dat";
         static constexpr int32_t DEFAULT_WIDTH  = 800;
         static constexpr int32_t DEFAULT_HEIGHT = 600;
@@ -32,6 +32,8 @@ namespace window
         bool         ShowMouseInformation    = false;
         bool         ShowKeyboardInformation = false;
         bool         ShowOpenGLInformation   = false;
+        bool         ShowProfiler            = false;
+        bool         PipelinedUpdate         = false; // demo simulation on a worker, one frame ahead of drawing
 
         struct
         {